@@ -73,13 +73,11 @@ void replacedocument(const DocumentClient &client, const string_t dbresourceid,
 }
 
 
-void deletedocument(const DocumentClient &client, const string_t dbresourceid,
-	const string_t collresourceid, const string_t docresourceid) {
+void deletedocument(const DocumentClient &client, const string_t dbid,
+	const string_t collid, const string_t docid) {
 	try {
-		client.GetDatabase(dbresourceid).get();
-		shared_ptr<Database> db = client.GetDatabase(dbresourceid);
-		shared_ptr<Collection> coll = db->GetCollection(collresourceid);
-		coll->DeleteDocumentAsync(docresourceid).get();
+		// Addressed by ids, in a single request
+		client.CollectionByName(dbid, collid).DeleteDocumentAsync(docid).get();
 	}
 	catch (DocumentDBRuntimeException ex) {
 		ucout << ex.message();
@@ -126,8 +124,7 @@ int main() {
 				doc->resource_id());
 			ucout << "\n\nReplaced document:\n" << doc->id();
 			executesimplequery(client, db->resource_id(), coll->resource_id());
-			deletedocument(client, db->resource_id(), coll->resource_id(),
-				doc->resource_id());
+			deletedocument(client, db->id(), coll->id(), doc->id());
 			ucout << "\n\nDeleted document:\n" << doc->id();
 			deletedb(client, db->resource_id());
 			ucout << "\n\nDeleted db:\n" << db->id();
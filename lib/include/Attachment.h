@@ -50,12 +50,12 @@ namespace documentdb {
 
 		virtual ~Attachment();
 
-		utility::string_t contentType()
+		const utility::string_t& contentType() const
 		{
 			return contentType_;
 		}
 
-		utility::string_t media()
+		const utility::string_t& media() const
 		{
 			return media_;
 		}
@@ -0,0 +1,68 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#ifndef _DOCUMENTDB_BULK_IMPORT_OPTIONS_H_
+#define _DOCUMENTDB_BULK_IMPORT_OPTIONS_H_
+
+#include <cstddef>
+
+namespace documentdb
+{
+	// Settings of Collection::ImportDocumentsAsync.
+	class BulkImportOptions
+	{
+	public:
+		BulkImportOptions();
+
+		virtual ~BulkImportOptions();
+
+		// Upper bound of the serialized documents sent in one stored procedure call.
+		// A document larger than this is sent on its own.
+		size_t max_batch_size_bytes() const
+		{
+			return max_batch_size_bytes_;
+		}
+
+		void set_max_batch_size_bytes(size_t max_batch_size_bytes)
+		{
+			max_batch_size_bytes_ = max_batch_size_bytes;
+		}
+
+		size_t max_concurrent_batches() const
+		{
+			return max_concurrent_batches_;
+		}
+
+		void set_max_concurrent_batches(size_t max_concurrent_batches)
+		{
+			max_concurrent_batches_ = max_concurrent_batches;
+		}
+
+	private:
+		size_t max_batch_size_bytes_;
+		size_t max_concurrent_batches_;
+	};
+}
+
+#endif // !_DOCUMENTDB_BULK_IMPORT_OPTIONS_H_
@@ -0,0 +1,93 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#ifndef _DOCUMENTDB_BULK_ITEM_RESULT_H_
+#define _DOCUMENTDB_BULK_ITEM_RESULT_H_
+
+#include <cstddef>
+#include <exception>
+#include <memory>
+
+#include "Document.h"
+#include "ResponseDiagnostics.h"
+
+namespace documentdb
+{
+	// Outcome of one item of a bulk operation, either the resulting document or
+	// the exception the single item operation would have thrown.
+	class BulkItemResult
+	{
+	public:
+		BulkItemResult();
+
+		BulkItemResult(
+			size_t index,
+			const std::shared_ptr<Document>& document,
+			const ResponseDiagnostics& diagnostics);
+
+		BulkItemResult(
+			size_t index,
+			const std::exception_ptr& error);
+
+		virtual ~BulkItemResult();
+
+		// Position of the item in the input.
+		size_t index() const
+		{
+			return index_;
+		}
+
+		bool succeeded() const
+		{
+			return !error_;
+		}
+
+		// Null if the item failed.
+		std::shared_ptr<Document> document() const
+		{
+			return document_;
+		}
+
+		std::exception_ptr error() const
+		{
+			return error_;
+		}
+
+		// Rethrows the error of a failed item.
+		void ThrowIfFailed() const;
+
+		const ResponseDiagnostics& diagnostics() const
+		{
+			return diagnostics_;
+		}
+
+	private:
+		size_t index_;
+		std::shared_ptr<Document> document_;
+		std::exception_ptr error_;
+		ResponseDiagnostics diagnostics_;
+	};
+}
+
+#endif // !_DOCUMENTDB_BULK_ITEM_RESULT_H_
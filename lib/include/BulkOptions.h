@@ -0,0 +1,95 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#ifndef _DOCUMENTDB_BULK_OPTIONS_H_
+#define _DOCUMENTDB_BULK_OPTIONS_H_
+
+#include <cstddef>
+
+namespace documentdb
+{
+	// Settings of bulk operations such as Collection::CreateDocumentsAsync.
+	//
+	// Concurrency adapts to the throughput available: it grows by one request per
+	// round trip's worth of successes and halves whenever the service throttles,
+	// staying within [min_concurrency, max_concurrency].
+	class BulkOptions
+	{
+	public:
+		BulkOptions();
+
+		virtual ~BulkOptions();
+
+		size_t max_concurrency() const
+		{
+			return max_concurrency_;
+		}
+
+		void set_max_concurrency(size_t max_concurrency)
+		{
+			max_concurrency_ = max_concurrency;
+		}
+
+		size_t min_concurrency() const
+		{
+			return min_concurrency_;
+		}
+
+		void set_min_concurrency(size_t min_concurrency)
+		{
+			min_concurrency_ = min_concurrency;
+		}
+
+		// Concurrency to start with, clamped to [min_concurrency, max_concurrency].
+		size_t initial_concurrency() const
+		{
+			return initial_concurrency_;
+		}
+
+		void set_initial_concurrency(size_t initial_concurrency)
+		{
+			initial_concurrency_ = initial_concurrency;
+		}
+
+		// When set, results are reported in input order. Results completing ahead
+		// of an earlier item are held back, at most max_concurrency of them.
+		bool ordered() const
+		{
+			return ordered_;
+		}
+
+		void set_ordered(bool ordered)
+		{
+			ordered_ = ordered;
+		}
+
+	private:
+		size_t max_concurrency_;
+		size_t min_concurrency_;
+		size_t initial_concurrency_;
+		bool ordered_;
+	};
+}
+
+#endif // !_DOCUMENTDB_BULK_OPTIONS_H_
@@ -0,0 +1,144 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#ifndef _DOCUMENTDB_BULK_PIPELINE_H_
+#define _DOCUMENTDB_BULK_PIPELINE_H_
+
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <cpprest/json.h>
+#include <pplx/pplxtasks.h>
+
+#include "BulkItemResult.h"
+#include "BulkOptions.h"
+#include "Document.h"
+#include "DocumentDBResponse.h"
+
+namespace documentdb
+{
+	// Runs one request per item pulled from a producer with bounded, adaptive
+	// concurrency, see BulkOptions. The producer is only asked for the next item
+	// when there is room for it, so a slow collection slows the producer down
+	// instead of items piling up in memory.
+	//
+	// The producer and the result handler are never called concurrently with
+	// each other or themselves, nor with the pipeline locked, so they may be
+	// slow or call back into the collection.
+	class BulkPipeline : public std::enable_shared_from_this<BulkPipeline>
+	{
+	public:
+		// Stores the next item in its argument, false once there are no more.
+		typedef std::function<bool(web::json::value&)> Producer;
+
+		typedef std::function<pplx::task<DocumentDBResponse>(const web::json::value&)> Operation;
+
+		// Turns the response into the resulting document, throws for failures.
+		typedef std::function<std::shared_ptr<Document>(const DocumentDBResponse&)> Completion;
+
+		typedef std::function<void(const BulkItemResult&)> ResultHandler;
+
+		BulkPipeline(
+			const BulkOptions& options,
+			const Producer& producer,
+			const Operation& operation,
+			const Completion& completion,
+			const ResultHandler& result_handler);
+
+		virtual ~BulkPipeline();
+
+		// Completes once every item has been reported. Fails with the exception of
+		// the producer or the result handler if either threw, after the items
+		// already in flight completed.
+		pplx::task<void> RunAsync();
+
+	private:
+		BulkPipeline(const BulkPipeline&);
+		BulkPipeline& operator=(const BulkPipeline&);
+
+		struct Item
+		{
+			size_t index;
+			web::json::value value;
+		};
+
+		// Delivers the results ready and pulls as many items as there is room
+		// for, until neither is left. One thread drains at a time and calls the
+		// producer and the result handler without the lock; others only queue.
+		void Drain();
+
+		// Pulls up to count items from the producer, without the lock.
+		std::vector<Item> Pull(
+			size_t count);
+
+		void Start(
+			std::vector<Item>& items);
+
+		void OnCompleted(
+			size_t index,
+			const pplx::task<DocumentDBResponse>& response_task);
+
+		// Queues a result for delivery, or holds it back in ordered mode. Called
+		// with the lock held.
+		void Report(
+			const BulkItemResult& result);
+
+		// Number of items there is room to pull. Called with the lock held.
+		size_t Room() const;
+
+		void Adapt(
+			size_t index,
+			const BulkItemResult& result);
+
+		// Signals done once nothing is left to pull or wait for. Called with the lock held.
+		void CompleteIfDrained();
+
+		BulkOptions options_;
+		Producer producer_;
+		Operation operation_;
+		Completion completion_;
+		ResultHandler result_handler_;
+
+		std::mutex mutex_;
+		double concurrency_;
+		size_t in_flight_;
+		size_t next_index_;
+		size_t next_to_report_;
+		size_t decrease_mark_;
+		bool exhausted_;
+		bool draining_;
+		std::exception_ptr error_;
+		std::map<size_t, BulkItemResult> held_;
+		// Results to deliver, in delivery order
+		std::vector<BulkItemResult> ready_;
+		pplx::task_completion_event<void> done_;
+	};
+}
+
+#endif // !_DOCUMENTDB_BULK_PIPELINE_H_
@@ -25,16 +25,31 @@
 #ifndef _DOCUMENTDB_COLLECTION_H_
 #define _DOCUMENTDB_COLLECTION_H_
 
+#include <functional>
 #include <string>
 #include <memory>
+#include <vector>
 #include <pplx/pplxtasks.h>
 #include <cpprest/http_client.h>
 
+#include "BulkImportOptions.h"
+#include "BulkItemResult.h"
+#include "BulkOptions.h"
+#include "DocumentCache.h"
 #include "DocumentDBEntity.h"
+#include "DocumentDBResponse.h"
 #include "DocumentDBConfiguration.h"
 #include "IndexingPolicy.h"
+#include "ParallelQueryOptions.h"
+#include "PartitionKey.h"
+#include "PartitionKeyDefinition.h"
+#include "PartitionKeyRange.h"
+#include "RawResponse.h"
+#include "SqlQuerySpec.h"
 #include "DocumentIterator.h"
+#include "DocumentMapping.h"
 #include "TriggerIterator.h"
+#include "ValueIterator.h"
 #include "StoredProcedureIterator.h"
 #include "UserDefinedFunctionIterator.h"
 #include "Document.h"
@@ -42,6 +57,7 @@
 #include "TriggerOperation.h"
 #include "TriggerType.h"
 #include "StoredProcedure.h"
+#include "StoredProcedureResponse.h"
 #include "UserDefinedFunction.h"
 
 namespace documentdb {
@@ -62,6 +78,8 @@ namespace documentdb {
 	class Collection : public DocumentDBEntity, public std::enable_shared_from_this < Collection >
 	{
 		friend class DocumentIterator;
+		friend class DocumentPage;
+		friend class NamedCollection;
 		friend class TriggerIterator;
 		friend class StoredProcedureIterator;
 		friend class UserDefinedFunctionIterator;
@@ -79,40 +97,191 @@ namespace documentdb {
 			const utility::string_t& triggers,
 			const utility::string_t& udfs,
 			const utility::string_t& conflicts,
-			const IndexingPolicy& indexing_policy);
+			const IndexingPolicy& indexing_policy,
+			const PartitionKeyDefinition& partition_key = PartitionKeyDefinition());
 
 		virtual ~Collection();
 
+		// The same collection, reporting the diagnostics of the operations sent
+		// through it, and through the entities they return, to diagnostics_handler
+		// instead of the handler of the configuration. Views share the connection
+		// pool, limits and caches, so one can be made per call to attribute the cost
+		// of concurrent operations to their call site. Like any collection, keep the
+		// view until its operations complete.
+		std::shared_ptr<Collection> WithDiagnosticsHandler(
+			const std::function<void(const ResponseDiagnostics&)>& diagnostics_handler) const;
+
+		// On a partitioned collection the document calls taking JSON documents
+		// send the partition key found in them. Those addressing a document by
+		// resource id only, or passing it through unparsed, take its partition key
+		// as an argument instead.
 		pplx::task<std::shared_ptr<Document>> CreateDocumentAsync(
 			const web::json::value& document) const;
 
+		// Adds the generated id, if any, to document itself instead of a copy.
+		pplx::task<std::shared_ptr<Document>> CreateDocumentAsync(
+			web::json::value&& document) const;
+
 		std::shared_ptr<Document> CreateDocument(
 			const web::json::value& document) const;
 
+		std::shared_ptr<Document> CreateDocument(
+			web::json::value&& document) const;
+
 		pplx::task<std::shared_ptr<Document>> CreateDocumentAsync(
 			const utility::string_t& document) const;
 
 		std::shared_ptr<Document> CreateDocument(
 			const utility::string_t& document) const;
 
+		// Creates all documents through a pipeline with adaptive concurrency, see
+		// BulkOptions. Failures are reported per item instead of failing the task.
+		// The documents are copied up front; move them in to avoid holding them
+		// twice, each one is then released once it has been sent.
+		pplx::task<std::vector<BulkItemResult>> CreateDocumentsAsync(
+			const std::vector<web::json::value>& documents,
+			const BulkOptions& options = BulkOptions()) const;
+
+		pplx::task<std::vector<BulkItemResult>> CreateDocumentsAsync(
+			std::vector<web::json::value>&& documents,
+			const BulkOptions& options = BulkOptions()) const;
+
+		std::vector<BulkItemResult> CreateDocuments(
+			const std::vector<web::json::value>& documents,
+			const BulkOptions& options = BulkOptions()) const;
+
+		std::vector<BulkItemResult> CreateDocuments(
+			std::vector<web::json::value>&& documents,
+			const BulkOptions& options = BulkOptions()) const;
+
+		// Streaming variant, next_document is called for the next document only
+		// when the pipeline has room for it and stores it in its argument, returning
+		// false once there are no more. on_result is called for every document.
+		// Neither is called concurrently.
+		pplx::task<void> CreateDocumentsAsync(
+			const std::function<bool(web::json::value&)>& next_document,
+			const std::function<void(const BulkItemResult&)>& on_result,
+			const BulkOptions& options = BulkOptions()) const;
+
+		void CreateDocuments(
+			const std::function<bool(web::json::value&)>& next_document,
+			const std::function<void(const BulkItemResult&)>& on_result,
+			const BulkOptions& options = BulkOptions()) const;
+
+		// Creates the document, or replaces the one with the same id, in a single
+		// request.
+		pplx::task<std::shared_ptr<Document>> UpsertDocumentAsync(
+			const web::json::value& document) const;
+
+		pplx::task<std::shared_ptr<Document>> UpsertDocumentAsync(
+			web::json::value&& document) const;
+
+		std::shared_ptr<Document> UpsertDocument(
+			const web::json::value& document) const;
+
+		std::shared_ptr<Document> UpsertDocument(
+			web::json::value&& document) const;
+
+		// Like CreateDocumentsAsync, upserting every document.
+		pplx::task<std::vector<BulkItemResult>> UpsertDocumentsAsync(
+			const std::vector<web::json::value>& documents,
+			const BulkOptions& options = BulkOptions()) const;
+
+		pplx::task<std::vector<BulkItemResult>> UpsertDocumentsAsync(
+			std::vector<web::json::value>&& documents,
+			const BulkOptions& options = BulkOptions()) const;
+
+		std::vector<BulkItemResult> UpsertDocuments(
+			const std::vector<web::json::value>& documents,
+			const BulkOptions& options = BulkOptions()) const;
+
+		std::vector<BulkItemResult> UpsertDocuments(
+			std::vector<web::json::value>&& documents,
+			const BulkOptions& options = BulkOptions()) const;
+
+		pplx::task<void> UpsertDocumentsAsync(
+			const std::function<bool(web::json::value&)>& next_document,
+			const std::function<void(const BulkItemResult&)>& on_result,
+			const BulkOptions& options = BulkOptions()) const;
+
+		void UpsertDocuments(
+			const std::function<bool(web::json::value&)>& next_document,
+			const std::function<void(const BulkItemResult&)>& on_result,
+			const BulkOptions& options = BulkOptions()) const;
+
+		// Imports documents in batches through a bulk insert stored procedure,
+		// deploying it first if the collection does not have it yet. Batches are
+		// sized by serialized bytes and resumed where the procedure stopped when
+		// its execution time limit cuts one short. Each batch is all or nothing up
+		// to the point it reached, so a failing document, e.g. a duplicate id,
+		// fails the import. On a partitioned collection documents are batched by
+		// the partition key found in them, as a procedure only writes to the
+		// partition it runs in. Completes with the number of documents imported.
+		pplx::task<size_t> ImportDocumentsAsync(
+			const std::vector<web::json::value>& documents,
+			const BulkImportOptions& options = BulkImportOptions()) const;
+
+		size_t ImportDocuments(
+			const std::vector<web::json::value>& documents,
+			const BulkImportOptions& options = BulkImportOptions()) const;
+
 		pplx::task<std::shared_ptr<Document>> GetDocumentAsync(
-			const utility::string_t& resource_id) const;
+			const utility::string_t& resource_id,
+			const PartitionKey& partition_key = PartitionKey()) const;
 
 		std::shared_ptr<Document> GetDocument(
-			const utility::string_t& resource_id) const;
+			const utility::string_t& resource_id,
+			const PartitionKey& partition_key = PartitionKey()) const;
 
+		// The documents share the response pages they were read from, see
+		// Document::Detach.
 		pplx::task<std::vector<std::shared_ptr<Document>>> ListDocumentsAsync() const;
 
 		std::vector<std::shared_ptr<Document>> ListDocuments() const;
 
+		// Passes on every document as soon as it is read from the response, without
+		// holding the whole listing. on_document is not called concurrently.
+		pplx::task<void> ListDocumentsAsync(
+			const std::function<void(const std::shared_ptr<Document>&)>& on_document) const;
+
+		void ListDocuments(
+			const std::function<void(const std::shared_ptr<Document>&)>& on_document) const;
+
 		pplx::task<std::shared_ptr<Document>> ReplaceDocumentAsync(
 			const utility::string_t& resource_id,
 			const web::json::value& document) const;
 
+		pplx::task<std::shared_ptr<Document>> ReplaceDocumentAsync(
+			const utility::string_t& resource_id,
+			web::json::value&& document) const;
+
 		std::shared_ptr<Document> ReplaceDocument(
 			const utility::string_t& resource_id,
 			const web::json::value& document) const;
 
+		std::shared_ptr<Document> ReplaceDocument(
+			const utility::string_t& resource_id,
+			web::json::value&& document) const;
+
+		// Reads the document, revalidating the document cache if one is set, lets
+		// update change its payload and replaces it only if it still has the etag
+		// that was read. When another writer replaced it first the document is read
+		// again and update called again, after a jittered backoff, for at most
+		// max_attempts attempts before PreconditionFailedException is thrown.
+		// Nothing is written when update returns false. Completes with the
+		// document as last read or written.
+		pplx::task<std::shared_ptr<Document>> UpdateDocumentAsync(
+			const utility::string_t& resource_id,
+			const std::function<bool(web::json::value&)>& update,
+			int max_attempts = 10,
+			const PartitionKey& partition_key = PartitionKey()) const;
+
+		std::shared_ptr<Document> UpdateDocument(
+			const utility::string_t& resource_id,
+			const std::function<bool(web::json::value&)>& update,
+			int max_attempts = 10,
+			const PartitionKey& partition_key = PartitionKey()) const;
+
 		pplx::task<void> DeleteDocumentAsync(
 			const std::shared_ptr<Document>& document) const;
 
@@ -120,17 +289,153 @@ namespace documentdb {
 			const std::shared_ptr<Document>& document) const;
 
 		pplx::task<void> DeleteDocumentAsync(
-			const utility::string_t& resource_id) const;
+			const utility::string_t& resource_id,
+			const PartitionKey& partition_key = PartitionKey()) const;
 
 		void DeleteDocument(
-			const utility::string_t& resource_id) const;
+			const utility::string_t& resource_id,
+			const PartitionKey& partition_key = PartitionKey()) const;
 
 		pplx::task<std::shared_ptr<DocumentIterator>> QueryDocumentsAsync(
-			const utility::string_t& query,
+			const SqlQuerySpec& query,
 			const int page_size = 10) const;
 
 		std::shared_ptr<DocumentIterator> QueryDocuments(
-			const utility::string_t& query,
+			const SqlQuerySpec& query,
+			const int page_size = 10) const;
+
+		// Passes on every result as soon as it is read from the response, page
+		// after page, without holding a whole page. on_document is not called
+		// concurrently.
+		pplx::task<void> QueryDocumentsAsync(
+			const SqlQuerySpec& query,
+			const std::function<void(const std::shared_ptr<Document>&)>& on_document,
+			const int page_size = 10) const;
+
+		void QueryDocuments(
+			const SqlQuerySpec& query,
+			const std::function<void(const std::shared_ptr<Document>&)>& on_document,
+			const int page_size = 10) const;
+
+		// Like QueryDocumentsAsync, for queries whose results are not whole
+		// documents, such as projections and SELECT VALUE.
+		pplx::task<std::shared_ptr<ValueIterator>> QueryValuesAsync(
+			const SqlQuerySpec& query,
+			const int page_size = 10) const;
+
+		std::shared_ptr<ValueIterator> QueryValues(
+			const SqlQuerySpec& query,
+			const int page_size = 10) const;
+
+		// Partition key ranges of the collection, read once and kept until a
+		// parallel query finds them outdated by a split.
+		pplx::task<std::vector<PartitionKeyRange>> GetPartitionKeyRangesAsync() const;
+
+		std::vector<PartitionKeyRange> GetPartitionKeyRanges() const;
+
+		// Runs the query against all partition key ranges concurrently and merges
+		// their results as set by the options, see ParallelQuery. The query is run
+		// again once, on fresh ranges, if a range split meanwhile.
+		pplx::task<std::vector<std::shared_ptr<Document>>> QueryDocumentsParallelAsync(
+			const SqlQuerySpec& query,
+			const ParallelQueryOptions& options = ParallelQueryOptions()) const;
+
+		std::vector<std::shared_ptr<Document>> QueryDocumentsParallel(
+			const SqlQuerySpec& query,
+			const ParallelQueryOptions& options = ParallelQueryOptions()) const;
+
+		// Like QueryDocumentsParallelAsync, for projections and aggregates.
+		pplx::task<std::vector<web::json::value>> QueryValuesParallelAsync(
+			const SqlQuerySpec& query,
+			const ParallelQueryOptions& options = ParallelQueryOptions()) const;
+
+		std::vector<web::json::value> QueryValuesParallel(
+			const SqlQuerySpec& query,
+			const ParallelQueryOptions& options = ParallelQueryOptions()) const;
+
+		// Raw document calls, for passing documents through untouched. Documents
+		// are UTF-8 JSON sent as they are, read in place by every attempt, and
+		// responses come back with their body unparsed. Failures throw like the
+		// other calls.
+		pplx::task<RawResponse> CreateDocumentRawAsync(
+			const std::shared_ptr<const std::vector<unsigned char>>& document,
+			const PartitionKey& partition_key = PartitionKey()) const;
+
+		RawResponse CreateDocumentRaw(
+			const std::shared_ptr<const std::vector<unsigned char>>& document,
+			const PartitionKey& partition_key = PartitionKey()) const;
+
+		pplx::task<RawResponse> GetDocumentRawAsync(
+			const utility::string_t& resource_id,
+			const PartitionKey& partition_key = PartitionKey()) const;
+
+		RawResponse GetDocumentRaw(
+			const utility::string_t& resource_id,
+			const PartitionKey& partition_key = PartitionKey()) const;
+
+		pplx::task<RawResponse> ReplaceDocumentRawAsync(
+			const utility::string_t& resource_id,
+			const std::shared_ptr<const std::vector<unsigned char>>& document,
+			const PartitionKey& partition_key = PartitionKey()) const;
+
+		RawResponse ReplaceDocumentRaw(
+			const utility::string_t& resource_id,
+			const std::shared_ptr<const std::vector<unsigned char>>& document,
+			const PartitionKey& partition_key = PartitionKey()) const;
+
+		// One page of results, the continuation of the response asks for the next.
+		pplx::task<RawResponse> QueryDocumentsRawAsync(
+			const SqlQuerySpec& query,
+			const utility::string_t& continuation_id = utility::string_t(),
+			const int page_size = 10) const;
+
+		RawResponse QueryDocumentsRaw(
+			const SqlQuerySpec& query,
+			const utility::string_t& continuation_id = utility::string_t(),
+			const int page_size = 10) const;
+
+		// Typed document calls for types with a DocumentMapping. Documents are
+		// decoded from the response text and encoded into the request text
+		// directly, without web::json::value in between. Partition keys are
+		// handled as by the calls above: GetDocumentAsAsync takes it as an
+		// argument, CreateDocumentAsAsync finds it in the document unless given.
+		template<class T>
+		pplx::task<T> GetDocumentAsAsync(
+			const utility::string_t& resource_id,
+			const PartitionKey& partition_key = PartitionKey()) const;
+
+		template<class T>
+		T GetDocumentAs(
+			const utility::string_t& resource_id,
+			const PartitionKey& partition_key = PartitionKey()) const;
+
+		// Completes with the document as created, system properties included if
+		// the mapping has them. Types mapping no id field get a generated one.
+		template<class T>
+		pplx::task<T> CreateDocumentAsAsync(
+			const T& document,
+			const PartitionKey& partition_key = PartitionKey()) const;
+
+		template<class T>
+		T CreateDocumentAs(
+			const T& document,
+			const PartitionKey& partition_key = PartitionKey()) const;
+
+		// Passes on every result as it is read, like QueryDocumentsAsync.
+		template<class T>
+		pplx::task<void> QueryDocumentsAsAsync(
+			const SqlQuerySpec& query,
+			const std::function<void(T&&)>& on_document,
+			const int page_size = 10) const;
+
+		template<class T>
+		pplx::task<std::vector<T>> QueryDocumentsAsAsync(
+			const SqlQuerySpec& query,
+			const int page_size = 10) const;
+
+		template<class T>
+		std::vector<T> QueryDocumentsAs(
+			const SqlQuerySpec& query,
 			const int page_size = 10) const;
 
 		//triggers management
@@ -156,6 +461,15 @@ namespace documentdb {
 
 		std::vector<std::shared_ptr<Trigger>> ListTriggers() const;
 
+		// Passes on every trigger as soon as it is read from the response, without
+		// holding the whole listing. on_trigger is not called concurrently.
+		// Unlike ListTriggersAsync, it always reads from the service.
+		pplx::task<void> ListTriggersAsync(
+			const std::function<void(const std::shared_ptr<Trigger>&)>& on_trigger) const;
+
+		void ListTriggers(
+			const std::function<void(const std::shared_ptr<Trigger>&)>& on_trigger) const;
+
 		pplx::task<std::shared_ptr<Trigger>> ReplaceTriggerAsync(
 			const utility::string_t& id,
 			const utility::string_t& new_id,
@@ -183,11 +497,11 @@ namespace documentdb {
 			const utility::string_t& resource_id) const;
 
 		pplx::task<std::shared_ptr<TriggerIterator>> QueryTriggersAsync(
-			const utility::string_t& query,
+			const SqlQuerySpec& query,
 			const int page_size = 10) const;
 
 		std::shared_ptr<TriggerIterator> QueryTriggers(
-			const utility::string_t& query,
+			const SqlQuerySpec& query,
 			const int page_size = 10) const;
 
 		//stored procedures management
@@ -209,6 +523,15 @@ namespace documentdb {
 
 		std::vector<std::shared_ptr<StoredProcedure>> ListStoredProcedures() const;
 
+		// Passes on every stored procedure as soon as it is read from the response, without
+		// holding the whole listing. on_stored_procedure is not called concurrently.
+		// Unlike ListStoredProceduresAsync, it always reads from the service.
+		pplx::task<void> ListStoredProceduresAsync(
+			const std::function<void(const std::shared_ptr<StoredProcedure>&)>& on_stored_procedure) const;
+
+		void ListStoredProcedures(
+			const std::function<void(const std::shared_ptr<StoredProcedure>&)>& on_stored_procedure) const;
+
 		pplx::task<std::shared_ptr<StoredProcedure>> ReplaceStoredProcedureAsync(
 			const utility::string_t& id,
 			const utility::string_t& new_id,
@@ -232,20 +555,42 @@ namespace documentdb {
 			const utility::string_t& resource_id) const;
 
 		pplx::task<std::shared_ptr<StoredProcedureIterator>> QueryStoredProceduresAsync(
-			const utility::string_t& query,
+			const SqlQuerySpec& query,
 			const int page_size = 10) const;
 
 		std::shared_ptr<StoredProcedureIterator> QueryStoredProcedures(
-			const utility::string_t& query,
+			const SqlQuerySpec& query,
 			const int page_size = 10) const;
 
-		pplx::task<void> ExecuteStoredProcedureAsync(
+		// input is the array of arguments passed to the procedure. On a
+		// partitioned collection the procedure runs in the partition of
+		// partition_key, which is required.
+		pplx::task<StoredProcedureResponse> ExecuteStoredProcedureAsync(
+			const utility::string_t& resource_id,
+			const web::json::value& input,
+			const PartitionKey& partition_key = PartitionKey()) const;
+
+		StoredProcedureResponse ExecuteStoredProcedure(
+			const utility::string_t& resource_id,
+			const web::json::value& input,
+			const PartitionKey& partition_key = PartitionKey()) const;
+
+		// Executes the procedure with input, then again for as long as next returns
+		// true, with the arguments next stores in its second parameter, typically
+		// built from the state the procedure returned. Lets long running work be
+		// split into calls that fit within the execution time limit of the server.
+		// Completes with the response of the last call.
+		pplx::task<StoredProcedureResponse> ExecuteStoredProcedureUntilDoneAsync(
 			const utility::string_t& resource_id,
-			const web::json::value& input) const;
+			const web::json::value& input,
+			const std::function<bool(const StoredProcedureResponse&, web::json::value&)>& next,
+			const PartitionKey& partition_key = PartitionKey()) const;
 
-		void ExecuteStoredProcedure(
+		StoredProcedureResponse ExecuteStoredProcedureUntilDone(
 			const utility::string_t& resource_id,
-			const web::json::value& input) const;
+			const web::json::value& input,
+			const std::function<bool(const StoredProcedureResponse&, web::json::value&)>& next,
+			const PartitionKey& partition_key = PartitionKey()) const;
 
 		// User defined functions management
 		pplx::task<std::shared_ptr<UserDefinedFunction>> CreateUserDefinedFunctionAsync(
@@ -266,6 +611,15 @@ namespace documentdb {
 
 		std::vector<std::shared_ptr<UserDefinedFunction>> ListUserDefinedFunctions() const;
 
+		// Passes on every user defined function as soon as it is read from the response, without
+		// holding the whole listing. on_user_defined_function is not called concurrently.
+		// Unlike ListUserDefinedFunctionsAsync, it always reads from the service.
+		pplx::task<void> ListUserDefinedFunctionsAsync(
+			const std::function<void(const std::shared_ptr<UserDefinedFunction>&)>& on_user_defined_function) const;
+
+		void ListUserDefinedFunctions(
+			const std::function<void(const std::shared_ptr<UserDefinedFunction>&)>& on_user_defined_function) const;
+
 		pplx::task<std::shared_ptr<UserDefinedFunction>> ReplaceUserDefinedFunctionAsync(
 			const utility::string_t& id,
 			const utility::string_t& new_id,
@@ -289,36 +643,36 @@ namespace documentdb {
 			const utility::string_t& resource_id) const;
 
 		pplx::task<std::shared_ptr<UserDefinedFunctionIterator>> QueryUserDefinedFunctionsAsync(
-			const utility::string_t& query,
+			const SqlQuerySpec& query,
 			const int page_size = 10) const;
 
 		std::shared_ptr<UserDefinedFunctionIterator> QueryUserDefinedFunctions(
-			const utility::string_t& query,
+			const SqlQuerySpec& query,
 			const int page_size = 10) const;
 
-		utility::string_t docs() const
+		const utility::string_t& docs() const
 		{
-			return docs_;
+			return *docs_;
 		}
 
-		utility::string_t sprocs() const
+		const utility::string_t& sprocs() const
 		{
-			return sprocs_;
+			return *sprocs_;
 		}
 
-		utility::string_t triggers() const
+		const utility::string_t& triggers() const
 		{
-			return triggers_;
+			return *triggers_;
 		}
 
-		utility::string_t udfs() const
+		const utility::string_t& udfs() const
 		{
-			return udfs_;
+			return *udfs_;
 		}
 
-		utility::string_t conflicts() const
+		const utility::string_t& conflicts() const
 		{
-			return conflicts_;
+			return *conflicts_;
 		}
 
 		IndexingPolicy indexing_policy() const
@@ -326,10 +680,35 @@ namespace documentdb {
 			return indexing_policy_;
 		}
 
+		// Empty unless the collection is partitioned.
+		const PartitionKeyDefinition& partition_key() const
+		{
+			return partition_key_;
+		}
+
+		// Cache of the documents read with GetDocument, nullptr by default.
+		// Documents created or replaced through this collection are written to
+		// it and deleted ones removed. The cache may be shared by several
+		// collections; set it before the collection is used.
+		const std::shared_ptr<DocumentCache>& document_cache() const
+		{
+			return document_cache_;
+		}
+
+		void set_document_cache(const std::shared_ptr<DocumentCache>& document_cache)
+		{
+			document_cache_ = document_cache;
+		}
+
 	private:
 		std::shared_ptr<Document> DocumentFromJson(
 			const web::json::value& json_collection) const;
 
+		// Shares json_document as the payload of the document, which borrows its
+		// metadata from it.
+		std::shared_ptr<Document> DocumentFromJson(
+			const std::shared_ptr<const web::json::value>& json_document) const;
+
 		std::shared_ptr<Trigger> TriggerFromJson(
 			const web::json::value* json_trigger) const;
 
@@ -339,15 +718,234 @@ namespace documentdb {
 		std::shared_ptr<UserDefinedFunction> UserDefinedFunctionFromJson(
 			const web::json::value* json_udf) const;
 
+		// Requests behind the metadata cache.
+		pplx::task<std::shared_ptr<Trigger>> ReadTriggerAsync(
+			const utility::string_t& resource_id) const;
+
+		pplx::task<std::vector<std::shared_ptr<Trigger>>> ReadTriggersAsync() const;
+
+		pplx::task<std::shared_ptr<StoredProcedure>> ReadStoredProcedureAsync(
+			const utility::string_t& resource_id) const;
+
+		pplx::task<std::vector<std::shared_ptr<StoredProcedure>>> ReadStoredProceduresAsync() const;
+
+		pplx::task<std::shared_ptr<UserDefinedFunction>> ReadUserDefinedFunctionAsync(
+			const utility::string_t& resource_id) const;
+
+		pplx::task<std::vector<std::shared_ptr<UserDefinedFunction>>> ReadUserDefinedFunctionsAsync() const;
+
 		static utility::string_t GenerateGuid();
 
-		utility::string_t docs_;
-		utility::string_t sprocs_;
-		utility::string_t triggers_;
-		utility::string_t udfs_;
-		utility::string_t conflicts_;
+		// Serializes a new document, giving it a generated id if it has none.
+		static utility::string_t SerializeNewDocument(
+			const web::json::value& document);
+
+		static utility::string_t SerializeNewDocument(
+			web::json::value&& document);
+
+		// Lists the resources under the resources link of the collection, passing
+		// on the elements of array_field as they are read from the response.
+		pplx::task<void> StreamResourcesAsync(
+			const utility::string_t& resource_type,
+			const utility::string_t& resources,
+			const utility::string_t& array_field,
+			const std::function<void(web::json::value&&)>& on_item) const;
+
+		// Reads the documents of a list or query response as they arrive.
+		ResponseBodyReader StreamDocuments(
+			const std::function<void(const std::shared_ptr<Document>&)>& on_document) const;
+
+		// Sends the query for the page after the continuation and the following
+		// ones, reading each with read_body.
+		pplx::task<void> StreamQueryPageAsync(
+			const SqlQuerySpec& query,
+			const int page_size,
+			const utility::string_t& continuation_id,
+			const ResponseBodyReader& read_body) const;
+
+		pplx::task<std::vector<PartitionKeyRange>> ReadPartitionKeyRangesAsync(
+			const utility::string_t& continuation,
+			const std::shared_ptr<std::vector<PartitionKeyRange>>& ranges) const;
+
+		void ForgetPartitionKeyRanges() const;
+
+		pplx::task<std::vector<web::json::value>> QueryValuesParallelAsync(
+			const SqlQuerySpec& query,
+			const ParallelQueryOptions& options,
+			bool retry_on_split) const;
+
+		// Document calls on the UTF-8 JSON text of the documents, for the typed ones.
+		pplx::task<void> GetDocumentTextAsync(
+			const utility::string_t& resource_id,
+			const PartitionKey& partition_key,
+			const std::function<void(const std::string&)>& on_document) const;
+
+		// Gives the document a generated id unless has_id, and sends the partition
+		// key found in it unless one is given, like CreateDocumentAsync.
+		pplx::task<void> CreateDocumentTextAsync(
+			std::string document,
+			bool has_id,
+			const PartitionKey& partition_key,
+			const std::function<void(const std::string&)>& on_document) const;
+
+		pplx::task<void> QueryDocumentsTextAsync(
+			const SqlQuerySpec& query,
+			const int page_size,
+			const std::function<void(const std::string&)>& on_document) const;
+
+		// Replaces only while the document has the etag if_match, if not empty.
+		pplx::task<std::shared_ptr<Document>> SendReplaceDocumentAsync(
+			const utility::string_t& resource_id,
+			const utility::string_t& document,
+			const PartitionKey& partition_key,
+			const utility::string_t& if_match = utility::string_t()) const;
+
+		pplx::task<std::shared_ptr<Document>> UpdateDocumentAttemptAsync(
+			const utility::string_t& resource_id,
+			const std::function<bool(web::json::value&)>& update,
+			const PartitionKey& partition_key,
+			int max_attempts,
+			int attempt) const;
+
+		// Upserts instead with upsert set.
+		pplx::task<DocumentDBResponse> SendCreateDocumentAsync(
+			const utility::string_t& document,
+			const PartitionKey& partition_key,
+			bool upsert = false) const;
+
+		// Completes with the document created, or replaced by an upsert.
+		pplx::task<std::shared_ptr<Document>> WriteDocumentAsync(
+			const utility::string_t& document,
+			const PartitionKey& partition_key,
+			bool upsert) const;
+
+		// Moves the documents out of pending as they are sent
+		pplx::task<std::vector<BulkItemResult>> WriteDocumentsAsync(
+			const std::shared_ptr<std::vector<web::json::value>>& pending,
+			const BulkOptions& options,
+			bool upsert) const;
+
+		pplx::task<void> WriteDocumentsAsync(
+			const std::function<bool(web::json::value&)>& next_document,
+			const std::function<void(const BulkItemResult&)>& on_result,
+			const BulkOptions& options,
+			bool upsert) const;
+
+		// input is the serialized array of arguments of the procedure
+		pplx::task<DocumentDBResponse> SendExecuteStoredProcedureAsync(
+			const utility::string_t& resource_id,
+			const utility::string_t& input,
+			const PartitionKey& partition_key) const;
+
+		struct BulkImportState;
+
+		// Resource id of the bulk import stored procedure, deployed if missing.
+		pplx::task<utility::string_t> DeployBulkImportStoredProcedureAsync() const;
+
+		pplx::task<void> ImportNextBatchAsync(
+			const std::shared_ptr<BulkImportState>& state) const;
+
+		pplx::task<void> ImportBatchAsync(
+			const std::shared_ptr<BulkImportState>& state,
+			size_t batch,
+			size_t offset,
+			int stalled_calls) const;
+
+		std::shared_ptr<const utility::string_t> docs_;
+		std::shared_ptr<const utility::string_t> sprocs_;
+		std::shared_ptr<const utility::string_t> triggers_;
+		std::shared_ptr<const utility::string_t> udfs_;
+		std::shared_ptr<const utility::string_t> conflicts_;
 		IndexingPolicy indexing_policy_;
+		PartitionKeyDefinition partition_key_;
+		std::shared_ptr<DocumentCache> document_cache_;
+
+		// Held by pointer so that collections stay copy-assignable
+		struct PartitionKeyRangeCache;
+		std::shared_ptr<PartitionKeyRangeCache> partition_key_ranges_;
 	};
+
+	template<class T>
+	pplx::task<T> Collection::GetDocumentAsAsync(
+		const utility::string_t& resource_id,
+		const PartitionKey& partition_key) const
+	{
+		std::shared_ptr<T> document = std::make_shared<T>();
+		return this->GetDocumentTextAsync(resource_id, partition_key, [document](const std::string& text)
+		{
+			*document = DecodeDocument<T>(text);
+		}).then([document]()
+		{
+			return std::move(*document);
+		});
+	}
+
+	template<class T>
+	T Collection::GetDocumentAs(
+		const utility::string_t& resource_id,
+		const PartitionKey& partition_key) const
+	{
+		return this->GetDocumentAsAsync<T>(resource_id, partition_key).get();
+	}
+
+	template<class T>
+	pplx::task<T> Collection::CreateDocumentAsAsync(
+		const T& document,
+		const PartitionKey& partition_key) const
+	{
+		std::shared_ptr<T> created = std::make_shared<T>();
+		const bool has_id = DocumentFields<T>::Instance().Has(_XPLATSTR("id"));
+		return this->CreateDocumentTextAsync(EncodeDocument(document), has_id, partition_key, [created](const std::string& text)
+		{
+			*created = DecodeDocument<T>(text);
+		}).then([created]()
+		{
+			return std::move(*created);
+		});
+	}
+
+	template<class T>
+	T Collection::CreateDocumentAs(
+		const T& document,
+		const PartitionKey& partition_key) const
+	{
+		return this->CreateDocumentAsAsync(document, partition_key).get();
+	}
+
+	template<class T>
+	pplx::task<void> Collection::QueryDocumentsAsAsync(
+		const SqlQuerySpec& query,
+		const std::function<void(T&&)>& on_document,
+		const int page_size) const
+	{
+		return this->QueryDocumentsTextAsync(query, page_size, [on_document](const std::string& text)
+		{
+			on_document(DecodeDocument<T>(text));
+		});
+	}
+
+	template<class T>
+	pplx::task<std::vector<T>> Collection::QueryDocumentsAsAsync(
+		const SqlQuerySpec& query,
+		const int page_size) const
+	{
+		std::shared_ptr<std::vector<T>> documents = std::make_shared<std::vector<T>>();
+		return this->QueryDocumentsAsAsync<T>(query, [documents](T&& document)
+		{
+			documents->push_back(std::move(document));
+		}, page_size).then([documents]()
+		{
+			return std::move(*documents);
+		});
+	}
+
+	template<class T>
+	std::vector<T> Collection::QueryDocumentsAs(
+		const SqlQuerySpec& query,
+		const int page_size) const
+	{
+		return this->QueryDocumentsAsAsync<T>(query, page_size).get();
+	}
 }
 
 #endif // !_DOCUMENTDB_COLLECTION_H_
@@ -25,26 +25,90 @@
 #ifndef _DOCUMENTDB_CONNECTION_HELPER_H_
 #define _DOCUMENTDB_CONNECTION_HELPER_H_
 
+#include <chrono>
+#include <functional>
 #include <vector>
 
 #include <cpprest/http_client.h>
 
+#include "DocumentDBConfiguration.h"
+#include "DocumentDBResponse.h"
 #include "exceptions.h"
+#include "PartitionKey.h"
+#include "RequestSigner.h"
+#include "RetryOptions.h"
+#include "SqlQuerySpec.h"
 
 
 web::http::http_request CreateRequest(
 	const web::http::method& method,
 	const utility::string_t& resource_type,
 	const utility::string_t& resource_id,
-	const std::vector<unsigned char>& master_key);
+	const documentdb::RequestSigner& request_signer,
+	bool name_based_link = false);
 
 web::http::http_request CreateQueryRequest(
-	const utility::string_t& query,
+	const documentdb::SqlQuerySpec& query,
 	const int pageSize,
 	const utility::string_t& resource_type,
 	const utility::string_t& resource_id,
-	const std::vector<unsigned char>& master_key,
-	const utility::string_t& continuation_id = utility::string_t());
+	const documentdb::RequestSigner& request_signer,
+	const utility::string_t& continuation_id = utility::string_t(),
+	bool name_based_link = false,
+	bool enable_cross_partition = false);
+
+// Routes a document request to the partition of the document, if it has a
+// partition key.
+void SetPartitionKey(
+	web::http::http_request& request,
+	const documentdb::PartitionKey& partition_key);
+
+// Whether sending the request a second time has the same effect as sending it
+// once: reads, replaces, deletes, queries and upserts. A create or a stored
+// procedure execution that failed in transport may have been carried out.
+bool IsSafeToResend(
+	const web::http::http_request& request);
+
+// Sends a request through the client of the configuration, retrying it as set
+// by the retry options of its connection policy. Transport errors are only
+// retried for requests that are safe to resend, see IsSafeToResend.
+// create_request is called for every attempt so that a retried request is
+// built and signed again. When the
+// connection policy limits the requests in flight, each attempt first waits for
+// a free slot and holds it until the response body has been read. The final
+// response is read and parsed before the task completes and its diagnostics
+// are passed to the handler of the configuration, if any.
+pplx::task<documentdb::DocumentDBResponse> ExecuteRequestAsync(
+	const DocumentDBConfiguration& document_db_configuration,
+	const std::function<web::http::http_request()>& create_request);
+
+pplx::task<documentdb::DocumentDBResponse> ExecuteRequestAsync(
+	const DocumentDBConfiguration& document_db_configuration,
+	const std::function<web::http::http_request()>& create_request,
+	const documentdb::ResponseBodyReader& read_body);
+
+// Reads the body as it arrives, passing on the elements of its array_field
+// as each is complete, see JsonArrayReader. Completes with the rest of the body.
+pplx::task<std::shared_ptr<const web::json::value>> ReadJsonArrayAsync(
+	const web::http::http_response& response,
+	const utility::string_t& array_field,
+	const std::function<void(web::json::value&&)>& on_item);
+
+// Like ReadJsonArrayAsync, passing on the elements as their UTF-8 text.
+pplx::task<std::shared_ptr<const web::json::value>> ReadJsonArrayTextAsync(
+	const web::http::http_response& response,
+	const utility::string_t& array_field,
+	const std::function<void(const std::string&)>& on_item_text);
+
+// Completes after the delay without holding a thread while waiting.
+pplx::task<void> DelayAsync(
+	const std::chrono::milliseconds& delay);
+
+// Uniform in [0, backoff] where backoff starts at the initial backoff of the
+// options and doubles with every attempt, up to their max backoff.
+std::chrono::milliseconds JitteredBackoff(
+	const documentdb::RetryOptions& options,
+	int attempt);
 
 __declspec(noreturn)
 void ThrowExceptionFromResponse(
@@ -0,0 +1,187 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#ifndef _DOCUMENTDB_CONNECTION_POLICY_H_
+#define _DOCUMENTDB_CONNECTION_POLICY_H_
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+
+#include <cpprest/http_client.h>
+
+#ifndef _WIN32
+#include <boost/asio.hpp>
+#endif
+
+#include "RetryOptions.h"
+
+namespace documentdb
+{
+	// Transport settings of the client. Defaults keep pooled connections alive,
+	// disable Nagle's algorithm, do not cap the number of concurrent requests and
+	// do not read query results ahead.
+	class ConnectionPolicy
+	{
+	public:
+		ConnectionPolicy();
+
+		virtual ~ConnectionPolicy();
+
+		// Maximum number of requests in flight at once, 0 means unlimited. Every
+		// request in flight holds one pooled connection, so this caps the pool size.
+		// Requests over the limit wait asynchronously for a free slot.
+		size_t max_connections() const
+		{
+			return max_connections_;
+		}
+
+		void set_max_connections(size_t max_connections)
+		{
+			max_connections_ = max_connections;
+		}
+
+		// Timeout of a single HTTP request.
+		utility::seconds request_timeout() const
+		{
+			return request_timeout_;
+		}
+
+		void set_request_timeout(const utility::seconds& request_timeout)
+		{
+			request_timeout_ = request_timeout;
+		}
+
+		// TCP_NODELAY on pooled connections.
+		bool tcp_no_delay() const
+		{
+			return tcp_no_delay_;
+		}
+
+		void set_tcp_no_delay(bool tcp_no_delay)
+		{
+			tcp_no_delay_ = tcp_no_delay;
+		}
+
+		// SO_KEEPALIVE on pooled connections, so idle connections survive load
+		// balancers and NATs between requests instead of being re-established.
+		bool keep_alive() const
+		{
+			return keep_alive_;
+		}
+
+		void set_keep_alive(bool keep_alive)
+		{
+			keep_alive_ = keep_alive;
+		}
+
+		// Number of query result pages fetched ahead of the consumer of an iterator,
+		// 0, the default, disables read-ahead. Pages read ahead are billed even when
+		// the consumer stops before reaching them.
+		size_t query_prefetch_pages() const
+		{
+			return query_prefetch_pages_;
+		}
+
+		void set_query_prefetch_pages(size_t query_prefetch_pages)
+		{
+			query_prefetch_pages_ = query_prefetch_pages;
+		}
+
+		// Bytes of response bodies an iterator may buffer ahead of its consumer.
+		size_t query_prefetch_max_bytes() const
+		{
+			return query_prefetch_max_bytes_;
+		}
+
+		void set_query_prefetch_max_bytes(size_t query_prefetch_max_bytes)
+		{
+			query_prefetch_max_bytes_ = query_prefetch_max_bytes;
+		}
+
+		// Time databases, collections, stored procedures, triggers and user
+		// defined functions are cached before being read again in the background,
+		// 0 disables the cache. See MetadataCache.
+		std::chrono::milliseconds metadata_cache_ttl() const
+		{
+			return metadata_cache_ttl_;
+		}
+
+		void set_metadata_cache_ttl(const std::chrono::milliseconds& metadata_cache_ttl)
+		{
+			metadata_cache_ttl_ = metadata_cache_ttl;
+		}
+
+		const RetryOptions& retry_options() const
+		{
+			return retry_options_;
+		}
+
+		void set_retry_options(const RetryOptions& retry_options)
+		{
+			retry_options_ = retry_options;
+		}
+
+#ifndef _WIN32
+		typedef std::function<void(const boost::system::error_code&)> SocketErrorHandler;
+
+		// Called when TCP_NODELAY or SO_KEEPALIVE could not be set on a connection,
+		// for example because the account host could not be resolved to open a
+		// new socket with. The request goes on without the option.
+		const SocketErrorHandler& socket_error_handler() const
+		{
+			return socket_error_handler_;
+		}
+
+		void set_socket_error_handler(const SocketErrorHandler& socket_error_handler)
+		{
+			socket_error_handler_ = socket_error_handler;
+		}
+
+		// Sets TCP_NODELAY and SO_KEEPALIVE on an open socket as configured.
+		// Returns the first error, the remaining option is still attempted.
+		boost::system::error_code ApplySocketOptions(
+			boost::asio::ip::tcp::socket& socket) const;
+#endif
+
+		// Builds the cpprest client configuration for an account endpoint.
+		web::http::client::http_client_config ToHttpClientConfig(
+			const utility::string_t& url_connection) const;
+
+	private:
+		size_t max_connections_;
+		utility::seconds request_timeout_;
+		bool tcp_no_delay_;
+		bool keep_alive_;
+		size_t query_prefetch_pages_;
+		size_t query_prefetch_max_bytes_;
+		std::chrono::milliseconds metadata_cache_ttl_;
+		RetryOptions retry_options_;
+#ifndef _WIN32
+		SocketErrorHandler socket_error_handler_;
+#endif
+	};
+}
+
+#endif // !_DOCUMENTDB_CONNECTION_POLICY_H_
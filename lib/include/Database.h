@@ -25,6 +25,7 @@
 #ifndef _DOCUMENTDB_DATABASE_H_
 #define _DOCUMENTDB_DATABASE_H_
 
+#include <functional>
 #include <string>
 #include <vector>
 #include <memory>
@@ -54,6 +55,11 @@ namespace documentdb {
 
 		virtual ~Database();
 
+		// The same database, reporting diagnostics to diagnostics_handler, see
+		// Collection::WithDiagnosticsHandler.
+		std::shared_ptr<Database> WithDiagnosticsHandler(
+			const std::function<void(const ResponseDiagnostics&)>& diagnostics_handler) const;
+
 		//collections management
 
 		pplx::task<std::shared_ptr<Collection>> CreateCollectionAsync(
@@ -62,6 +68,18 @@ namespace documentdb {
 		std::shared_ptr<Collection> CreateCollection(
 			const utility::string_t& id) const;
 
+		// Creates a partitioned collection. The offer throughput, in request units
+		// per second, is left to the service default when 0.
+		pplx::task<std::shared_ptr<Collection>> CreateCollectionAsync(
+			const utility::string_t& id,
+			const PartitionKeyDefinition& partition_key,
+			int offer_throughput = 0) const;
+
+		std::shared_ptr<Collection> CreateCollection(
+			const utility::string_t& id,
+			const PartitionKeyDefinition& partition_key,
+			int offer_throughput = 0) const;
+
 		pplx::task<void> DeleteCollectionAsync(
 			const utility::string_t& resource_id) const;
 
@@ -80,18 +98,26 @@ namespace documentdb {
 		std::shared_ptr<Collection> GetCollection(
 			const utility::string_t& resource_id) const;
 
+		// Reads the collection by its id and that of this database, in a single
+		// request.
+		pplx::task<std::shared_ptr<Collection>> GetCollectionByIdAsync(
+			const utility::string_t& id) const;
+
+		std::shared_ptr<Collection> GetCollectionById(
+			const utility::string_t& id) const;
+
 		pplx::task<std::vector<std::shared_ptr<Collection>>> ListCollectionsAsync() const;
 
 		std::vector<std::shared_ptr<Collection>> ListCollections() const;
 
-		utility::string_t colls() const
+		const utility::string_t& colls() const
 		{
-			return colls_;
+			return *colls_;
 		}
 
-		utility::string_t users() const
+		const utility::string_t& users() const
 		{
-			return users_;
+			return *users_;
 		}
 
 		//users management
@@ -135,8 +161,12 @@ namespace documentdb {
 		std::shared_ptr<Collection> CollectionFromJson(const web::json::value* json_collection) const;
 		std::shared_ptr<User> UserFromJson(const web::json::value* json_user) const;
 
-		utility::string_t colls_;
-		utility::string_t users_;
+		// Request behind the metadata cache.
+		pplx::task<std::shared_ptr<Collection>> ReadCollectionAsync(
+			const utility::string_t& resource_id) const;
+
+		std::shared_ptr<const utility::string_t> colls_;
+		std::shared_ptr<const utility::string_t> users_;
 	};
 
 }
@@ -25,6 +25,7 @@
 #ifndef _DOCUMENTDB_DOCUMENT_H_
 #define _DOCUMENTDB_DOCUMENT_H_
 
+#include <functional>
 #include <string>
 #include <memory>
 #include <pplx/pplxtasks.h>
@@ -33,6 +34,7 @@
 #include "DocumentDBConfiguration.h"
 #include "Attachment.h"
 #include "AttachmentIterator.h"
+#include "SqlQuerySpec.h"
 
 namespace documentdb {
 	class Document : public DocumentDBEntity, public std::enable_shared_from_this < Document >
@@ -50,8 +52,30 @@ namespace documentdb {
 			const utility::string_t& attachments,
 			const web::json::value& payload);
 
+		// Shares the payload instead of copying it.
+		Document(
+			const std::shared_ptr<const DocumentDBConfiguration>& document_db_configuration,
+			const utility::string_t& id,
+			const utility::string_t& resource_id,
+			const unsigned long ts,
+			const utility::string_t& self,
+			const utility::string_t& etag,
+			const utility::string_t& attachments,
+			const std::shared_ptr<const web::json::value>& payload);
+
+		// Document as returned by the service, its metadata is read from the
+		// payload in place.
+		Document(
+			const std::shared_ptr<const DocumentDBConfiguration>& document_db_configuration,
+			const std::shared_ptr<const web::json::value>& payload);
+
 		virtual ~Document();
 
+		// The same document, reporting diagnostics to diagnostics_handler, see
+		// Collection::WithDiagnosticsHandler.
+		std::shared_ptr<Document> WithDiagnosticsHandler(
+			const std::function<void(const ResponseDiagnostics&)>& diagnostics_handler) const;
+
 		pplx::task<std::shared_ptr<Attachment>> CreateAttachmentAsync(
 			const utility::string_t& id,
 			const utility::string_t& contentType,
@@ -82,6 +106,15 @@ namespace documentdb {
 
 		std::vector<std::shared_ptr<Attachment>> ListAttachments() const;
 
+		// Passes on every attachment as soon as it is read from the response,
+		// without holding the whole listing. on_attachment is not called
+		// concurrently.
+		pplx::task<void> ListAttachmentsAsync(
+			const std::function<void(const std::shared_ptr<Attachment>&)>& on_attachment) const;
+
+		void ListAttachments(
+			const std::function<void(const std::shared_ptr<Attachment>&)>& on_attachment) const;
+
 		pplx::task<std::shared_ptr<Attachment>> ReplaceAttachmentAsync(
 			const utility::string_t& id,
 			const utility::string_t& new_id,
@@ -107,28 +140,42 @@ namespace documentdb {
 			const utility::string_t& resource_id) const;
 
 		pplx::task<std::shared_ptr<AttachmentIterator>> QueryAttachmentsAsync(
-			const utility::string_t& query,
+			const SqlQuerySpec& query,
 			const int page_size = 10) const;
 
 		std::shared_ptr<AttachmentIterator> QueryAttachments(
-			const utility::string_t& query,
+			const SqlQuerySpec& query,
 			const int page_size = 10) const;
 
-		utility::string_t attachments() const
+		const utility::string_t& attachments() const
 		{
-			return attachments_;
+			return *attachments_;
 		}
 
-		web::json::value payload() const
+		const web::json::value& payload() const
+		{
+			return *payload_;
+		}
+
+		// The payload is immutable and may be shared with other documents, e.g.
+		// those read from the same query page.
+		const std::shared_ptr<const web::json::value>& shared_payload() const
 		{
 			return payload_;
 		}
+
+		// Copy of the document owning its payload alone. Documents read from a
+		// query page or a listing share the whole response they came with, which
+		// stays in memory as long as any of them does; detach those kept longer
+		// than the rest of their page.
+		std::shared_ptr<Document> Detach() const;
+
 	private:
 		std::shared_ptr<Attachment> AttachmentFromJson(
 			const web::json::value& json_attachment) const;
 
-		utility::string_t attachments_;
-		web::json::value payload_;
+		std::shared_ptr<const utility::string_t> attachments_;
+		std::shared_ptr<const web::json::value> payload_;
 	};
 }
 
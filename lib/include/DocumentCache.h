@@ -0,0 +1,144 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#ifndef _DOCUMENTDB_DOCUMENT_CACHE_H_
+#define _DOCUMENTDB_DOCUMENT_CACHE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <cpprest/asyncrt_utils.h>
+
+namespace documentdb
+{
+	class Document; // forward declaration
+
+	// Documents read by resource id, bounded by the bytes of their payloads,
+	// see Collection::set_document_cache. Cached documents are revalidated with
+	// their etag on every read, so they are never served stale.
+	//
+	// Eviction is least recently used. A new document is only admitted over
+	// the least recently used one if it has been asked for more often, going by
+	// a count-min sketch of recent lookups (TinyLFU), so a scan of cold
+	// documents does not flush the hot ones. Documents recently found missing
+	// are remembered for not_found_ttl.
+	class DocumentCache
+	{
+	public:
+		DocumentCache(
+			size_t max_bytes,
+			const std::chrono::milliseconds& not_found_ttl = std::chrono::seconds(5));
+
+		virtual ~DocumentCache();
+
+		// False if nothing is cached for resource_id. Otherwise either document
+		// is set, or not_found is the exception of a recent read of it.
+		bool TryGet(
+			const utility::string_t& resource_id,
+			std::shared_ptr<Document>& document,
+			std::exception_ptr& not_found);
+
+		// size is the number of bytes accounted for the document. Replaces what
+		// is cached for resource_id, if anything.
+		void Put(
+			const utility::string_t& resource_id,
+			const std::shared_ptr<Document>& document,
+			size_t size);
+
+		void PutNotFound(
+			const utility::string_t& resource_id,
+			const std::exception_ptr& not_found);
+
+		void Remove(
+			const utility::string_t& resource_id);
+
+		size_t max_bytes() const
+		{
+			return max_bytes_;
+		}
+
+		// Bytes accounted for the entries currently cached.
+		size_t bytes() const;
+
+		size_t count() const;
+
+	private:
+		DocumentCache(const DocumentCache&);
+		DocumentCache& operator=(const DocumentCache&);
+
+		typedef std::chrono::steady_clock clock;
+
+		struct Entry
+		{
+			utility::string_t resource_id;
+			uint64_t hash;
+			std::shared_ptr<Document> document;
+			std::exception_ptr not_found;
+			clock::time_point expires;
+			size_t size;
+		};
+
+		typedef std::list<Entry> EntryList;
+
+		void Insert(
+			Entry&& entry);
+
+		void Erase(
+			EntryList::iterator entry);
+
+		// Count-min sketch of 4-bit counters, halved every sample_size_ additions
+		// so that it follows the recent popularity of documents.
+		void RecordAccess(
+			uint64_t hash);
+
+		unsigned int Frequency(
+			uint64_t hash) const;
+
+		size_t CounterIndex(
+			uint64_t hash,
+			size_t row) const;
+
+		static const size_t SKETCH_ROWS = 4;
+
+		const size_t max_bytes_;
+		const std::chrono::milliseconds not_found_ttl_;
+		size_t bytes_;
+		// Most recently used first
+		EntryList entries_;
+		std::unordered_map<utility::string_t, EntryList::iterator> index_;
+		std::vector<uint8_t> sketch_;
+		size_t sketch_width_;
+		size_t additions_;
+		size_t sample_size_;
+		mutable std::mutex mutex_;
+	};
+}
+
+#endif // !_DOCUMENTDB_DOCUMENT_CACHE_H_
@@ -25,6 +25,7 @@
 #ifndef _DOCUMENTDB_DOCUMENT_CLIENT_H_
 #define _DOCUMENTDB_DOCUMENT_CLIENT_H_
 
+#include <functional>
 #include <string>
 #include <vector>
 #include <memory>
@@ -33,6 +34,7 @@
 
 #include "Database.h"
 #include "DocumentDBConfiguration.h"
+#include "NamedCollection.h"
 
 namespace documentdb {
 
@@ -41,8 +43,20 @@ namespace documentdb {
 	public:
 		DocumentClient(const DocumentDBConfiguration& document_db_configuration);
 
+		DocumentClient(
+			const utility::string_t& url_connection,
+			const utility::string_t& master_key,
+			const ConnectionPolicy& connection_policy);
+
 		virtual ~DocumentClient() {}
 
+		// Client reporting the diagnostics of the operations sent through it, and
+		// through the entities they return, to diagnostics_handler instead of the
+		// handler of the configuration. It shares the connection pool, limits and
+		// caches of this client.
+		DocumentClient WithDiagnosticsHandler(
+			const std::function<void(const ResponseDiagnostics&)>& diagnostics_handler) const;
+
 		pplx::task<std::shared_ptr<Database>> CreateDatabaseAsync(
 			const utility::string_t& id) const;
 
@@ -67,15 +81,32 @@ namespace documentdb {
 		std::shared_ptr<Database> GetDatabase(
 			const utility::string_t& resource_id) const;
 
+		// Reads the database by its id, in a single request.
+		pplx::task<std::shared_ptr<Database>> GetDatabaseByIdAsync(
+			const utility::string_t& id) const;
+
+		std::shared_ptr<Database> GetDatabaseById(
+			const utility::string_t& id) const;
+
 		pplx::task<std::vector<std::shared_ptr<Database>>> ListDatabasesAsync() const;
 
 		std::vector<std::shared_ptr<Database>> ListDatabases() const;
 
+		// Addresses a collection by the id of its database and its own id,
+		// without a request.
+		NamedCollection CollectionByName(
+			const utility::string_t& database_id,
+			const utility::string_t& collection_id) const;
+
 	private:
 		std::shared_ptr<DocumentDBConfiguration> document_db_configuration_;
 
 		std::shared_ptr<Database> DatabaseFromJson(
 			const web::json::value& json_database) const;
+
+		// Request behind the metadata cache.
+		pplx::task<std::shared_ptr<Database>> ReadDatabaseAsync(
+			const utility::string_t& resource_id) const;
 	};
 
 }
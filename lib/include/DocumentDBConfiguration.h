@@ -25,34 +25,97 @@
 #ifndef _DOCUMENTDB_DOCUMENT_DB_CONFIGURATION_H_
 #define _DOCUMENTDB_DOCUMENT_DB_CONFIGURATION_H_
 
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include <cpprest/http_client.h>
 
+#include "ConnectionPolicy.h"
+#include "MetadataCache.h"
+#include "RequestLimiter.h"
+#include "RequestSigner.h"
+#include "ResponseDiagnostics.h"
+#include "RetryBudget.h"
+
 class DocumentDBConfiguration
 {
 public:
 	DocumentDBConfiguration(
 		utility::string_t url_connection,
-		utility::string_t master_key);
+		utility::string_t master_key,
+		const documentdb::ConnectionPolicy& connection_policy = documentdb::ConnectionPolicy());
 
 	virtual ~DocumentDBConfiguration();
 
-	std::vector<unsigned char> master_key() const
+	const std::vector<unsigned char>& master_key() const
 	{
 		return master_key_;
 	}
 
-	web::http::client::http_client http_client() const
+	const documentdb::RequestSigner& request_signer() const
+	{
+		return *request_signer_;
+	}
+
+	const documentdb::ConnectionPolicy& connection_policy() const
+	{
+		return connection_policy_;
+	}
+
+	web::http::client::http_client& http_client() const
+	{
+		return *http_client_;
+	}
+
+	std::shared_ptr<documentdb::RequestLimiter> request_limiter() const
 	{
-		return http_client_;
+		return request_limiter_;
 	}
 
+	std::shared_ptr<documentdb::RetryBudget> retry_budget() const
+	{
+		return retry_budget_;
+	}
+
+	std::shared_ptr<documentdb::MetadataCache> metadata_cache() const
+	{
+		return metadata_cache_;
+	}
+
+	// Called with the diagnostics of every operation once its response has been
+	// parsed, on the thread completing the operation. Clients copy the
+	// configuration they are created with, so set it before creating the client.
+	const std::function<void(const documentdb::ResponseDiagnostics&)>& diagnostics_handler() const
+	{
+		return diagnostics_handler_;
+	}
+
+	void set_diagnostics_handler(const std::function<void(const documentdb::ResponseDiagnostics&)>& diagnostics_handler)
+	{
+		diagnostics_handler_ = diagnostics_handler;
+	}
+
+	// Copy of the configuration reporting to diagnostics_handler instead, see
+	// the WithDiagnosticsHandler views of the entities.
+	std::shared_ptr<DocumentDBConfiguration> WithDiagnosticsHandler(
+		const std::function<void(const documentdb::ResponseDiagnostics&)>& diagnostics_handler) const;
+
 private:
 	utility::string_t url_connection_;
 	std::vector<unsigned char> master_key_;
-	web::http::client::http_client http_client_;
+	// Shared between copies of the configuration, it is immutable once keyed.
+	std::shared_ptr<const documentdb::RequestSigner> request_signer_;
+	documentdb::ConnectionPolicy connection_policy_;
+	// Copies of the configuration share one client, hence one connection pool,
+	// and one limiter and retry budget so the limits hold across all of them,
+	// and one metadata cache.
+	std::shared_ptr<web::http::client::http_client> http_client_;
+	std::shared_ptr<documentdb::RequestLimiter> request_limiter_;
+	std::shared_ptr<documentdb::RetryBudget> retry_budget_;
+	std::shared_ptr<documentdb::MetadataCache> metadata_cache_;
+	std::function<void(const documentdb::ResponseDiagnostics&)> diagnostics_handler_;
 };
 
 #endif // !_DOCUMENTDB_DOCUMENT_DB_CONFIGURATION_H_
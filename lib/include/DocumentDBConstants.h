@@ -45,22 +45,58 @@
 #define RESOURCE_PATH_SPROCS (_XPLATSTR("sprocs"))
 #define RESOURCE_PATH_UDFS (_XPLATSTR("udfs"))
 #define RESOURCE_PATH_ATTACHMENTS (_XPLATSTR("attachments"))
+#define RESOURCE_PATH_PKRANGES (_XPLATSTR("pkranges"))
+
+// Stored procedure deployed by Collection::ImportDocumentsAsync, versioned by name
+#define BULK_IMPORT_STORED_PROCEDURE_ID (_XPLATSTR("__documentdbcpp_bulkImport_v1"))
 
 // MIME types
 #define MIME_TYPE_APPLICATION_JSON (_XPLATSTR("application/json"))
 #define MIME_TYPE_APPLICATION_SQL (_XPLATSTR("application/sql"))
+#define MIME_TYPE_APPLICATION_QUERY_JSON (_XPLATSTR("application/query+json"))
 
 // Headers
 #define HEADER_MS_CONTINUATION (_XPLATSTR("x-ms-continuation"))
 #define HEADER_MS_DATE (_XPLATSTR("x-ms-date"))
 #define HEADER_MS_VERSION (_XPLATSTR("x-ms-version"))
 #define HEADER_MS_DOCUMENTDB_IS_QUERY (_XPLATSTR("x-ms-documentdb-isquery"))
+#define HEADER_MS_DOCUMENTDB_IS_UPSERT (_XPLATSTR("x-ms-documentdb-is-upsert"))
+#define HEADER_MS_DOCUMENTDB_PARTITIONKEY (_XPLATSTR("x-ms-documentdb-partitionkey"))
+#define HEADER_MS_DOCUMENTDB_PARTITIONKEYRANGEID (_XPLATSTR("x-ms-documentdb-partitionkeyrangeid"))
+#define HEADER_MS_DOCUMENTDB_QUERY_ENABLECROSSPARTITION (_XPLATSTR("x-ms-documentdb-query-enablecrosspartition"))
+#define HEADER_MS_OFFER_THROUGHPUT (_XPLATSTR("x-ms-offer-throughput"))
 #define HEADER_MS_MAX_ITEM_COUNT (_XPLATSTR("x-ms-max-item-count"))
+#define HEADER_MS_RETRY_AFTER_MS (_XPLATSTR("x-ms-retry-after-ms"))
+#define HEADER_MS_REQUEST_CHARGE (_XPLATSTR("x-ms-request-charge"))
+#define HEADER_MS_ACTIVITY_ID (_XPLATSTR("x-ms-activity-id"))
+#define HEADER_MS_SESSION_TOKEN (_XPLATSTR("x-ms-session-token"))
+#define HEADER_MS_RESOURCE_USAGE (_XPLATSTR("x-ms-resource-usage"))
+#define HEADER_MS_SUBSTATUS (_XPLATSTR("x-ms-substatus"))
+#define HEADER_IF_NONE_MATCH (_XPLATSTR("If-None-Match"))
+#define HEADER_IF_MATCH (_XPLATSTR("If-Match"))
+
+// Status codes not defined by cpprest
+#define STATUS_CODE_TOO_MANY_REQUESTS 429
+#define STATUS_CODE_RETRY_WITH 449
+
+// Substatus of a 404 for a resource whose collection or database is gone
+#define SUBSTATUS_OWNER_RESOURCE_NOT_FOUND (_XPLATSTR("1003"))
 
 // Response body
 #define RESPONSE_DATABASES (_XPLATSTR("Databases"))
 #define RESPONSE_QUERY_DOCUMENTS (_XPLATSTR("Documents"))
 #define RESPONSE_INDEXING_POLICY (_XPLATSTR("indexingPolicy"))
+#define RESPONSE_PARTITION_KEY (_XPLATSTR("partitionKey"))
+#define RESPONSE_PARTITION_KEY_PATHS (_XPLATSTR("paths"))
+#define RESPONSE_PARTITION_KEY_KIND (_XPLATSTR("kind"))
+#define PARTITION_KEY_KIND_HASH (_XPLATSTR("Hash"))
+#define RESPONSE_PARTITION_KEY_RANGES (_XPLATSTR("PartitionKeyRanges"))
+#define RESPONSE_PARTITION_KEY_RANGE_MIN (_XPLATSTR("minInclusive"))
+#define RESPONSE_PARTITION_KEY_RANGE_MAX (_XPLATSTR("maxExclusive"))
+#define QUERY_SPEC_QUERY (_XPLATSTR("query"))
+#define QUERY_SPEC_PARAMETERS (_XPLATSTR("parameters"))
+#define QUERY_SPEC_NAME (_XPLATSTR("name"))
+#define QUERY_SPEC_VALUE (_XPLATSTR("value"))
 #define RESPONSE_DOCUMENT_COLLECTIONS (_XPLATSTR("DocumentCollections"))
 #define RESPONSE_INDEX_KIND (_XPLATSTR("kind"))
 #define RESPONSE_INDEX_DATA_TYPE (_XPLATSTR("dataType"))
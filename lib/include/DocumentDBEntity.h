@@ -28,6 +28,8 @@
 #include <memory>
 #include <string>
 
+#include <cpprest/json.h>
+
 #include "DocumentDBConfiguration.h"
 
 namespace documentdb
@@ -45,14 +47,14 @@ namespace documentdb
 
 		virtual ~DocumentDBEntity();
 
-		utility::string_t id() const
+		const utility::string_t& id() const
 		{
-			return id_;
+			return *id_;
 		}
 
-		utility::string_t resource_id() const
+		const utility::string_t& resource_id() const
 		{
-			return resource_id_;
+			return *resource_id_;
 		}
 
 		unsigned long ts() const
@@ -60,14 +62,14 @@ namespace documentdb
 			return ts_;
 		}
 
-		utility::string_t self() const
+		const utility::string_t& self() const
 		{
-			return self_;
+			return *self_;
 		}
 
-		utility::string_t etag() const
+		const utility::string_t& etag() const
 		{
-			return etag_;
+			return *etag_;
 		}
 
 		std::shared_ptr<const DocumentDBConfiguration> document_db_configuration() const
@@ -75,14 +77,28 @@ namespace documentdb
 			return document_db_configuration_;
 		}
 
+	protected:
+		// Borrows the metadata from the JSON of the resource, which the entity
+		// keeps alive, instead of copying it.
+		DocumentDBEntity(
+			const std::shared_ptr<const DocumentDBConfiguration>& document_db_configuration,
+			const std::shared_ptr<const web::json::value>& json_resource);
+
+		// Link suffixes such as "docs/" that the service returns are shared by
+		// every entity; any other link gets a copy of its own.
+		static std::shared_ptr<const utility::string_t> ShareLink(
+			const utility::string_t& link);
+
 	private:
 		std::shared_ptr<const DocumentDBConfiguration> document_db_configuration_;
 
-		utility::string_t id_;
-		utility::string_t resource_id_;
+		// Owns the strings below, either a block of them or the resource JSON
+		std::shared_ptr<const void> metadata_;
+		const utility::string_t* id_;
+		const utility::string_t* resource_id_;
 		unsigned long ts_;
-		utility::string_t self_;
-		utility::string_t etag_;
+		const utility::string_t* self_;
+		const utility::string_t* etag_;
 	};
 }
 
@@ -0,0 +1,92 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#ifndef _DOCUMENTDB_DOCUMENT_DB_RESPONSE_H_
+#define _DOCUMENTDB_DOCUMENT_DB_RESPONSE_H_
+
+#include <functional>
+#include <memory>
+
+#include <cpprest/http_client.h>
+#include <cpprest/json.h>
+
+#include "ResponseDiagnostics.h"
+
+namespace documentdb
+{
+	// Response of the service with its body already read and parsed. Cheap to
+	// copy, copies share the parsed body.
+	// Reads the body of a successful response instead of parsing it whole, the
+	// JSON it completes with is the one of the DocumentDBResponse.
+	typedef std::function<pplx::task<std::shared_ptr<const web::json::value>>(const web::http::http_response&)> ResponseBodyReader;
+
+	class DocumentDBResponse
+	{
+	public:
+		DocumentDBResponse(
+			const web::http::http_response& response,
+			const std::shared_ptr<const web::json::value>& json,
+			const ResponseDiagnostics& diagnostics);
+
+		virtual ~DocumentDBResponse();
+
+		web::http::status_code status_code() const
+		{
+			return response_.status_code();
+		}
+
+		const web::http::http_headers& headers() const
+		{
+			return response_.headers();
+		}
+
+		// Value of a response header, empty if the service did not send it.
+		utility::string_t header(
+			const utility::string_t& name) const;
+
+		// Null for responses without a body.
+		const web::json::value& json() const
+		{
+			return *json_;
+		}
+
+		// The parsed body, for results that keep it beyond the response.
+		const std::shared_ptr<const web::json::value>& shared_json() const
+		{
+			return json_;
+		}
+
+		const ResponseDiagnostics& diagnostics() const
+		{
+			return diagnostics_;
+		}
+
+	private:
+		web::http::http_response response_;
+		std::shared_ptr<const web::json::value> json_;
+		ResponseDiagnostics diagnostics_;
+	};
+}
+
+#endif // !_DOCUMENTDB_DOCUMENT_DB_RESPONSE_H_
@@ -0,0 +1,326 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#ifndef _DOCUMENTDB_DOCUMENT_MAPPING_H_
+#define _DOCUMENTDB_DOCUMENT_MAPPING_H_
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <cpprest/json.h>
+
+#include "JsonReader.h"
+#include "JsonWriter.h"
+
+namespace documentdb
+{
+	template<class T>
+	class DocumentFields;
+
+	// Maps a type to documents, for the typed document calls such as
+	// Collection::GetDocumentAsAsync. Specialize it with the fields of the type:
+	//
+	//     template<> struct DocumentMapping<Order>
+	//     {
+	//         static void Describe(DocumentFields<Order>& fields)
+	//         {
+	//             fields.Add(U("id"), &Order::id);
+	//             fields.Add(U("quantity"), &Order::quantity);
+	//         }
+	//     };
+	//
+	// Fields may be bool, int, long long, double, utility::string_t,
+	// web::json::value, std::vector of those or another mapped type. Fields of
+	// the document not described are skipped, fields of the type not in the
+	// document keep their value.
+	template<class T>
+	struct DocumentMapping;
+
+	// Reads and writes a field of type F, see the specializations below.
+	template<class F>
+	struct JsonField
+	{
+		static void Read(JsonReader& reader, F& field)
+		{
+			DocumentFields<F>::Instance().Read(reader, field);
+		}
+
+		static void Write(JsonWriter& writer, const F& field)
+		{
+			DocumentFields<F>::Instance().Write(writer, field);
+		}
+	};
+
+	template<>
+	struct JsonField<bool>
+	{
+		static void Read(JsonReader& reader, bool& field)
+		{
+			field = reader.ReadBool();
+		}
+
+		static void Write(JsonWriter& writer, bool field)
+		{
+			writer.WriteBool(field);
+		}
+	};
+
+	template<>
+	struct JsonField<int>
+	{
+		static void Read(JsonReader& reader, int& field)
+		{
+			field = static_cast<int>(reader.ReadInteger());
+		}
+
+		static void Write(JsonWriter& writer, int field)
+		{
+			writer.WriteInteger(field);
+		}
+	};
+
+	template<>
+	struct JsonField<long long>
+	{
+		static void Read(JsonReader& reader, long long& field)
+		{
+			field = reader.ReadInteger();
+		}
+
+		static void Write(JsonWriter& writer, long long field)
+		{
+			writer.WriteInteger(field);
+		}
+	};
+
+	template<>
+	struct JsonField<double>
+	{
+		static void Read(JsonReader& reader, double& field)
+		{
+			field = reader.ReadDouble();
+		}
+
+		static void Write(JsonWriter& writer, double field)
+		{
+			writer.WriteDouble(field);
+		}
+	};
+
+	template<>
+	struct JsonField<utility::string_t>
+	{
+		static void Read(JsonReader& reader, utility::string_t& field)
+		{
+#ifdef _UTF16_STRINGS
+			std::string utf8;
+			reader.ReadString(utf8);
+			field = utility::conversions::to_string_t(utf8);
+#else
+			reader.ReadString(field);
+#endif
+		}
+
+		static void Write(JsonWriter& writer, const utility::string_t& field)
+		{
+#ifdef _UTF16_STRINGS
+			writer.WriteString(utility::conversions::to_utf8string(field));
+#else
+			writer.WriteString(field);
+#endif
+		}
+	};
+
+	template<>
+	struct JsonField<web::json::value>
+	{
+		static void Read(JsonReader& reader, web::json::value& field)
+		{
+			field = reader.ReadValue();
+		}
+
+		static void Write(JsonWriter& writer, const web::json::value& field)
+		{
+			writer.WriteValue(field);
+		}
+	};
+
+	template<class E>
+	struct JsonField<std::vector<E>>
+	{
+		static void Read(JsonReader& reader, std::vector<E>& field)
+		{
+			field.clear();
+			reader.BeginArray();
+			while (reader.NextElement())
+			{
+				field.push_back(E());
+				JsonField<E>::Read(reader, field.back());
+			}
+		}
+
+		static void Write(JsonWriter& writer, const std::vector<E>& field)
+		{
+			writer.BeginArray();
+			for (typename std::vector<E>::const_iterator element = field.begin(); element != field.end(); ++element)
+			{
+				JsonField<E>::Write(writer, *element);
+			}
+			writer.EndArray();
+		}
+	};
+
+	// Fields of a mapped type, described once by its DocumentMapping.
+	template<class T>
+	class DocumentFields
+	{
+	public:
+		template<class F>
+		void Add(
+			const utility::string_t& name,
+			F T::* member)
+		{
+			Field field;
+			field.name = utility::conversions::to_utf8string(name);
+			field.read = [member](JsonReader& reader, T& target)
+			{
+				JsonField<F>::Read(reader, target.*member);
+			};
+			field.write = [member](JsonWriter& writer, const T& source)
+			{
+				JsonField<F>::Write(writer, source.*member);
+			};
+			fields_.push_back(field);
+		}
+
+		bool Has(
+			const utility::string_t& name) const
+		{
+			return Find(utility::conversions::to_utf8string(name)) != nullptr;
+		}
+
+		static const DocumentFields<T>& Instance()
+		{
+			static const DocumentFields<T> instance = Describe();
+			return instance;
+		}
+
+		// Reads an object, or null which leaves target as it is.
+		void Read(
+			JsonReader& reader,
+			T& target) const
+		{
+			if (reader.ReadNull())
+			{
+				return;
+			}
+
+			// Names are read into the same buffer, which stops allocating once it
+			// fits the longest one
+			std::string name;
+			reader.BeginObject();
+			while (reader.NextField(name))
+			{
+				const Field* field = Find(name);
+				if (field == nullptr)
+				{
+					reader.SkipValue();
+				}
+				else if (!reader.ReadNull())
+				{
+					field->read(reader, target);
+				}
+			}
+		}
+
+		void Write(
+			JsonWriter& writer,
+			const T& source) const
+		{
+			writer.BeginObject();
+			for (typename std::vector<Field>::const_iterator field = fields_.begin(); field != fields_.end(); ++field)
+			{
+				writer.Name(field->name);
+				field->write(writer, source);
+			}
+			writer.EndObject();
+		}
+
+	private:
+		struct Field
+		{
+			std::string name;
+			std::function<void(JsonReader&, T&)> read;
+			std::function<void(JsonWriter&, const T&)> write;
+		};
+
+		static DocumentFields<T> Describe()
+		{
+			DocumentFields<T> fields;
+			DocumentMapping<T>::Describe(fields);
+			return fields;
+		}
+
+		const Field* Find(
+			const std::string& name) const
+		{
+			for (typename std::vector<Field>::const_iterator field = fields_.begin(); field != fields_.end(); ++field)
+			{
+				if (field->name == name)
+				{
+					return &*field;
+				}
+			}
+			return nullptr;
+		}
+
+		std::vector<Field> fields_;
+	};
+
+	// Decodes a document of a mapped type from its UTF-8 JSON text.
+	template<class T>
+	T DecodeDocument(
+		const std::string& text)
+	{
+		T document = T();
+		JsonReader reader(text.data(), text.size());
+		DocumentFields<T>::Instance().Read(reader, document);
+		reader.End();
+		return document;
+	}
+
+	// Encodes a document of a mapped type to UTF-8 JSON text.
+	template<class T>
+	std::string EncodeDocument(
+		const T& document)
+	{
+		std::string text;
+		JsonWriter writer(text);
+		DocumentFields<T>::Instance().Write(writer, document);
+		return text;
+	}
+}
+
+#endif // !_DOCUMENTDB_DOCUMENT_MAPPING_H_
@@ -0,0 +1,114 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#ifndef _DOCUMENTDB_DOCUMENT_PAGE_H_
+#define _DOCUMENTDB_DOCUMENT_PAGE_H_
+
+#include <cstddef>
+#include <memory>
+
+#include <cpprest/json.h>
+
+#include "Document.h"
+#include "ResponseDiagnostics.h"
+
+namespace documentdb
+{
+	class Collection; // forward declaration
+
+	// Read-only view of the documents of one query result page, as returned by
+	// the service. Nothing is copied out of the page: fields are read straight
+	// from the JSON and a Document is only built when asked for. Copies of the
+	// view share the page, which stays alive as long as any of them.
+	class DocumentPage
+	{
+	public:
+		typedef web::json::array::const_iterator const_iterator;
+
+		// Empty page, past the last one of a query.
+		DocumentPage();
+
+		DocumentPage(
+			const std::shared_ptr<const Collection>& collection,
+			const std::shared_ptr<const web::json::value>& page,
+			const web::json::array* items,
+			size_t begin,
+			const ResponseDiagnostics& diagnostics);
+
+		virtual ~DocumentPage();
+
+		size_t size() const
+		{
+			return (size_t)(end_ - begin_);
+		}
+
+		bool empty() const
+		{
+			return begin_ == end_;
+		}
+
+		const_iterator begin() const
+		{
+			return begin_;
+		}
+
+		const_iterator end() const
+		{
+			return end_;
+		}
+
+		// JSON of the document at index, system properties such as _rid included.
+		const web::json::value& operator[](size_t index) const
+		{
+			return *(begin_ + index);
+		}
+
+		const web::json::value& at(size_t index) const;
+
+		const utility::string_t& id(size_t index) const;
+
+		const utility::string_t& resource_id(size_t index) const;
+
+		const utility::string_t& etag(size_t index) const;
+
+		// Builds the Document at index, its payload shares the page, see
+		// Document::Detach.
+		std::shared_ptr<Document> document(size_t index) const;
+
+		// Diagnostics of the response the page came with.
+		const ResponseDiagnostics& diagnostics() const
+		{
+			return diagnostics_;
+		}
+
+	private:
+		std::shared_ptr<const Collection> collection_;
+		std::shared_ptr<const web::json::value> page_;
+		const_iterator begin_;
+		const_iterator end_;
+		ResponseDiagnostics diagnostics_;
+	};
+}
+
+#endif // !_DOCUMENTDB_DOCUMENT_PAGE_H_
@@ -0,0 +1,94 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#ifndef _DOCUMENTDB_JSON_ARRAY_READER_H_
+#define _DOCUMENTDB_JSON_ARRAY_READER_H_
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <cpprest/json.h>
+
+namespace documentdb
+{
+	// Incremental reader of a UTF-8 JSON object, such as the body of a list or
+	// query response, that hands out the elements of one of its array fields as
+	// soon as each is complete. Only one element is held at a time; the rest of
+	// the object is kept and returned by Finish with the array left empty.
+	class JsonArrayReader
+	{
+	public:
+		typedef std::function<void(web::json::value&& item)> ItemHandler;
+
+		typedef std::function<void(const std::string& item)> ItemTextHandler;
+
+		JsonArrayReader(
+			const utility::string_t& array_field,
+			const ItemHandler& on_item);
+
+		virtual ~JsonArrayReader();
+
+		// Passes on the elements as their UTF-8 text instead of parsing them.
+		static std::shared_ptr<JsonArrayReader> TextReader(
+			const utility::string_t& array_field,
+			const ItemTextHandler& on_item_text);
+
+		// Reads the next bytes of the object, calling the handler for every element
+		// they complete.
+		void Read(
+			const char* data,
+			size_t size);
+
+		// The object without the elements of the array, once all of it was read.
+		web::json::value Finish();
+
+	private:
+		void BeginItem();
+
+		void EndItem();
+
+		std::string array_field_;
+		ItemHandler on_item_;
+		ItemTextHandler on_item_text_;
+
+		// Text of the object outside the array elements
+		std::string envelope_;
+		// Text of the element being read
+		std::string item_;
+
+		int depth_;
+		bool in_string_;
+		bool escaped_;
+		// Last string read directly in the object, the key of the value after it
+		std::string key_;
+		bool reading_key_;
+		bool in_array_;
+		bool in_item_;
+		int item_depth_;
+	};
+}
+
+#endif // !_DOCUMENTDB_JSON_ARRAY_READER_H_
@@ -0,0 +1,106 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#ifndef _DOCUMENTDB_JSON_READER_H_
+#define _DOCUMENTDB_JSON_READER_H_
+
+#include <cstddef>
+#include <string>
+
+#include <cpprest/json.h>
+
+namespace documentdb
+{
+	// Pull reader over UTF-8 JSON text, for decoding it straight into other
+	// types without building a web::json::value. Values are read in document
+	// order; whatever is not wanted is skipped without allocating. Throws
+	// DocumentDBRuntimeException on malformed text or a value of another type.
+	class JsonReader
+	{
+	public:
+		JsonReader(
+			const char* data,
+			size_t size);
+
+		virtual ~JsonReader();
+
+		// Reads null if it is the next value.
+		bool ReadNull();
+
+		void BeginObject();
+
+		// Reads the name of the next field of the object into name, or the end of
+		// the object.
+		bool NextField(
+			std::string& name);
+
+		void BeginArray();
+
+		// Whether the array has another element, reading its end otherwise.
+		bool NextElement();
+
+		bool ReadBool();
+
+		long long ReadInteger();
+
+		double ReadDouble();
+
+		// Reads a string, unescaped, as UTF-8.
+		void ReadString(
+			std::string& value);
+
+		web::json::value ReadValue();
+
+		void SkipValue();
+
+		// Checks that nothing but whitespace is left.
+		void End();
+
+	private:
+		void SkipWhitespace();
+
+		char Peek();
+
+		void Expect(
+			char c);
+
+		// Skips the number at the current position, returning its length
+		size_t SkipNumber();
+
+		void SkipString();
+
+		void SkipLiteral(
+			const char* literal);
+
+		__declspec(noreturn)
+		void Fail(
+			const char* what) const;
+
+		const char* data_;
+		const char* end_;
+		const char* current_;
+	};
+}
+
+#endif // !_DOCUMENTDB_JSON_READER_H_
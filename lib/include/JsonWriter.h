@@ -0,0 +1,83 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#ifndef _DOCUMENTDB_JSON_WRITER_H_
+#define _DOCUMENTDB_JSON_WRITER_H_
+
+#include <string>
+
+#include <cpprest/json.h>
+
+namespace documentdb
+{
+	// Appends UTF-8 JSON text to a string, for encoding other types without
+	// building a web::json::value. Commas are placed by the writer; field names
+	// and values are otherwise written in the order they are given.
+	class JsonWriter
+	{
+	public:
+		explicit JsonWriter(
+			std::string& output);
+
+		virtual ~JsonWriter();
+
+		void BeginObject();
+
+		void EndObject();
+
+		// Name of the next field, the value follows.
+		void Name(
+			const std::string& name);
+
+		void BeginArray();
+
+		void EndArray();
+
+		void WriteNull();
+
+		void WriteBool(
+			bool value);
+
+		void WriteInteger(
+			long long value);
+
+		void WriteDouble(
+			double value);
+
+		// value is UTF-8.
+		void WriteString(
+			const std::string& value);
+
+		void WriteValue(
+			const web::json::value& value);
+
+	private:
+		void BeginValue();
+
+		std::string& output_;
+		bool needs_comma_;
+	};
+}
+
+#endif // !_DOCUMENTDB_JSON_WRITER_H_
@@ -0,0 +1,167 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#ifndef _DOCUMENTDB_METADATA_CACHE_H_
+#define _DOCUMENTDB_METADATA_CACHE_H_
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <cpprest/asyncrt_utils.h>
+#include <pplx/pplxtasks.h>
+
+namespace documentdb
+{
+	// Databases, collections, stored procedures, triggers and user defined
+	// functions shared by all copies of a client, see
+	// ConnectionPolicy::metadata_cache_ttl. Resources are cached under the link
+	// they were read from, and under their self link when read by id.
+	//
+	// A resource older than the ttl is still returned while it is read again
+	// in the background. Resources are dropped when a request on them, or on
+	// what they contain, replaces or deletes them, and when one returns 410, or
+	// 404 for their own link. A resource whose link is invalidated while it is
+	// first read is returned to the lookups waiting for it, but not cached.
+	class MetadataCache : public std::enable_shared_from_this<MetadataCache>
+	{
+	public:
+		// A ttl of 0 disables the cache, every lookup is then a request.
+		explicit MetadataCache(
+			const std::chrono::milliseconds& ttl);
+
+		virtual ~MetadataCache();
+
+		// Resource cached under link, read with load if it is not. Concurrent
+		// lookups of a resource not cached yet share one load. self_link_of,
+		// if set, gives the link to cache the resource under as well.
+		template<class T>
+		pplx::task<std::shared_ptr<T>> GetAsync(
+			const utility::string_t& link,
+			const std::function<pplx::task<std::shared_ptr<T>>()>& load,
+			const std::function<utility::string_t(const T&)>& self_link_of = std::function<utility::string_t(const T&)>())
+		{
+			Loader erased_load = [load]()
+			{
+				return load().then([](std::shared_ptr<T> resource)
+				{
+					return std::shared_ptr<void>(resource);
+				});
+			};
+
+			SelfLinkOf erased_self_link_of;
+			if (self_link_of)
+			{
+				erased_self_link_of = [self_link_of](const std::shared_ptr<void>& resource)
+				{
+					return self_link_of(*std::static_pointer_cast<T>(resource));
+				};
+			}
+
+			return GetAsync(link, erased_load, erased_self_link_of).then([](std::shared_ptr<void> resource)
+			{
+				return std::static_pointer_cast<T>(resource);
+			});
+		}
+
+		// Drops the resources under link and under the links it contains, and
+		// with_ancestors those it is contained in. Without with_ancestors, links
+		// of documents and attachments return at once, without taking the lock.
+		void Invalidate(
+			const utility::string_t& link,
+			bool with_ancestors = false);
+
+		void Clear();
+
+		std::chrono::milliseconds ttl() const
+		{
+			return ttl_;
+		}
+
+		// Number of resources cached.
+		size_t count() const;
+
+	private:
+		MetadataCache(const MetadataCache&);
+		MetadataCache& operator=(const MetadataCache&);
+
+		typedef std::chrono::steady_clock clock;
+		typedef std::function<pplx::task<std::shared_ptr<void>>()> Loader;
+		typedef std::function<utility::string_t(const std::shared_ptr<void>&)> SelfLinkOf;
+
+		// First load of a link. Invalidating the link while it is in flight
+		// keeps its result out of the cache.
+		struct Loading
+		{
+			pplx::task<std::shared_ptr<void>> task;
+			bool invalidated;
+		};
+
+		struct Entry
+		{
+			std::shared_ptr<void> resource;
+			clock::time_point loaded;
+			bool refreshing;
+			// Link the resource was read from first, then its self link if any
+			std::vector<utility::string_t> links;
+			Loader load;
+			SelfLinkOf self_link_of;
+		};
+
+		pplx::task<std::shared_ptr<void>> GetAsync(
+			const utility::string_t& link,
+			const Loader& load,
+			const SelfLinkOf& self_link_of);
+
+		void Refresh(
+			const std::shared_ptr<Entry>& entry);
+
+		// Caches the resource of entry under its links, replacing what they
+		// pointed to. Called with the lock held.
+		void Insert(
+			const std::shared_ptr<Entry>& entry);
+
+		void Erase(
+			const std::shared_ptr<Entry>& entry);
+
+		void EraseLoading(
+			const utility::string_t& key,
+			const std::shared_ptr<Loading>& loading);
+
+		// Links without their leading and trailing slashes.
+		static utility::string_t Normalize(
+			const utility::string_t& link);
+
+		const std::chrono::milliseconds ttl_;
+		std::unordered_map<utility::string_t, std::shared_ptr<Entry>> entries_;
+		// First loads in flight
+		std::unordered_map<utility::string_t, std::shared_ptr<Loading>> loading_;
+		mutable std::mutex mutex_;
+	};
+}
+
+#endif // !_DOCUMENTDB_METADATA_CACHE_H_
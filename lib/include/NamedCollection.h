@@ -0,0 +1,126 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#ifndef _DOCUMENTDB_NAMED_COLLECTION_H_
+#define _DOCUMENTDB_NAMED_COLLECTION_H_
+
+#include <functional>
+#include <memory>
+
+#include <cpprest/json.h>
+
+#include "Document.h"
+#include "DocumentDBConfiguration.h"
+#include "PartitionKey.h"
+
+namespace documentdb
+{
+	// Collection addressed by the ids of its database and itself, see
+	// DocumentClient::CollectionByName. Documents are addressed by their id
+	// through "dbs/{id}/colls/{id}/docs/{id}" links, so a point read is a single
+	// request, without getting the Database and Collection first. Nothing is
+	// checked until the first request, so on a partitioned collection the
+	// partition key of the document is always passed in.
+	class NamedCollection
+	{
+	public:
+		NamedCollection(
+			const std::shared_ptr<const DocumentDBConfiguration>& document_db_configuration,
+			const utility::string_t& database_id,
+			const utility::string_t& collection_id);
+
+		virtual ~NamedCollection();
+
+		// The same collection, reporting diagnostics to diagnostics_handler, see
+		// Collection::WithDiagnosticsHandler.
+		NamedCollection WithDiagnosticsHandler(
+			const std::function<void(const ResponseDiagnostics&)>& diagnostics_handler) const;
+
+		pplx::task<std::shared_ptr<Document>> GetDocumentAsync(
+			const utility::string_t& id,
+			const PartitionKey& partition_key = PartitionKey()) const;
+
+		std::shared_ptr<Document> GetDocument(
+			const utility::string_t& id,
+			const PartitionKey& partition_key = PartitionKey()) const;
+
+		pplx::task<std::shared_ptr<Document>> CreateDocumentAsync(
+			const web::json::value& document,
+			const PartitionKey& partition_key = PartitionKey()) const;
+
+		std::shared_ptr<Document> CreateDocument(
+			const web::json::value& document,
+			const PartitionKey& partition_key = PartitionKey()) const;
+
+		pplx::task<std::shared_ptr<Document>> ReplaceDocumentAsync(
+			const utility::string_t& id,
+			const web::json::value& document,
+			const PartitionKey& partition_key = PartitionKey()) const;
+
+		std::shared_ptr<Document> ReplaceDocument(
+			const utility::string_t& id,
+			const web::json::value& document,
+			const PartitionKey& partition_key = PartitionKey()) const;
+
+		pplx::task<void> DeleteDocumentAsync(
+			const utility::string_t& id,
+			const PartitionKey& partition_key = PartitionKey()) const;
+
+		void DeleteDocument(
+			const utility::string_t& id,
+			const PartitionKey& partition_key = PartitionKey()) const;
+
+		const utility::string_t& database_id() const
+		{
+			return database_id_;
+		}
+
+		const utility::string_t& collection_id() const
+		{
+			return collection_id_;
+		}
+
+		// "dbs/{id}/colls/{id}", as signed.
+		const utility::string_t& link() const
+		{
+			return link_;
+		}
+
+	private:
+		// Link of a document, and its uri with the ids escaped.
+		utility::string_t DocumentLink(
+			const utility::string_t& id) const;
+
+		utility::string_t DocumentUri(
+			const utility::string_t& id) const;
+
+		std::shared_ptr<const DocumentDBConfiguration> document_db_configuration_;
+		utility::string_t database_id_;
+		utility::string_t collection_id_;
+		utility::string_t link_;
+		utility::string_t uri_;
+	};
+}
+
+#endif // !_DOCUMENTDB_NAMED_COLLECTION_H_
@@ -0,0 +1,98 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#ifndef _DOCUMENTDB_PARALLEL_QUERY_H_
+#define _DOCUMENTDB_PARALLEL_QUERY_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <cpprest/json.h>
+#include <pplx/pplxtasks.h>
+
+#include "ParallelQueryOptions.h"
+#include "PartitionKeyRange.h"
+#include "SqlQuerySpec.h"
+
+namespace documentdb
+{
+	class Collection;
+
+	// One query run against every partition key range of a collection, up to
+	// max_degree_of_parallelism ranges at a time. Each range is paged through
+	// on its own, so the query takes about as long as its slowest range. The
+	// results of the ranges are merged as set by the options once all are in.
+	// Once a range fails the others stop paging, as the query fails as a whole.
+	//
+	// Backs Collection::QueryDocumentsParallelAsync.
+	class ParallelQuery : public std::enable_shared_from_this<ParallelQuery>
+	{
+	public:
+		// Throws DocumentDBRuntimeException for queries calling AVG, whose
+		// results of the ranges cannot be combined.
+		ParallelQuery(
+			const std::shared_ptr<const Collection>& collection,
+			const SqlQuerySpec& query,
+			const ParallelQueryOptions& options,
+			const std::vector<PartitionKeyRange>& ranges);
+
+		virtual ~ParallelQuery();
+
+		// To be called once, with the query owned by a shared_ptr.
+		pplx::task<std::vector<web::json::value>> RunAsync();
+
+		// Merges the results of the ranges, in range order, as set by the options.
+		static std::vector<web::json::value> Merge(
+			std::vector<std::vector<web::json::value>>&& range_results,
+			const ParallelQueryOptions& options);
+
+	private:
+		ParallelQuery(const ParallelQuery&);
+		ParallelQuery& operator=(const ParallelQuery&);
+
+		// Queries the ranges not taken by another worker, one after the other.
+		pplx::task<void> RunWorkerAsync();
+
+		pplx::task<void> QueryRangeAsync(
+			size_t range,
+			const utility::string_t& continuation);
+
+		std::shared_ptr<const Collection> collection_;
+		SqlQuerySpec query_;
+		ParallelQueryOptions options_;
+		std::vector<PartitionKeyRange> ranges_;
+
+		std::mutex mutex_;
+		size_t next_range_;
+		// Set once a range fails, checked by the workers between pages
+		std::atomic<bool> failed_;
+		// Written by the worker of each range only
+		std::vector<std::vector<web::json::value>> range_results_;
+	};
+}
+
+#endif // !_DOCUMENTDB_PARALLEL_QUERY_H_
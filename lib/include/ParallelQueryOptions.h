@@ -0,0 +1,125 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#ifndef _DOCUMENTDB_PARALLEL_QUERY_OPTIONS_H_
+#define _DOCUMENTDB_PARALLEL_QUERY_OPTIONS_H_
+
+#include <cstddef>
+#include <string>
+
+#include <cpprest/json.h>
+
+#include "QueryAggregate.h"
+
+namespace documentdb
+{
+	// Settings of Collection::QueryDocumentsParallelAsync.
+	//
+	// The query runs as is against every partition key range, so the options tell
+	// how to combine the results of the ranges and must match the query:
+	// order_by for an ORDER BY, top for a TOP and aggregate for a SELECT VALUE
+	// COUNT, SUM, MIN or MAX. Results are concatenated in range order otherwise.
+	// Queries calling AVG are rejected; query SUM and COUNT and divide instead.
+	class ParallelQueryOptions
+	{
+	public:
+		ParallelQueryOptions();
+
+		virtual ~ParallelQueryOptions();
+
+		// Ranges queried at the same time, 0 for all of them.
+		size_t max_degree_of_parallelism() const
+		{
+			return max_degree_of_parallelism_;
+		}
+
+		void set_max_degree_of_parallelism(size_t max_degree_of_parallelism)
+		{
+			max_degree_of_parallelism_ = max_degree_of_parallelism;
+		}
+
+		int page_size() const
+		{
+			return page_size_;
+		}
+
+		void set_page_size(int page_size)
+		{
+			page_size_ = page_size;
+		}
+
+		// Path of the ORDER BY property in the results, e.g. /price for
+		// SELECT * FROM c ORDER BY c.price. Results of the ranges, each already
+		// sorted by the service, are merged on it.
+		const utility::string_t& order_by() const
+		{
+			return order_by_;
+		}
+
+		bool descending() const
+		{
+			return descending_;
+		}
+
+		void set_order_by(
+			const utility::string_t& order_by,
+			bool descending = false)
+		{
+			order_by_ = order_by;
+			descending_ = descending;
+		}
+
+		// Results kept after the merge, 0 for all. Ranges stop paging once they
+		// have this many.
+		size_t top() const
+		{
+			return top_;
+		}
+
+		void set_top(size_t top)
+		{
+			top_ = top;
+		}
+
+		QueryAggregate aggregate() const
+		{
+			return aggregate_;
+		}
+
+		void set_aggregate(QueryAggregate aggregate)
+		{
+			aggregate_ = aggregate;
+		}
+
+	private:
+		size_t max_degree_of_parallelism_;
+		int page_size_;
+		utility::string_t order_by_;
+		bool descending_;
+		size_t top_;
+		QueryAggregate aggregate_;
+	};
+}
+
+#endif // !_DOCUMENTDB_PARALLEL_QUERY_OPTIONS_H_
@@ -0,0 +1,66 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#ifndef _DOCUMENTDB_PARTITION_KEY_H_
+#define _DOCUMENTDB_PARTITION_KEY_H_
+
+#include <string>
+
+#include <cpprest/json.h>
+
+namespace documentdb
+{
+	// Partition key value of a document, sent with the requests on it so that
+	// they are routed to its partition. The default one is no partition key, for
+	// collections that are not partitioned.
+	class PartitionKey
+	{
+	public:
+		PartitionKey();
+
+		// A string, number, boolean or null.
+		PartitionKey(const web::json::value& value);
+
+		virtual ~PartitionKey();
+
+		// Partition key of the documents that lack the partition key property.
+		static PartitionKey Undefined();
+
+		bool empty() const
+		{
+			return header_.empty();
+		}
+
+		// Value of the x-ms-documentdb-partitionkey header, a JSON array.
+		const utility::string_t& header() const
+		{
+			return header_;
+		}
+
+	private:
+		utility::string_t header_;
+	};
+}
+
+#endif // !_DOCUMENTDB_PARTITION_KEY_H_
@@ -0,0 +1,81 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#ifndef _DOCUMENTDB_PARTITION_KEY_DEFINITION_H_
+#define _DOCUMENTDB_PARTITION_KEY_DEFINITION_H_
+
+#include <string>
+#include <vector>
+
+#include <cpprest/json.h>
+
+#include "PartitionKey.h"
+
+namespace documentdb
+{
+	// Partition key of a partitioned collection, the path of the document
+	// property whose value decides the partition of each document, e.g.
+	// /tenant or /address/city. Empty for a collection that is not partitioned.
+	class PartitionKeyDefinition
+	{
+	public:
+		PartitionKeyDefinition();
+
+		explicit PartitionKeyDefinition(
+			const utility::string_t& path);
+
+		virtual ~PartitionKeyDefinition();
+
+		static PartitionKeyDefinition FromJson(const web::json::value& json_payload);
+
+		web::json::value ToJson() const;
+
+		bool empty() const
+		{
+			return path_.empty();
+		}
+
+		const utility::string_t& path() const
+		{
+			return path_;
+		}
+
+		const utility::string_t& kind() const
+		{
+			return kind_;
+		}
+
+		// Partition key of the document, PartitionKey::Undefined() if it lacks
+		// the property and no partition key if the definition is empty.
+		PartitionKey Extract(const web::json::value& document) const;
+
+	private:
+		utility::string_t path_;
+		utility::string_t kind_;
+		// Property names along the path, unquoted
+		std::vector<utility::string_t> segments_;
+	};
+}
+
+#endif // !_DOCUMENTDB_PARTITION_KEY_DEFINITION_H_
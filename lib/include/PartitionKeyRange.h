@@ -0,0 +1,70 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#ifndef _DOCUMENTDB_PARTITION_KEY_RANGE_H_
+#define _DOCUMENTDB_PARTITION_KEY_RANGE_H_
+
+#include <string>
+
+#include <cpprest/json.h>
+
+namespace documentdb
+{
+	// Range of hashed partition key values served by one partition of a
+	// collection, see Collection::GetPartitionKeyRangesAsync.
+	class PartitionKeyRange
+	{
+	public:
+		PartitionKeyRange(
+			const utility::string_t& id,
+			const utility::string_t& min_inclusive,
+			const utility::string_t& max_exclusive);
+
+		virtual ~PartitionKeyRange();
+
+		static PartitionKeyRange FromJson(const web::json::value& json_payload);
+
+		const utility::string_t& id() const
+		{
+			return id_;
+		}
+
+		const utility::string_t& min_inclusive() const
+		{
+			return min_inclusive_;
+		}
+
+		const utility::string_t& max_exclusive() const
+		{
+			return max_exclusive_;
+		}
+
+	private:
+		utility::string_t id_;
+		utility::string_t min_inclusive_;
+		utility::string_t max_exclusive_;
+	};
+}
+
+#endif // !_DOCUMENTDB_PARTITION_KEY_RANGE_H_
@@ -51,17 +51,17 @@ namespace documentdb {
 
 		virtual ~Permission();
 
-		utility::string_t permission_mode() const
+		const utility::string_t& permission_mode() const
 		{
 			return permission_mode_;
 		}
 
-		utility::string_t resource() const
+		const utility::string_t& resource() const
 		{
 			return resource_;
 		}
 
-		utility::string_t token() const
+		const utility::string_t& token() const
 		{
 			return token_;
 		}
@@ -0,0 +1,71 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#ifndef _DOCUMENTDB_PREPARED_QUERY_H_
+#define _DOCUMENTDB_PREPARED_QUERY_H_
+
+#include <string>
+#include <vector>
+
+#include <cpprest/json.h>
+
+#include "SqlQuerySpec.h"
+
+namespace documentdb
+{
+	// Query text and parameter names serialized once, for a query run many
+	// times with different values. Bind only encodes the values into the
+	// request body kept from the previous runs.
+	class PreparedQuery
+	{
+	public:
+		PreparedQuery(
+			const utility::string_t& query,
+			const std::vector<utility::string_t>& parameter_names);
+
+		virtual ~PreparedQuery();
+
+		// values are those of the parameters, in the order of their names.
+		SqlQuerySpec Bind(
+			const std::vector<web::json::value>& values) const;
+
+		const utility::string_t& query() const
+		{
+			return query_;
+		}
+
+		const std::vector<utility::string_t>& parameter_names() const
+		{
+			return parameter_names_;
+		}
+
+	private:
+		utility::string_t query_;
+		std::vector<utility::string_t> parameter_names_;
+		// Body text before each value, the last one ends the body
+		std::vector<utility::string_t> segments_;
+	};
+}
+
+#endif // !_DOCUMENTDB_PREPARED_QUERY_H_
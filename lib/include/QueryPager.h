@@ -0,0 +1,114 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#ifndef _DOCUMENTDB_QUERY_PAGER_H_
+#define _DOCUMENTDB_QUERY_PAGER_H_
+
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include <cpprest/json.h>
+#include <pplx/pplxtasks.h>
+
+#include "DocumentDBResponse.h"
+#include "ResponseDiagnostics.h"
+
+namespace documentdb
+{
+	// Pages of a query result, fetched ahead of the consumer. While a page is
+	// being consumed the following ones are requested, one after the other since
+	// each needs the continuation of the previous one, until prefetch_pages pages
+	// or prefetch_max_bytes of response bodies are buffered. With no prefetch a
+	// page is only requested when asked for.
+	//
+	// Backs the resource iterators, which are not thread safe either: only one
+	// page may be asked for at a time.
+	class QueryPager : public std::enable_shared_from_this<QueryPager>
+	{
+	public:
+		// Sends the query for the page after the continuation.
+		typedef std::function<pplx::task<DocumentDBResponse>(const utility::string_t& continuation)> PageFetcher;
+
+		struct Page
+		{
+			Page()
+				: items(nullptr)
+			{
+			}
+
+			// Keeps the parsed response alive for items
+			std::shared_ptr<const web::json::value> json;
+			// Null for the end of the results
+			const web::json::array* items;
+			ResponseDiagnostics diagnostics;
+		};
+
+		// items_field is the field of the response holding the results, continuation
+		// the one returned with the first page, already consumed elsewhere.
+		QueryPager(
+			const PageFetcher& fetch_page,
+			const utility::string_t& items_field,
+			const utility::string_t& continuation,
+			size_t prefetch_pages,
+			size_t prefetch_max_bytes);
+
+		virtual ~QueryPager();
+
+		// Starts fetching ahead, to be called once the pager is owned by a shared_ptr.
+		void Prefetch();
+
+		// Completes with the next page, or the end of the results. Pages may be empty.
+		pplx::task<Page> NextPageAsync();
+
+	private:
+		QueryPager(const QueryPager&);
+		QueryPager& operator=(const QueryPager&);
+
+		// Starts the next fetch if there is room for it, called with the lock held.
+		void FetchIfRoom();
+
+		void OnFetched(
+			const pplx::task<DocumentDBResponse>& response_task);
+
+		PageFetcher fetch_page_;
+		utility::string_t items_field_;
+		utility::string_t continuation_;
+		size_t prefetch_pages_;
+		size_t prefetch_max_bytes_;
+
+		std::mutex mutex_;
+		bool fetching_;
+		bool done_;
+		std::deque<Page> pages_;
+		size_t buffered_bytes_;
+		std::exception_ptr error_;
+		std::shared_ptr<pplx::task_completion_event<Page>> waiter_;
+	};
+}
+
+#endif // !_DOCUMENTDB_QUERY_PAGER_H_
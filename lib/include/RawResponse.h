@@ -0,0 +1,91 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#ifndef _DOCUMENTDB_RAW_RESPONSE_H_
+#define _DOCUMENTDB_RAW_RESPONSE_H_
+
+#include <memory>
+#include <vector>
+
+#include <cpprest/http_client.h>
+
+#include "DocumentDBResponse.h"
+#include "ResponseDiagnostics.h"
+
+namespace documentdb
+{
+	// Successful response of a raw call, with its body as the service sent it.
+	// Cheap to copy, copies share the body.
+	class RawResponse
+	{
+	public:
+		RawResponse(
+			const DocumentDBResponse& response,
+			const std::shared_ptr<const std::vector<unsigned char>>& body);
+
+		virtual ~RawResponse();
+
+		web::http::status_code status_code() const
+		{
+			return response_.status_code();
+		}
+
+		const web::http::http_headers& headers() const
+		{
+			return response_.headers();
+		}
+
+		// Value of a response header, empty if the service did not send it.
+		utility::string_t header(
+			const utility::string_t& name) const
+		{
+			return response_.header(name);
+		}
+
+		// Continuation of a query page, empty for the last page.
+		utility::string_t continuation() const;
+
+		// UTF-8 JSON body, unparsed.
+		const std::vector<unsigned char>& body() const
+		{
+			return *body_;
+		}
+
+		const std::shared_ptr<const std::vector<unsigned char>>& shared_body() const
+		{
+			return body_;
+		}
+
+		const ResponseDiagnostics& diagnostics() const
+		{
+			return response_.diagnostics();
+		}
+
+	private:
+		DocumentDBResponse response_;
+		std::shared_ptr<const std::vector<unsigned char>> body_;
+	};
+}
+
+#endif // !_DOCUMENTDB_RAW_RESPONSE_H_
@@ -0,0 +1,68 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#ifndef _DOCUMENTDB_REQUEST_LIMITER_H_
+#define _DOCUMENTDB_REQUEST_LIMITER_H_
+
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+#include <pplx/pplxtasks.h>
+
+namespace documentdb
+{
+	// Asynchronous counting semaphore bounding the number of requests in flight.
+	// Waiters are resumed in FIFO order and never block a thread.
+	class RequestLimiter
+	{
+	public:
+		// limit of 0 means unlimited
+		explicit RequestLimiter(
+			size_t limit);
+
+		virtual ~RequestLimiter();
+
+		// Completes once the caller holds a slot. Every acquire must be paired with Release.
+		pplx::task<void> AcquireAsync();
+
+		void Release();
+
+		size_t limit() const
+		{
+			return limit_;
+		}
+
+	private:
+		RequestLimiter(const RequestLimiter&);
+		RequestLimiter& operator=(const RequestLimiter&);
+
+		const size_t limit_;
+		size_t in_flight_;
+		std::deque<pplx::task_completion_event<void>> waiters_;
+		std::mutex mutex_;
+	};
+}
+
+#endif // !_DOCUMENTDB_REQUEST_LIMITER_H_
@@ -0,0 +1,90 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#ifndef _DOCUMENTDB_REQUEST_SIGNER_H_
+#define _DOCUMENTDB_REQUEST_SIGNER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <cpprest/asyncrt_utils.h>
+
+namespace documentdb
+{
+	class HmacSha256; // forward declaration
+	class SignatureCache; // forward declaration
+
+	// Computes master key signatures for the Authorization header. The key is
+	// processed once, when the signer is created, and signing reuses hash
+	// contexts allocated once per thread.
+	class RequestSigner
+	{
+	public:
+		// Length of the base64 encoded signature, in characters.
+		static const size_t SIGNATURE_LENGTH = 44;
+
+		explicit RequestSigner(
+			const std::vector<unsigned char>& master_key);
+
+		virtual ~RequestSigner();
+
+		// Signs "verb\nresource_type\nresource_link\ndate\n\n" (lower cased) and
+		// writes exactly SIGNATURE_LENGTH characters into signature. There is no
+		// limit on the length of any of the parts. Name based links, such as
+		// "dbs/{id}/colls/{id}", are case sensitive and signed as they are.
+		void Sign(
+			const utility::string_t& verb,
+			const utility::string_t& resource_type,
+			const utility::string_t& resource_link,
+			const utility::string_t& date,
+			utility::char_t* signature,
+			bool name_based_link = false) const;
+
+		// Url encoded Authorization header value ("type=master&ver=1.0&sig=...") for the
+		// request. Requests with the same verb, resource and date are signed once per
+		// second; repeated ones are served from a lock-free cache.
+		utility::string_t Authorization(
+			const utility::string_t& verb,
+			const utility::string_t& resource_type,
+			const utility::string_t& resource_link,
+			const utility::string_t& date,
+			bool name_based_link = false) const;
+
+		// Raw HMAC-SHA256 of message, writes 32 bytes into digest.
+		void Sign(
+			const unsigned char* message,
+			size_t message_size,
+			unsigned char* digest) const;
+
+	private:
+		RequestSigner(const RequestSigner&);
+		RequestSigner& operator=(const RequestSigner&);
+
+		std::unique_ptr<HmacSha256> hmac_;
+		std::unique_ptr<SignatureCache> signature_cache_;
+	};
+}
+
+#endif // !_DOCUMENTDB_REQUEST_SIGNER_H_
@@ -0,0 +1,223 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#ifndef _DOCUMENTDB_RESPONSE_DIAGNOSTICS_H_
+#define _DOCUMENTDB_RESPONSE_DIAGNOSTICS_H_
+
+#include <chrono>
+
+#include <cpprest/http_client.h>
+
+namespace documentdb
+{
+	// Cost and latency breakdown of one operation against the service, retries
+	// included. Phases are those of the attempt that produced the response.
+	class ResponseDiagnostics
+	{
+	public:
+		ResponseDiagnostics();
+
+		virtual ~ResponseDiagnostics();
+
+		web::http::method method() const
+		{
+			return method_;
+		}
+
+		void set_method(const web::http::method& method)
+		{
+			method_ = method;
+		}
+
+		// Path of the resource the request was sent to.
+		utility::string_t resource_link() const
+		{
+			return resource_link_;
+		}
+
+		void set_resource_link(const utility::string_t& resource_link)
+		{
+			resource_link_ = resource_link;
+		}
+
+		web::http::status_code status_code() const
+		{
+			return status_code_;
+		}
+
+		void set_status_code(const web::http::status_code& status_code)
+		{
+			status_code_ = status_code;
+		}
+
+		// Request units consumed by the last attempt, x-ms-request-charge.
+		double request_charge() const
+		{
+			return request_charge_;
+		}
+
+		void set_request_charge(double request_charge)
+		{
+			request_charge_ = request_charge;
+		}
+
+		// x-ms-activity-id, identifies the request when talking to support.
+		utility::string_t activity_id() const
+		{
+			return activity_id_;
+		}
+
+		void set_activity_id(const utility::string_t& activity_id)
+		{
+			activity_id_ = activity_id;
+		}
+
+		utility::string_t session_token() const
+		{
+			return session_token_;
+		}
+
+		void set_session_token(const utility::string_t& session_token)
+		{
+			session_token_ = session_token;
+		}
+
+		// x-ms-resource-usage, as sent by the service, e.g. "documentsSize=0;documentsCount=1".
+		utility::string_t resource_usage() const
+		{
+			return resource_usage_;
+		}
+
+		void set_resource_usage(const utility::string_t& resource_usage)
+		{
+			resource_usage_ = resource_usage;
+		}
+
+		// Length of the response body in bytes, 0 if the service did not send it.
+		utility::size64_t response_size() const
+		{
+			return response_size_;
+		}
+
+		void set_response_size(utility::size64_t response_size)
+		{
+			response_size_ = response_size;
+		}
+
+		int retry_count() const
+		{
+			return retry_count_;
+		}
+
+		void set_retry_count(int retry_count)
+		{
+			retry_count_ = retry_count;
+		}
+
+		// Retries caused by throttling (429), part of retry_count.
+		int throttled_retry_count() const
+		{
+			return throttled_retry_count_;
+		}
+
+		void set_throttled_retry_count(int throttled_retry_count)
+		{
+			throttled_retry_count_ = throttled_retry_count;
+		}
+
+		// Building and signing the request.
+		std::chrono::microseconds signing_time() const
+		{
+			return signing_time_;
+		}
+
+		void set_signing_time(const std::chrono::microseconds& signing_time)
+		{
+			signing_time_ = signing_time;
+		}
+
+		// From sending the request, waiting for a connection included, until the
+		// response headers arrived.
+		std::chrono::microseconds time_to_first_byte() const
+		{
+			return time_to_first_byte_;
+		}
+
+		void set_time_to_first_byte(const std::chrono::microseconds& time_to_first_byte)
+		{
+			time_to_first_byte_ = time_to_first_byte;
+		}
+
+		// Reading the response body.
+		std::chrono::microseconds receive_time() const
+		{
+			return receive_time_;
+		}
+
+		void set_receive_time(const std::chrono::microseconds& receive_time)
+		{
+			receive_time_ = receive_time;
+		}
+
+		std::chrono::microseconds parse_time() const
+		{
+			return parse_time_;
+		}
+
+		void set_parse_time(const std::chrono::microseconds& parse_time)
+		{
+			parse_time_ = parse_time;
+		}
+
+		// Whole operation, all attempts and backoff included.
+		std::chrono::microseconds total_time() const
+		{
+			return total_time_;
+		}
+
+		void set_total_time(const std::chrono::microseconds& total_time)
+		{
+			total_time_ = total_time;
+		}
+
+	private:
+		web::http::method method_;
+		utility::string_t resource_link_;
+		web::http::status_code status_code_;
+		double request_charge_;
+		utility::string_t activity_id_;
+		utility::string_t session_token_;
+		utility::string_t resource_usage_;
+		utility::size64_t response_size_;
+		int retry_count_;
+		int throttled_retry_count_;
+		std::chrono::microseconds signing_time_;
+		std::chrono::microseconds time_to_first_byte_;
+		std::chrono::microseconds receive_time_;
+		std::chrono::microseconds parse_time_;
+		std::chrono::microseconds total_time_;
+	};
+}
+
+#endif // !_DOCUMENTDB_RESPONSE_DIAGNOSTICS_H_
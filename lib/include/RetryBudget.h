@@ -0,0 +1,62 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#ifndef _DOCUMENTDB_RETRY_BUDGET_H_
+#define _DOCUMENTDB_RETRY_BUDGET_H_
+
+#include <mutex>
+
+namespace documentdb
+{
+	// Token bucket shared by all requests of a client, see RetryOptions.
+	class RetryBudget
+	{
+	public:
+		// max_tokens of 0 disables the budget, every retry is then allowed
+		RetryBudget(
+			double max_tokens,
+			double refill_ratio);
+
+		virtual ~RetryBudget();
+
+		// Takes a token for one retry, false if retries are currently throttled.
+		bool TryAcquire();
+
+		// Called once per request that completed without needing a retry.
+		void OnSuccess();
+
+		double tokens() const;
+
+	private:
+		RetryBudget(const RetryBudget&);
+		RetryBudget& operator=(const RetryBudget&);
+
+		const double max_tokens_;
+		const double refill_ratio_;
+		double tokens_;
+		mutable std::mutex mutex_;
+	};
+}
+
+#endif // !_DOCUMENTDB_RETRY_BUDGET_H_
@@ -0,0 +1,137 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#ifndef _DOCUMENTDB_RETRY_OPTIONS_H_
+#define _DOCUMENTDB_RETRY_OPTIONS_H_
+
+#include <chrono>
+
+namespace documentdb
+{
+	// Retry behaviour of every request sent by the client.
+	//
+	// Throttled requests (429) are retried after the delay the service asks for in
+	// x-ms-retry-after-ms. Requests failing with 449 (retry with) or 503 (service
+	// unavailable) are retried with jittered exponential backoff, as are reads,
+	// replaces, deletes, queries and upserts failing with a transport error;
+	// creates and stored procedure executions surface it, since the service may
+	// have carried them out already. All retries draw from a budget shared by the whole client: each retry
+	// costs one token and each request that completes without one refills
+	// retry_budget_refill_ratio tokens. Retries stop while the budget is below half
+	// of retry_budget_tokens, so a struggling service sees at most a bounded ratio
+	// of extra load instead of a retry storm.
+	class RetryOptions
+	{
+	public:
+		RetryOptions();
+
+		virtual ~RetryOptions();
+
+		int max_retry_attempts_on_throttled_requests() const
+		{
+			return max_retry_attempts_on_throttled_requests_;
+		}
+
+		void set_max_retry_attempts_on_throttled_requests(int max_retry_attempts_on_throttled_requests)
+		{
+			max_retry_attempts_on_throttled_requests_ = max_retry_attempts_on_throttled_requests;
+		}
+
+		// Upper bound of the total time a single request spends waiting on 429s.
+		std::chrono::milliseconds max_retry_wait_time() const
+		{
+			return max_retry_wait_time_;
+		}
+
+		void set_max_retry_wait_time(const std::chrono::milliseconds& max_retry_wait_time)
+		{
+			max_retry_wait_time_ = max_retry_wait_time;
+		}
+
+		int max_retry_attempts_on_transient_errors() const
+		{
+			return max_retry_attempts_on_transient_errors_;
+		}
+
+		void set_max_retry_attempts_on_transient_errors(int max_retry_attempts_on_transient_errors)
+		{
+			max_retry_attempts_on_transient_errors_ = max_retry_attempts_on_transient_errors;
+		}
+
+		// Backoff before the first retry of a transient error, doubled for every
+		// following one up to max_backoff. The actual delay is drawn uniformly from
+		// [0, backoff] so that clients failing together do not retry together.
+		std::chrono::milliseconds initial_backoff() const
+		{
+			return initial_backoff_;
+		}
+
+		void set_initial_backoff(const std::chrono::milliseconds& initial_backoff)
+		{
+			initial_backoff_ = initial_backoff;
+		}
+
+		std::chrono::milliseconds max_backoff() const
+		{
+			return max_backoff_;
+		}
+
+		void set_max_backoff(const std::chrono::milliseconds& max_backoff)
+		{
+			max_backoff_ = max_backoff;
+		}
+
+		// Capacity of the client-wide retry budget, 0 disables the budget.
+		double retry_budget_tokens() const
+		{
+			return retry_budget_tokens_;
+		}
+
+		void set_retry_budget_tokens(double retry_budget_tokens)
+		{
+			retry_budget_tokens_ = retry_budget_tokens;
+		}
+
+		double retry_budget_refill_ratio() const
+		{
+			return retry_budget_refill_ratio_;
+		}
+
+		void set_retry_budget_refill_ratio(double retry_budget_refill_ratio)
+		{
+			retry_budget_refill_ratio_ = retry_budget_refill_ratio;
+		}
+
+	private:
+		int max_retry_attempts_on_throttled_requests_;
+		std::chrono::milliseconds max_retry_wait_time_;
+		int max_retry_attempts_on_transient_errors_;
+		std::chrono::milliseconds initial_backoff_;
+		std::chrono::milliseconds max_backoff_;
+		double retry_budget_tokens_;
+		double retry_budget_refill_ratio_;
+	};
+}
+
+#endif // !_DOCUMENTDB_RETRY_OPTIONS_H_
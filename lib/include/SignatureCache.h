@@ -0,0 +1,95 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#ifndef _DOCUMENTDB_SIGNATURE_CACHE_H_
+#define _DOCUMENTDB_SIGNATURE_CACHE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include <cpprest/asyncrt_utils.h>
+
+namespace documentdb
+{
+	// Memoizes Authorization header values of identical requests signed within the
+	// same second. The date header has one second resolution, so the verb, resource
+	// type, resource link and date fully determine the signature.
+	//
+	// Slots are independent seqlocks; readers never block and writers that lose a
+	// race on a slot simply do not cache. Keys are identified by two independent
+	// 64-bit hashes.
+	class SignatureCache
+	{
+	public:
+		// Longest value that can be cached, in characters. The encoded Authorization
+		// header value of a master key signature is at most 166 characters long.
+		static const size_t MAX_VALUE_LENGTH = 176;
+
+		SignatureCache();
+
+		virtual ~SignatureCache();
+
+		struct Key
+		{
+			uint64_t primary;
+			uint64_t secondary;
+		};
+
+		static Key MakeKey(
+			const utility::string_t& verb,
+			const utility::string_t& resource_type,
+			const utility::string_t& resource_link,
+			const utility::string_t& date,
+			bool name_based_link);
+
+		bool TryGet(
+			const Key& key,
+			utility::string_t& value) const;
+
+		void Put(
+			const Key& key,
+			const utility::string_t& value);
+
+	private:
+		SignatureCache(const SignatureCache&);
+		SignatureCache& operator=(const SignatureCache&);
+
+		static const size_t SLOT_COUNT = 256;
+		static const size_t VALUE_WORDS = MAX_VALUE_LENGTH / sizeof(uint64_t);
+
+		struct Slot
+		{
+			std::atomic<uint32_t> sequence;
+			std::atomic<uint64_t> primary;
+			std::atomic<uint64_t> secondary;
+			std::atomic<uint32_t> length;
+			std::atomic<uint64_t> value[VALUE_WORDS];
+		};
+
+		Slot slots_[SLOT_COUNT];
+	};
+}
+
+#endif // !_DOCUMENTDB_SIGNATURE_CACHE_H_
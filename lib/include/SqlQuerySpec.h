@@ -0,0 +1,91 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#ifndef _DOCUMENTDB_SQL_QUERY_SPEC_H_
+#define _DOCUMENTDB_SQL_QUERY_SPEC_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <cpprest/json.h>
+
+namespace documentdb
+{
+	// Name, such as @tenant, and value of a query parameter.
+	typedef std::pair<utility::string_t, web::json::value> SqlParameter;
+
+	// Query text with the values of its parameters, taken by the Query calls.
+	// Values are sent apart from the text, as application/query+json, so they
+	// need no escaping and the service can reuse the plan of the text. Plain
+	// query text converts implicitly and is sent as application/sql as before.
+	// The request body is serialized once, on construction.
+	class SqlQuerySpec
+	{
+		friend class PreparedQuery;
+
+	public:
+		SqlQuerySpec(
+			const utility::string_t& query);
+
+		SqlQuerySpec(
+			const utility::char_t* query);
+
+		SqlQuerySpec(
+			const utility::string_t& query,
+			const std::vector<SqlParameter>& parameters);
+
+		virtual ~SqlQuerySpec();
+
+		const utility::string_t& query() const
+		{
+			return query_;
+		}
+
+		const std::vector<SqlParameter>& parameters() const
+		{
+			return parameters_;
+		}
+
+		const utility::string_t& body() const
+		{
+			return body_;
+		}
+
+		const utility::string_t& content_type() const;
+
+	private:
+		SqlQuerySpec(
+			const utility::string_t& query,
+			const std::vector<SqlParameter>& parameters,
+			utility::string_t&& body);
+
+		utility::string_t query_;
+		std::vector<SqlParameter> parameters_;
+		utility::string_t body_;
+		bool is_json_;
+	};
+}
+
+#endif // !_DOCUMENTDB_SQL_QUERY_SPEC_H_
@@ -49,7 +49,7 @@ namespace documentdb {
 
 		virtual ~StoredProcedure();
 
-		utility::string_t body() const
+		const utility::string_t& body() const
 		{
 			return body_;
 		}
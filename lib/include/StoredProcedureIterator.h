@@ -26,40 +26,64 @@
 #define _DOCUMENTDB_STORED_PROCEDURE_ITERATOR_H_
 
 #include <memory>
+#include <vector>
 
 #include <cpprest/json.h>
 
 #include "DocumentDBConfiguration.h"
+#include "QueryPager.h"
+#include "ResponseDiagnostics.h"
+#include "SqlQuerySpec.h"
 #include "StoredProcedure.h"
 
 namespace documentdb
 {
 	class Collection; // forward declaration
 
-	class StoredProcedureIterator
+	class StoredProcedureIterator : public std::enable_shared_from_this<StoredProcedureIterator>
 	{
 	public:
 		StoredProcedureIterator(
 			const std::shared_ptr<const Collection>& collection,
-			const utility::string_t& original_query,
+			const SqlQuerySpec& original_query,
 			const int page_size,
 			const utility::string_t& original_request_uri,
 			const utility::string_t& continuation_id,
-			const web::json::value& buffer);
+			const std::shared_ptr<const web::json::value>& response_json,
+			const ResponseDiagnostics& diagnostics);
 		virtual ~StoredProcedureIterator();
 
+		// Completes with whether Next has a result, fetching the next page
+		// without blocking once the current one is consumed.
+		pplx::task<bool> HasMoreAsync();
+
 		bool HasMore();
 
 		std::shared_ptr<StoredProcedure> Next();
 
+		// Completes with the next result, or nullptr past the last one.
+		pplx::task<std::shared_ptr<StoredProcedure>> NextAsync();
+
+		// Completes with the results left in the current page, or those of the
+		// next page with any, empty past the last one.
+		pplx::task<std::vector<std::shared_ptr<StoredProcedure>>> NextPageAsync();
+
+		std::vector<std::shared_ptr<StoredProcedure>> NextPage();
+
+		// Diagnostics of the last page fetched from the service.
+		const ResponseDiagnostics& diagnostics() const
+		{
+			return diagnostics_;
+		}
+
 	private:
 		std::shared_ptr<const Collection> collection_;
-		utility::string_t original_query_;
-		int page_size_;
-		utility::string_t original_request_uri_;
-		utility::string_t continuation_id_;
-		web::json::value buffer_;
+		std::shared_ptr<QueryPager> pager_;
+		// Keeps the page items_ points into alive
+		std::shared_ptr<const web::json::value> page_;
+		const web::json::array* items_;
 		unsigned int current_;
+		ResponseDiagnostics diagnostics_;
 	};
 }
 
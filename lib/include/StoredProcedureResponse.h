@@ -0,0 +1,64 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#ifndef _DOCUMENTDB_STORED_PROCEDURE_RESPONSE_H_
+#define _DOCUMENTDB_STORED_PROCEDURE_RESPONSE_H_
+
+#include <memory>
+
+#include <cpprest/json.h>
+
+#include "ResponseDiagnostics.h"
+
+namespace documentdb
+{
+	// Outcome of a stored procedure execution. Cheap to copy, copies share the body.
+	class StoredProcedureResponse
+	{
+	public:
+		StoredProcedureResponse(
+			const std::shared_ptr<const web::json::value>& body,
+			const ResponseDiagnostics& diagnostics);
+
+		virtual ~StoredProcedureResponse();
+
+		// What the procedure passed to getContext().getResponse().setBody(), null
+		// if it did not set a body.
+		const web::json::value& body() const
+		{
+			return *body_;
+		}
+
+		const ResponseDiagnostics& diagnostics() const
+		{
+			return diagnostics_;
+		}
+
+	private:
+		std::shared_ptr<const web::json::value> body_;
+		ResponseDiagnostics diagnostics_;
+	};
+}
+
+#endif // !_DOCUMENTDB_STORED_PROCEDURE_RESPONSE_H_
@@ -53,7 +53,7 @@ namespace documentdb {
 
 		virtual ~Trigger();
 
-		utility::string_t body() const
+		const utility::string_t& body() const
 		{
 			return body_;
 		}
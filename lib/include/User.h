@@ -25,6 +25,7 @@
 #ifndef _DOCUMENTDB_USER_H_
 #define _DOCUMENTDB_USER_H_
 
+#include <functional>
 #include <string>
 #include <memory>
 
@@ -50,6 +51,11 @@ namespace documentdb {
 
 		virtual ~User();
 
+		// The same user, reporting diagnostics to diagnostics_handler, see
+		// Collection::WithDiagnosticsHandler.
+		std::shared_ptr<User> WithDiagnosticsHandler(
+			const std::function<void(const ResponseDiagnostics&)>& diagnostics_handler) const;
+
 		pplx::task<std::shared_ptr<Permission>> CreatePermissionAsync(
 			const utility::string_t& id,
 			const utility::string_t& permissionMode,
@@ -94,14 +100,14 @@ namespace documentdb {
 			const utility::string_t& new_permissionMode,
 			const utility::string_t& new_resource) const;
 
-		utility::string_t permissions() const
+		const utility::string_t& permissions() const
 		{
-			return permissions_;
+			return *permissions_;
 		}
 	private:
 		std::shared_ptr<Permission> PermissionFromJson(const web::json::value* json_permission) const;
 
-		utility::string_t permissions_;
+		std::shared_ptr<const utility::string_t> permissions_;
 	};
 }
 
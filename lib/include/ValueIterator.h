@@ -0,0 +1,86 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#ifndef _DOCUMENTDB_VALUE_ITERATOR_H_
+#define _DOCUMENTDB_VALUE_ITERATOR_H_
+
+#include <memory>
+#include <vector>
+
+#include <cpprest/json.h>
+
+#include "QueryPager.h"
+#include "ResponseDiagnostics.h"
+#include "SqlQuerySpec.h"
+
+namespace documentdb
+{
+	class Collection; // forward declaration
+
+	// Iterates the results of a query as JSON values, so projections such as
+	// SELECT c.name or SELECT VALUE COUNT(1) do not need to be documents.
+	class ValueIterator : public std::enable_shared_from_this<ValueIterator>
+	{
+	public:
+		ValueIterator(
+			const std::shared_ptr<const Collection>& collection,
+			const SqlQuerySpec& original_query,
+			const int page_size,
+			const utility::string_t& original_request_uri,
+			const utility::string_t& continuation_id,
+			const std::shared_ptr<const web::json::value>& response_json,
+			const ResponseDiagnostics& diagnostics);
+		virtual ~ValueIterator();
+
+		// Completes with whether Next has a result, fetching the next page
+		// without blocking once the current one is consumed.
+		pplx::task<bool> HasMoreAsync();
+
+		bool HasMore();
+
+		web::json::value Next();
+
+		// Completes with the results left in the current page, or those of the
+		// next page with any, empty past the last one.
+		pplx::task<std::vector<web::json::value>> NextPageAsync();
+
+		std::vector<web::json::value> NextPage();
+
+		// Diagnostics of the last page fetched from the service.
+		const ResponseDiagnostics& diagnostics() const
+		{
+			return diagnostics_;
+		}
+
+	private:
+		std::shared_ptr<QueryPager> pager_;
+		// Keeps the page items_ points into alive
+		std::shared_ptr<const web::json::value> page_;
+		const web::json::array* items_;
+		unsigned int current_;
+		ResponseDiagnostics diagnostics_;
+	};
+}
+
+#endif // !_DOCUMENTDB_VALUE_ITERATOR_H_
@@ -60,6 +60,16 @@ namespace documentdb
 		{
 		}
 
+		web::http::status_code status_code() const
+		{
+			return status_code_;
+		}
+
+		utility::string_t code() const
+		{
+			return code_;
+		}
+
 	private:
 		web::http::status_code status_code_;
 		utility::string_t code_;
@@ -100,5 +110,32 @@ namespace documentdb
 		{
 		}
 	};
+
+	// Thrown when a conditional request finds the resource changed since its etag
+	// was read.
+	class PreconditionFailedException : public DocumentDBResponseException
+	{
+	public:
+		PreconditionFailedException(
+			const web::http::status_code& status_code,
+			const utility::string_t& code,
+			const utility::string_t& message)
+			: DocumentDBResponseException(status_code, code, message)
+		{
+		}
+	};
+
+	// Thrown once a throttled request ran out of retries, see RetryOptions.
+	class RequestRateTooLargeException : public DocumentDBResponseException
+	{
+	public:
+		RequestRateTooLargeException(
+			const web::http::status_code& status_code,
+			const utility::string_t& code,
+			const utility::string_t& message)
+			: DocumentDBResponseException(status_code, code, message)
+		{
+		}
+	};
 }
 #endif // !_DOCUMENTDB_EXCEPTIONS_H_
@@ -25,12 +25,88 @@
 #ifndef _DOCUMENTDB_HMAC_CRYPT_H_
 #define _DOCUMENTDB_HMAC_CRYPT_H_
 
+#include <cstddef>
 
-unsigned char* hmac(
-	const unsigned char* key,
-	int keySize,
-	const unsigned char* message,
-	int messageSize,
-	int* cbHash);
+#ifdef _WIN32
+#include <windows.h>
+#include <bcrypt.h>
+#else
+#include <openssl/evp.h>
+#endif
+
+namespace documentdb
+{
+	// HMAC-SHA256 with the key schedule done once, up front. Every message then
+	// costs a copy of the pre-keyed hash state plus the hashing itself.
+	class HmacSha256
+	{
+	public:
+		static const size_t DIGEST_LENGTH = 32;
+
+		HmacSha256(
+			const unsigned char* key,
+			size_t key_size);
+
+		~HmacSha256();
+
+		// Incremental hashing of a single message. Lives on the caller's stack;
+		// outside Windows it hashes into a state allocated once per thread.
+		class Context
+		{
+		public:
+			explicit Context(
+				const HmacSha256& hmac);
+
+			~Context();
+
+			void Update(
+				const unsigned char* data,
+				size_t size);
+
+			// Writes DIGEST_LENGTH bytes into digest. Context can not be updated afterwards.
+			void Final(
+				unsigned char* digest);
+
+		private:
+			friend class HmacSha256;
+
+			Context(const Context&);
+			Context& operator=(const Context&);
+
+#ifndef _WIN32
+			void Release();
+#endif
+
+			const HmacSha256& hmac_;
+#ifdef _WIN32
+			static const size_t OBJECT_LENGTH = 1024;
+
+			BCRYPT_HASH_HANDLE hash_;
+			UCHAR object_[OBJECT_LENGTH];
+#else
+			EVP_MD_CTX* inner_;
+			// Set when the thread's state was taken by another Context
+			bool owns_inner_;
+#endif
+		};
+
+	private:
+		HmacSha256(const HmacSha256&);
+		HmacSha256& operator=(const HmacSha256&);
+
+#ifdef _WIN32
+		void Release();
+
+		BCRYPT_ALG_HANDLE algorithm_;
+		BCRYPT_HASH_HANDLE keyed_hash_;
+		PUCHAR keyed_object_;
+		DWORD object_length_;
+#else
+		// SHA256(K XOR ipad) and SHA256(K XOR opad), each after its first block.
+		EVP_MD_CTX* inner_;
+		EVP_MD_CTX* outer_;
+#endif
+	};
+}
 
 #endif // !_DOCUMENTDB_HMAC_CRYPT_H_
@@ -0,0 +1,300 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#include "BulkPipeline.h"
+
+#include <algorithm>
+
+#include "exceptions.h"
+
+using namespace documentdb;
+using namespace std;
+using namespace web::json;
+
+BulkPipeline::BulkPipeline(
+	const BulkOptions& options,
+	const Producer& producer,
+	const Operation& operation,
+	const Completion& completion,
+	const ResultHandler& result_handler)
+	: options_(options)
+	, producer_(producer)
+	, operation_(operation)
+	, completion_(completion)
+	, result_handler_(result_handler)
+	, in_flight_(0)
+	, next_index_(0)
+	, next_to_report_(0)
+	, decrease_mark_(0)
+	, exhausted_(false)
+	, draining_(false)
+{
+	options_.set_max_concurrency(max<size_t>(options_.max_concurrency(), 1));
+	options_.set_min_concurrency(min(max<size_t>(options_.min_concurrency(), 1), options_.max_concurrency()));
+	concurrency_ = (double)min(max(options_.initial_concurrency(), options_.min_concurrency()), options_.max_concurrency());
+}
+
+BulkPipeline::~BulkPipeline()
+{
+}
+
+pplx::task<void> BulkPipeline::RunAsync()
+{
+	Drain();
+	return pplx::task<void>(done_);
+}
+
+void BulkPipeline::Drain()
+{
+	{
+		lock_guard<mutex> lock(mutex_);
+		if (draining_)
+		{
+			// The thread draining picks up what was queued
+			return;
+		}
+		draining_ = true;
+	}
+
+	for (;;)
+	{
+		vector<BulkItemResult> results;
+		size_t room;
+		{
+			lock_guard<mutex> lock(mutex_);
+			results.swap(ready_);
+			room = Room();
+			if (results.empty() && room == 0)
+			{
+				draining_ = false;
+				CompleteIfDrained();
+				return;
+			}
+		}
+
+		for (const BulkItemResult& result : results)
+		{
+			try
+			{
+				result_handler_(result);
+			}
+			catch (...)
+			{
+				// Items in flight still complete, but nothing new is pulled and
+				// no other result is delivered
+				lock_guard<mutex> lock(mutex_);
+				error_ = current_exception();
+				exhausted_ = true;
+				room = 0;
+				break;
+			}
+		}
+
+		vector<Item> items = Pull(room);
+		{
+			lock_guard<mutex> lock(mutex_);
+			for (Item& item : items)
+			{
+				item.index = next_index_++;
+			}
+			in_flight_ += items.size();
+		}
+
+		Start(items);
+	}
+}
+
+vector<BulkPipeline::Item> BulkPipeline::Pull(
+	size_t count)
+{
+	vector<Item> items;
+	while (items.size() < count)
+	{
+		Item item;
+		try
+		{
+			if (!producer_(item.value))
+			{
+				lock_guard<mutex> lock(mutex_);
+				exhausted_ = true;
+				break;
+			}
+		}
+		catch (...)
+		{
+			lock_guard<mutex> lock(mutex_);
+			error_ = current_exception();
+			exhausted_ = true;
+			break;
+		}
+
+		items.push_back(move(item));
+	}
+
+	return items;
+}
+
+size_t BulkPipeline::Room() const
+{
+	if (exhausted_)
+	{
+		return 0;
+	}
+
+	size_t waiting = in_flight_ + held_.size() + ready_.size();
+	size_t concurrency = (size_t)concurrency_;
+	if (in_flight_ >= concurrency || waiting >= options_.max_concurrency())
+	{
+		return 0;
+	}
+
+	return min(concurrency - in_flight_, options_.max_concurrency() - waiting);
+}
+
+void BulkPipeline::Start(
+	vector<Item>& items)
+{
+	shared_ptr<BulkPipeline> self = shared_from_this();
+	for (Item& item : items)
+	{
+		size_t index = item.index;
+		pplx::task<DocumentDBResponse> response_task;
+		try
+		{
+			response_task = operation_(item.value);
+		}
+		catch (...)
+		{
+			response_task = pplx::task_from_exception<DocumentDBResponse>(current_exception());
+		}
+
+		response_task.then([self, index](pplx::task<DocumentDBResponse> completed_task)
+		{
+			self->OnCompleted(index, completed_task);
+		});
+	}
+}
+
+void BulkPipeline::OnCompleted(
+	size_t index,
+	const pplx::task<DocumentDBResponse>& response_task)
+{
+	BulkItemResult result;
+	try
+	{
+		DocumentDBResponse response = response_task.get();
+		result = BulkItemResult(index, completion_(response), response.diagnostics());
+	}
+	catch (...)
+	{
+		result = BulkItemResult(index, current_exception());
+	}
+
+	{
+		lock_guard<mutex> lock(mutex_);
+		in_flight_--;
+		Adapt(index, result);
+		Report(result);
+	}
+
+	Drain();
+}
+
+void BulkPipeline::Report(
+	const BulkItemResult& result)
+{
+	if (error_)
+	{
+		// The result handler failed, results are no longer delivered
+		return;
+	}
+
+	if (!options_.ordered())
+	{
+		ready_.push_back(result);
+		return;
+	}
+
+	held_.insert(make_pair(result.index(), result));
+	map<size_t, BulkItemResult>::iterator next;
+	while ((next = held_.find(next_to_report_)) != held_.end())
+	{
+		ready_.push_back(next->second);
+		held_.erase(next);
+		next_to_report_++;
+	}
+}
+
+void BulkPipeline::Adapt(
+	size_t index,
+	const BulkItemResult& result)
+{
+	bool throttled = result.succeeded() && result.diagnostics().throttled_retry_count() > 0;
+	if (!result.succeeded())
+	{
+		try
+		{
+			result.ThrowIfFailed();
+		}
+		catch (const RequestRateTooLargeException&)
+		{
+			throttled = true;
+		}
+		catch (...)
+		{
+		}
+	}
+
+	if (throttled)
+	{
+		// Items started before the last decrease ran at the old concurrency, their
+		// throttling has been accounted for already
+		if (index >= decrease_mark_)
+		{
+			concurrency_ = max(concurrency_ / 2, (double)options_.min_concurrency());
+			decrease_mark_ = next_index_;
+		}
+	}
+	else if (result.succeeded())
+	{
+		concurrency_ = min(concurrency_ + 1 / concurrency_, (double)options_.max_concurrency());
+	}
+}
+
+void BulkPipeline::CompleteIfDrained()
+{
+	if (!exhausted_ || in_flight_ != 0 || !ready_.empty())
+	{
+		return;
+	}
+
+	if (error_)
+	{
+		done_.set_exception(error_);
+	}
+	else
+	{
+		done_.set();
+	}
+}
@@ -32,12 +32,18 @@
 #include <uuid/uuid.h>
 #endif
 
+#include <algorithm>
+#include <map>
+#include <mutex>
+
 #include <cpprest/http_client.h>
 #include <cpprest/filestream.h>
 #include <cpprest/json.h>
 
+#include "BulkPipeline.h"
 #include "ConnectionHelper.h"
 #include "DocumentDBConstants.h"
+#include "ParallelQuery.h"
 #include "exceptions.h"
 
 using namespace documentdb;
@@ -47,6 +53,73 @@ using namespace web::http;
 using namespace web::json;
 using namespace web::http::client;
 
+namespace
+{
+	// Passes on the whole body as UTF-8 text instead of parsing it.
+	ResponseBodyReader ReadBodyText(
+		const function<void(const std::string&)>& on_body)
+	{
+		return [on_body](const http_response& response)
+		{
+			return response.extract_utf8string(true).then([on_body](const std::string& body)
+			{
+				on_body(body);
+				return make_shared<const value>();
+			});
+		};
+	}
+
+	// Sends the request and completes with its body unparsed, throwing unless
+	// the response has the expected status.
+	pplx::task<RawResponse> ExecuteRawRequestAsync(
+		const DocumentDBConfiguration& document_db_configuration,
+		const function<http_request()>& create_request,
+		status_code expected_status)
+	{
+		shared_ptr<vector<unsigned char>> body = make_shared<vector<unsigned char>>();
+		return ExecuteRequestAsync(document_db_configuration, create_request, [body](const http_response& response)
+		{
+			return response.extract_vector().then([body](vector<unsigned char> bytes)
+			{
+				body->swap(bytes);
+				return make_shared<const value>();
+			});
+		}).then([body, expected_status](const DocumentDBResponse& response)
+		{
+			if (response.status_code() != expected_status)
+			{
+				ThrowExceptionFromResponse(response.status_code(), response.json());
+			}
+
+			return RawResponse(response, body);
+		});
+	}
+
+	// Bytes a document cache accounts for the document of a response.
+	size_t CachedSize(
+		const DocumentDBResponse& response)
+	{
+		size_t size = static_cast<size_t>(response.diagnostics().response_size());
+		return size != 0 ? size : response.json().serialize().size() * sizeof(utility::char_t);
+	}
+
+	// Sends the document from where it is, without copying it into the request.
+	void SetRawBody(
+		http_request& request,
+		const shared_ptr<const vector<unsigned char>>& document)
+	{
+		concurrency::streams::rawptr_buffer<uint8_t> buffer(document->data(), document->size());
+		request.set_body(buffer.create_istream(), document->size(), MIME_TYPE_APPLICATION_JSON);
+	}
+}
+
+struct Collection::PartitionKeyRangeCache
+{
+	mutex ranges_mutex;
+	// Shared by concurrent callers while being read
+	shared_ptr<pplx::task<vector<PartitionKeyRange>>> ranges;
+};
+
 Collection::Collection(
 		const shared_ptr<const DocumentDBConfiguration>& document_db_configuration,
 		const string_t& id,
@@ -59,19 +132,43 @@ Collection::Collection(
 		const string_t& triggers,
 		const string_t& udfs,
 		const string_t& conflicts,
-		const IndexingPolicy& indexing_policy)
+		const IndexingPolicy& indexing_policy,
+		const PartitionKeyDefinition& partition_key)
 	: DocumentDBEntity(document_db_configuration, id, resource_id, ts, self, etag)
-	, docs_(docs)
-	, sprocs_(sprocs)
-	, triggers_(triggers)
-	, udfs_(udfs)
-	, conflicts_(conflicts)
+	, docs_(ShareLink(docs))
+	, sprocs_(ShareLink(sprocs))
+	, triggers_(ShareLink(triggers))
+	, udfs_(ShareLink(udfs))
+	, conflicts_(ShareLink(conflicts))
 	, indexing_policy_(indexing_policy)
+	, partition_key_(partition_key)
+	, partition_key_ranges_(make_shared<PartitionKeyRangeCache>())
 {}
 
 Collection::~Collection()
 {}
 
+shared_ptr<Collection> Collection::WithDiagnosticsHandler(
+	const function<void(const ResponseDiagnostics&)>& diagnostics_handler) const
+{
+	shared_ptr<Collection> collection = make_shared<Collection>(
+		document_db_configuration()->WithDiagnosticsHandler(diagnostics_handler),
+		id(),
+		resource_id(),
+		ts(),
+		self(),
+		etag(),
+		*docs_,
+		*sprocs_,
+		*triggers_,
+		*udfs_,
+		*conflicts_,
+		indexing_policy_,
+		partition_key_);
+	collection->set_document_cache(document_cache_);
+	return collection;
+}
+
 shared_ptr<Document> Collection::DocumentFromJson(
 	const value& json_collection) const
 {
@@ -93,6 +190,12 @@ shared_ptr<Document> Collection::DocumentFromJson(
 		json_collection);
 }
 
+shared_ptr<Document> Collection::DocumentFromJson(
+	const shared_ptr<const value>& json_document) const
+{
+	return make_shared<Document>(this->document_db_configuration(), json_document);
+}
+
 shared_ptr<Trigger> Collection::TriggerFromJson(
 	const value* json_trigger) const
 {
@@ -218,73 +321,367 @@ string_t Collection::GenerateGuid()
 #endif
 }
 
-pplx::task<shared_ptr<Document>> Collection::CreateDocumentAsync(
-	const value& document) const
+string_t Collection::SerializeNewDocument(
+	const value& document)
 {
-	value body = document;
+	if (document.has_field(DOCUMENT_ID) || !document.is_object())
+	{
+		return document.serialize();
+	}
 
-	if (!body.has_field(DOCUMENT_ID))
+	// Splice the id into the serialized object rather than copying the whole
+	// document to add it
+	string_t body = document.serialize();
+	string_t id_field = value::string(DOCUMENT_ID).serialize() + _XPLATSTR(":") + value::string(GenerateGuid()).serialize();
+	if (document.size() > 0)
 	{
-		body[DOCUMENT_ID] = value::string(GenerateGuid());
+		id_field += _XPLATSTR(",");
 	}
 
-	return this->CreateDocumentAsync(body.serialize());
+	body.insert(1, id_field);
+	return body;
 }
 
-pplx::task<shared_ptr<Document>> Collection::CreateDocumentAsync(
-	const string_t& document) const
+string_t Collection::SerializeNewDocument(
+	value&& document)
 {
-	http_request request = CreateRequest(
-		methods::POST,
-		RESOURCE_PATH_DOCS,
-		this->resource_id(),
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + docs_);
+	if (document.is_object() && !document.has_field(DOCUMENT_ID))
+	{
+		document[DOCUMENT_ID] = value::string(GenerateGuid());
+	}
 
-	request.set_body(document);
+	return document.serialize();
+}
 
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+pplx::task<DocumentDBResponse> Collection::SendCreateDocumentAsync(
+	const string_t& document,
+	const PartitionKey& partition_key,
+	bool upsert) const
+{
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
 	{
-		value json_response = response.extract_json().get();
-
-		if (response.status_code() == status_codes::Created)
+		http_request request = CreateRequest(
+			methods::POST,
+			RESOURCE_PATH_DOCS,
+			this->resource_id(),
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *docs_);
+		if (upsert)
 		{
-			return DocumentFromJson(json_response);
+			request.headers().add(HEADER_MS_DOCUMENTDB_IS_UPSERT, _XPLATSTR("true"));
 		}
+		SetPartitionKey(request, partition_key);
 
-		ThrowExceptionFromResponse(response.status_code(), json_response);
+		request.set_body(document);
+		return request;
 	});
 }
 
+pplx::task<shared_ptr<Document>> Collection::CreateDocumentAsync(
+	const value& document) const
+{
+	return WriteDocumentAsync(SerializeNewDocument(document), partition_key_.Extract(document), false);
+}
+
+pplx::task<shared_ptr<Document>> Collection::CreateDocumentAsync(
+	value&& document) const
+{
+	PartitionKey partition_key = partition_key_.Extract(document);
+	return WriteDocumentAsync(SerializeNewDocument(move(document)), partition_key, false);
+}
+
+pplx::task<shared_ptr<Document>> Collection::CreateDocumentAsync(
+	const string_t& document) const
+{
+	// The text is parsed only to find the partition key
+	PartitionKey partition_key;
+	if (!partition_key_.empty())
+	{
+		partition_key = partition_key_.Extract(value::parse(document));
+	}
+
+	return WriteDocumentAsync(document, partition_key, false);
+}
+
 shared_ptr<Document> Collection::CreateDocument(
 	const value& document) const
 {
 	return this->CreateDocumentAsync(document).get();
 }
 
+shared_ptr<Document> Collection::CreateDocument(
+	value&& document) const
+{
+	return this->CreateDocumentAsync(move(document)).get();
+}
+
 shared_ptr<Document> Collection::CreateDocument(
 	const string_t& document) const
 {
 	return this->CreateDocumentAsync(document).get();
 }
 
+pplx::task<vector<BulkItemResult>> Collection::CreateDocumentsAsync(
+	const vector<value>& documents,
+	const BulkOptions& options) const
+{
+	return WriteDocumentsAsync(make_shared<vector<value>>(documents), options, false);
+}
+
+pplx::task<vector<BulkItemResult>> Collection::CreateDocumentsAsync(
+	vector<value>&& documents,
+	const BulkOptions& options) const
+{
+	return WriteDocumentsAsync(make_shared<vector<value>>(move(documents)), options, false);
+}
+
+pplx::task<vector<BulkItemResult>> Collection::WriteDocumentsAsync(
+	const shared_ptr<vector<value>>& pending,
+	const BulkOptions& options,
+	bool upsert) const
+{
+	shared_ptr<vector<BulkItemResult>> results = make_shared<vector<BulkItemResult>>(pending->size());
+	shared_ptr<size_t> next = make_shared<size_t>(0);
+
+	return WriteDocumentsAsync(
+		[pending, next](value& document)
+		{
+			if (*next == pending->size())
+			{
+				return false;
+			}
+
+			document = move((*pending)[(*next)++]);
+			return true;
+		},
+		[results](const BulkItemResult& result)
+		{
+			(*results)[result.index()] = result;
+		},
+		options,
+		upsert).then([results]()
+	{
+		return move(*results);
+	});
+}
+
+vector<BulkItemResult> Collection::CreateDocuments(
+	const vector<value>& documents,
+	const BulkOptions& options) const
+{
+	return this->CreateDocumentsAsync(documents, options).get();
+}
+
+vector<BulkItemResult> Collection::CreateDocuments(
+	vector<value>&& documents,
+	const BulkOptions& options) const
+{
+	return this->CreateDocumentsAsync(move(documents), options).get();
+}
+
+pplx::task<void> Collection::CreateDocumentsAsync(
+	const function<bool(value&)>& next_document,
+	const function<void(const BulkItemResult&)>& on_result,
+	const BulkOptions& options) const
+{
+	return WriteDocumentsAsync(next_document, on_result, options, false);
+}
+
+pplx::task<void> Collection::WriteDocumentsAsync(
+	const function<bool(value&)>& next_document,
+	const function<void(const BulkItemResult&)>& on_result,
+	const BulkOptions& options,
+	bool upsert) const
+{
+	shared_ptr<const Collection> self = shared_from_this();
+	shared_ptr<BulkPipeline> pipeline = make_shared<BulkPipeline>(
+		options,
+		next_document,
+		[self, upsert](const value& document)
+		{
+			return self->SendCreateDocumentAsync(
+				SerializeNewDocument(document),
+				self->partition_key_.Extract(document),
+				upsert);
+		},
+		[self, upsert](const DocumentDBResponse& response)
+		{
+			// An upsert that replaced a document answers 200
+			if (response.status_code() != status_codes::Created
+				&& !(upsert && response.status_code() == status_codes::OK))
+			{
+				ThrowExceptionFromResponse(response.status_code(), response.json());
+			}
+
+			return self->DocumentFromJson(response.shared_json());
+		},
+		on_result);
+
+	return pipeline->RunAsync();
+}
+
+void Collection::CreateDocuments(
+	const function<bool(value&)>& next_document,
+	const function<void(const BulkItemResult&)>& on_result,
+	const BulkOptions& options) const
+{
+	this->CreateDocumentsAsync(next_document, on_result, options).get();
+}
+
+pplx::task<shared_ptr<Document>> Collection::WriteDocumentAsync(
+	const string_t& document,
+	const PartitionKey& partition_key,
+	bool upsert) const
+{
+	return SendCreateDocumentAsync(document, partition_key, upsert).then([=](const DocumentDBResponse& response)
+	{
+		const value& json_response = response.json();
+
+		// Created, or OK when an upsert replaced a document
+		if (response.status_code() == status_codes::Created
+			|| (upsert && response.status_code() == status_codes::OK))
+		{
+			shared_ptr<Document> written = DocumentFromJson(response.shared_json());
+			if (document_cache_)
+			{
+				document_cache_->Put(written->resource_id(), written, CachedSize(response));
+			}
+			return written;
+		}
+
+		ThrowExceptionFromResponse(response.status_code(), json_response);
+	});
+}
+
+pplx::task<shared_ptr<Document>> Collection::UpsertDocumentAsync(
+	const value& document) const
+{
+	return WriteDocumentAsync(SerializeNewDocument(document), partition_key_.Extract(document), true);
+}
+
+pplx::task<shared_ptr<Document>> Collection::UpsertDocumentAsync(
+	value&& document) const
+{
+	PartitionKey partition_key = partition_key_.Extract(document);
+	return WriteDocumentAsync(SerializeNewDocument(move(document)), partition_key, true);
+}
+
+shared_ptr<Document> Collection::UpsertDocument(
+	const value& document) const
+{
+	return this->UpsertDocumentAsync(document).get();
+}
+
+shared_ptr<Document> Collection::UpsertDocument(
+	value&& document) const
+{
+	return this->UpsertDocumentAsync(move(document)).get();
+}
+
+pplx::task<vector<BulkItemResult>> Collection::UpsertDocumentsAsync(
+	const vector<value>& documents,
+	const BulkOptions& options) const
+{
+	return WriteDocumentsAsync(make_shared<vector<value>>(documents), options, true);
+}
+
+pplx::task<vector<BulkItemResult>> Collection::UpsertDocumentsAsync(
+	vector<value>&& documents,
+	const BulkOptions& options) const
+{
+	return WriteDocumentsAsync(make_shared<vector<value>>(move(documents)), options, true);
+}
+
+vector<BulkItemResult> Collection::UpsertDocuments(
+	const vector<value>& documents,
+	const BulkOptions& options) const
+{
+	return this->UpsertDocumentsAsync(documents, options).get();
+}
+
+vector<BulkItemResult> Collection::UpsertDocuments(
+	vector<value>&& documents,
+	const BulkOptions& options) const
+{
+	return this->UpsertDocumentsAsync(move(documents), options).get();
+}
+
+pplx::task<void> Collection::UpsertDocumentsAsync(
+	const function<bool(value&)>& next_document,
+	const function<void(const BulkItemResult&)>& on_result,
+	const BulkOptions& options) const
+{
+	return WriteDocumentsAsync(next_document, on_result, options, true);
+}
+
+void Collection::UpsertDocuments(
+	const function<bool(value&)>& next_document,
+	const function<void(const BulkItemResult&)>& on_result,
+	const BulkOptions& options) const
+{
+	this->UpsertDocumentsAsync(next_document, on_result, options).get();
+}
+
 pplx::task<shared_ptr<Document>> Collection::GetDocumentAsync(
-	const string_t& resource_id) const
+	const string_t& resource_id,
+	const PartitionKey& partition_key) const
 {
-	http_request request = CreateRequest(
-		methods::GET,
-		RESOURCE_PATH_DOCS,
-		resource_id,
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + docs_ + resource_id);
+	shared_ptr<DocumentCache> cache = document_cache_;
+	shared_ptr<Document> cached;
+	if (cache)
+	{
+		exception_ptr not_found;
+		if (cache->TryGet(resource_id, cached, not_found) && not_found)
+		{
+			return pplx::task_from_exception<shared_ptr<Document>>(not_found);
+		}
+	}
 
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::GET,
+			RESOURCE_PATH_DOCS,
+			resource_id,
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *docs_ + resource_id);
+		SetPartitionKey(request, partition_key);
+		if (cached)
+		{
+			// The service answers 304 without a body while the etag matches
+			request.headers().add(HEADER_IF_NONE_MATCH, cached->etag());
+		}
+		return request;
+	}).then([=](const DocumentDBResponse& response)
 	{
-		value json_response = response.extract_json().get();
+		const value& json_response = response.json();
+
+		if (response.status_code() == status_codes::NotModified && cached)
+		{
+			return cached;
+		}
 
 		if (response.status_code() == status_codes::OK)
 		{
-			return DocumentFromJson(json_response);
+			shared_ptr<Document> document = DocumentFromJson(response.shared_json());
+			if (cache)
+			{
+				cache->Put(resource_id, document, CachedSize(response));
+			}
+			return document;
+		}
+
+		if (cache && response.status_code() == status_codes::NotFound)
+		{
+			try
+			{
+				ThrowExceptionFromResponse(response.status_code(), json_response);
+			}
+			catch (const ResourceNotFoundException&)
+			{
+				cache->PutNotFound(resource_id, current_exception());
+				throw;
+			}
 		}
 
 		ThrowExceptionFromResponse(response.status_code(), json_response);
@@ -292,33 +689,38 @@ pplx::task<shared_ptr<Document>> Collection::GetDocumentAsync(
 }
 
 shared_ptr<Document> Collection::GetDocument(
-	const string_t& resource_id) const
+	const string_t& resource_id,
+	const PartitionKey& partition_key) const
 {
-	return this->GetDocumentAsync(resource_id).get();
+	return this->GetDocumentAsync(resource_id, partition_key).get();
 }
 
 pplx::task<vector<shared_ptr<Document>>> Collection::ListDocumentsAsync() const
 {
-	http_request request = CreateRequest(
-		methods::GET,
-		RESOURCE_PATH_DOCS,
-		this->resource_id(),
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + docs_);
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
 	{
-		value json_response = response.extract_json().get();
+		http_request request = CreateRequest(
+			methods::GET,
+			RESOURCE_PATH_DOCS,
+			this->resource_id(),
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *docs_);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
+	{
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::OK)
 		{
 			assert(this->resource_id() == json_response.at(RESPONSE_RESOURCE_RID).as_string());
 			vector<shared_ptr<Document>> documents;
 			documents.reserve(json_response.at(RESPONSE_BODY_COUNT).as_integer());
-			value json_documents = json_response.at(RESPONSE_QUERY_DOCUMENTS);
+			const web::json::array& json_documents = json_response.at(RESPONSE_QUERY_DOCUMENTS).as_array();
 
-			for (auto iter = json_documents.as_array().cbegin(); iter != json_documents.as_array().cend(); ++iter)
+			// Payloads point into the response, which the documents keep alive
+			for (auto iter = json_documents.cbegin(); iter != json_documents.cend(); ++iter)
 			{
-				shared_ptr<Document> coll = DocumentFromJson(*iter);
+				shared_ptr<Document> coll = DocumentFromJson(shared_ptr<const value>(response.shared_json(), &*iter));
 				documents.push_back(coll);
 			}
 			return documents;
@@ -333,126 +735,760 @@ vector<shared_ptr<Document>> Collection::ListDocuments() const
 	return this->ListDocumentsAsync().get();
 }
 
-pplx::task<shared_ptr<Document>> Collection::ReplaceDocumentAsync(
+ResponseBodyReader Collection::StreamDocuments(
+	const function<void(const shared_ptr<Document>&)>& on_document) const
+{
+	shared_ptr<const Collection> self = shared_from_this();
+	return [self, on_document](const http_response& response)
+	{
+		return ReadJsonArrayAsync(response, RESPONSE_QUERY_DOCUMENTS, [self, on_document](value&& document)
+		{
+			on_document(self->DocumentFromJson(make_shared<const value>(move(document))));
+		});
+	};
+}
+
+pplx::task<void> Collection::StreamResourcesAsync(
+	const string_t& resource_type,
+	const string_t& resources,
+	const string_t& array_field,
+	const function<void(value&&)>& on_item) const
+{
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::GET,
+			resource_type,
+			this->resource_id(),
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + resources);
+		return request;
+	}, [array_field, on_item](const http_response& response)
+	{
+		return ReadJsonArrayAsync(response, array_field, on_item);
+	}).then([](const DocumentDBResponse& response)
+	{
+		if (response.status_code() != status_codes::OK)
+		{
+			ThrowExceptionFromResponse(response.status_code(), response.json());
+		}
+	});
+}
+
+pplx::task<void> Collection::ListDocumentsAsync(
+	const function<void(const shared_ptr<Document>&)>& on_document) const
+{
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::GET,
+			RESOURCE_PATH_DOCS,
+			this->resource_id(),
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *docs_);
+		return request;
+	}, StreamDocuments(on_document)).then([=](const DocumentDBResponse& response)
+	{
+		if (response.status_code() != status_codes::OK)
+		{
+			ThrowExceptionFromResponse(response.status_code(), response.json());
+		}
+	});
+}
+
+void Collection::ListDocuments(
+	const function<void(const shared_ptr<Document>&)>& on_document) const
+{
+	this->ListDocumentsAsync(on_document).get();
+}
+
+pplx::task<shared_ptr<Document>> Collection::SendReplaceDocumentAsync(
+	const string_t& resource_id,
+	const string_t& document,
+	const PartitionKey& partition_key,
+	const string_t& if_match) const
+{
+	// Serialized once, every attempt sends the same body
+	shared_ptr<const string_t> body = make_shared<const string_t>(document);
+
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::PUT,
+			RESOURCE_PATH_DOCS,
+			resource_id,
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *docs_ + resource_id);
+		SetPartitionKey(request, partition_key);
+		if (!if_match.empty())
+		{
+			request.headers().add(HEADER_IF_MATCH, if_match);
+		}
+
+		request.set_body(*body, MIME_TYPE_APPLICATION_JSON);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
+	{
+		const value& json_response = response.json();
+
+		if (response.status_code() == status_codes::OK)
+		{
+			assert(resource_id == json_response.at(RESPONSE_RESOURCE_RID).as_string());
+			shared_ptr<Document> replaced = DocumentFromJson(response.shared_json());
+			if (document_cache_)
+			{
+				document_cache_->Put(resource_id, replaced, CachedSize(response));
+			}
+			return replaced;
+		}
+
+		ThrowExceptionFromResponse(response.status_code(), json_response);
+	});
+}
+
+pplx::task<shared_ptr<Document>> Collection::ReplaceDocumentAsync(
+	const string_t& resource_id,
+	const value& document) const
+{
+	return SendReplaceDocumentAsync(resource_id, SerializeNewDocument(document), partition_key_.Extract(document));
+}
+
+pplx::task<shared_ptr<Document>> Collection::ReplaceDocumentAsync(
+	const string_t& resource_id,
+	value&& document) const
+{
+	PartitionKey partition_key = partition_key_.Extract(document);
+	return SendReplaceDocumentAsync(resource_id, SerializeNewDocument(move(document)), partition_key);
+}
+
+shared_ptr<Document> Collection::ReplaceDocument(
+	const string_t& resource_id,
+	const value& document) const
+{
+	return this->ReplaceDocumentAsync(resource_id, document).get();
+}
+
+shared_ptr<Document> Collection::ReplaceDocument(
+	const string_t& resource_id,
+	value&& document) const
+{
+	return this->ReplaceDocumentAsync(resource_id, move(document)).get();
+}
+
+pplx::task<shared_ptr<Document>> Collection::UpdateDocumentAsync(
+	const string_t& resource_id,
+	const function<bool(value&)>& update,
+	int max_attempts,
+	const PartitionKey& partition_key) const
+{
+	return UpdateDocumentAttemptAsync(resource_id, update, partition_key, max_attempts, 0);
+}
+
+pplx::task<shared_ptr<Document>> Collection::UpdateDocumentAttemptAsync(
+	const string_t& resource_id,
+	const function<bool(value&)>& update,
+	const PartitionKey& partition_key,
+	int max_attempts,
+	int attempt) const
+{
+	shared_ptr<const Collection> self = shared_from_this();
+	return GetDocumentAsync(resource_id, partition_key).then([=](const shared_ptr<Document>& document)
+	{
+		value payload = document->payload();
+		if (!update(payload))
+		{
+			return pplx::task_from_result(document);
+		}
+
+		return self->SendReplaceDocumentAsync(
+			resource_id,
+			SerializeNewDocument(move(payload)),
+			partition_key,
+			document->etag()).then([=](pplx::task<shared_ptr<Document>> replaced)
+		{
+			try
+			{
+				return pplx::task_from_result(replaced.get());
+			}
+			catch (const PreconditionFailedException&)
+			{
+				if (attempt + 1 >= max_attempts)
+				{
+					throw;
+				}
+			}
+
+			// Another writer got there first, start over from its version
+			chrono::milliseconds delay = JitteredBackoff(
+				self->document_db_configuration()->connection_policy().retry_options(),
+				attempt);
+			return DelayAsync(delay).then([=]()
+			{
+				return self->UpdateDocumentAttemptAsync(resource_id, update, partition_key, max_attempts, attempt + 1);
+			});
+		});
+	});
+}
+
+shared_ptr<Document> Collection::UpdateDocument(
+	const string_t& resource_id,
+	const function<bool(value&)>& update,
+	int max_attempts,
+	const PartitionKey& partition_key) const
+{
+	return this->UpdateDocumentAsync(resource_id, update, max_attempts, partition_key).get();
+}
+
+pplx::task<void> Collection::DeleteDocumentAsync(
+	const shared_ptr<Document>& document) const
+{
+	return DeleteDocumentAsync(document->resource_id(), partition_key_.Extract(document->payload()));
+}
+
+void Collection::DeleteDocument(
+	const shared_ptr<Document>& document) const
+{
+	this->DeleteDocumentAsync(document).get();
+}
+
+pplx::task<void> Collection::DeleteDocumentAsync(
+	const string_t& resource_id,
+	const PartitionKey& partition_key) const
+{
+	if (document_cache_)
+	{
+		document_cache_->Remove(resource_id);
+	}
+
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::DEL,
+			RESOURCE_PATH_DOCS,
+			resource_id,
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *docs_ + resource_id);
+		SetPartitionKey(request, partition_key);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
+	{
+		if (response.status_code() == status_codes::NoContent)
+		{
+			return;
+		}
+
+		const value& json_response = response.json();
+		ThrowExceptionFromResponse(response.status_code(), json_response);
+	});
+}
+
+void Collection::DeleteDocument(
+	const string_t& resource_id,
+	const PartitionKey& partition_key) const
+{
+	this->DeleteDocumentAsync(resource_id, partition_key).get();
+}
+
+pplx::task<shared_ptr<DocumentIterator>> Collection::QueryDocumentsAsync(
+	const SqlQuerySpec& query,
+	const int page_size) const
+{
+	const string_t requestUri = this->self() + *docs_;
+
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateQueryRequest(
+			query,
+			page_size,
+			RESOURCE_PATH_DOCS,
+			this->resource_id(),
+			this->document_db_configuration()->request_signer(),
+			string_t(),
+			false,
+			!partition_key_.empty());
+		request.set_request_uri(requestUri);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
+	{
+		string_t continuation_id = response.header(HEADER_MS_CONTINUATION);
+		const value& json_response = response.json();
+
+		if (response.status_code() == status_codes::OK)
+		{
+			assert(this->resource_id() == json_response.at(RESPONSE_RESOURCE_RID).as_string());
+
+			return make_shared<DocumentIterator>(
+				shared_from_this(),
+				query,
+				page_size,
+				requestUri,
+				continuation_id,
+				response.shared_json(),
+				response.diagnostics());
+		}
+
+		ThrowExceptionFromResponse(response.status_code(), json_response);
+	});
+}
+
+shared_ptr<DocumentIterator> Collection::QueryDocuments(
+	const SqlQuerySpec& query,
+	const int page_size) const
+{
+	return this->QueryDocumentsAsync(query, page_size).get();
+}
+
+pplx::task<shared_ptr<ValueIterator>> Collection::QueryValuesAsync(
+	const SqlQuerySpec& query,
+	const int page_size) const
+{
+	const string_t requestUri = this->self() + *docs_;
+
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateQueryRequest(
+			query,
+			page_size,
+			RESOURCE_PATH_DOCS,
+			this->resource_id(),
+			this->document_db_configuration()->request_signer(),
+			string_t(),
+			false,
+			!partition_key_.empty());
+		request.set_request_uri(requestUri);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
+	{
+		const value& json_response = response.json();
+
+		if (response.status_code() == status_codes::OK)
+		{
+			return make_shared<ValueIterator>(
+				shared_from_this(),
+				query,
+				page_size,
+				requestUri,
+				response.header(HEADER_MS_CONTINUATION),
+				response.shared_json(),
+				response.diagnostics());
+		}
+
+		ThrowExceptionFromResponse(response.status_code(), json_response);
+	});
+}
+
+shared_ptr<ValueIterator> Collection::QueryValues(
+	const SqlQuerySpec& query,
+	const int page_size) const
+{
+	return this->QueryValuesAsync(query, page_size).get();
+}
+
+pplx::task<vector<PartitionKeyRange>> Collection::GetPartitionKeyRangesAsync() const
+{
+	pplx::task<vector<PartitionKeyRange>> ranges;
+	{
+		lock_guard<mutex> lock(partition_key_ranges_->ranges_mutex);
+		if (partition_key_ranges_->ranges)
+		{
+			return *partition_key_ranges_->ranges;
+		}
+
+		ranges = ReadPartitionKeyRangesAsync(string_t(), make_shared<vector<PartitionKeyRange>>());
+		partition_key_ranges_->ranges = make_shared<pplx::task<vector<PartitionKeyRange>>>(ranges);
+	}
+
+	shared_ptr<const Collection> self = shared_from_this();
+
+	// A failed read is not kept, the next call reads again
+	return ranges.then([self](pplx::task<vector<PartitionKeyRange>> read)
+	{
+		try
+		{
+			return read.get();
+		}
+		catch (...)
+		{
+			self->ForgetPartitionKeyRanges();
+			throw;
+		}
+	});
+}
+
+vector<PartitionKeyRange> Collection::GetPartitionKeyRanges() const
+{
+	return this->GetPartitionKeyRangesAsync().get();
+}
+
+pplx::task<vector<PartitionKeyRange>> Collection::ReadPartitionKeyRangesAsync(
+	const string_t& continuation,
+	const shared_ptr<vector<PartitionKeyRange>>& ranges) const
+{
+	shared_ptr<const Collection> self = shared_from_this();
+
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::GET,
+			RESOURCE_PATH_PKRANGES,
+			self->resource_id(),
+			self->document_db_configuration()->request_signer());
+		request.set_request_uri(self->self() + RESOURCE_PATH_PKRANGES);
+		if (!continuation.empty())
+		{
+			request.headers().add(HEADER_MS_CONTINUATION, continuation);
+		}
+		return request;
+	}).then([=](const DocumentDBResponse& response)
+	{
+		const value& json_response = response.json();
+		if (response.status_code() != status_codes::OK)
+		{
+			ThrowExceptionFromResponse(response.status_code(), json_response);
+		}
+
+		const web::json::array& json_ranges = json_response.at(RESPONSE_PARTITION_KEY_RANGES).as_array();
+		for (auto iter = json_ranges.cbegin(); iter != json_ranges.cend(); ++iter)
+		{
+			ranges->push_back(PartitionKeyRange::FromJson(*iter));
+		}
+
+		string_t next = response.header(HEADER_MS_CONTINUATION);
+		if (next.empty())
+		{
+			return pplx::task_from_result(*ranges);
+		}
+		return self->ReadPartitionKeyRangesAsync(next, ranges);
+	});
+}
+
+void Collection::ForgetPartitionKeyRanges() const
+{
+	lock_guard<mutex> lock(partition_key_ranges_->ranges_mutex);
+	partition_key_ranges_->ranges.reset();
+}
+
+pplx::task<vector<value>> Collection::QueryValuesParallelAsync(
+	const SqlQuerySpec& query,
+	const ParallelQueryOptions& options) const
+{
+	return QueryValuesParallelAsync(query, options, true);
+}
+
+pplx::task<vector<value>> Collection::QueryValuesParallelAsync(
+	const SqlQuerySpec& query,
+	const ParallelQueryOptions& options,
+	bool retry_on_split) const
+{
+	shared_ptr<const Collection> self = shared_from_this();
+	return GetPartitionKeyRangesAsync().then([=](const vector<PartitionKeyRange>& ranges)
+	{
+		return make_shared<ParallelQuery>(self, query, options, ranges)->RunAsync();
+	}).then([=](pplx::task<vector<value>> results)
+	{
+		try
+		{
+			return pplx::task_from_result(results.get());
+		}
+		catch (const DocumentDBResponseException& e)
+		{
+			if (!retry_on_split || e.status_code() != status_codes::Gone)
+			{
+				throw;
+			}
+		}
+
+		// A range split after the ranges were read, its results are incomplete
+		self->ForgetPartitionKeyRanges();
+		return self->QueryValuesParallelAsync(query, options, false);
+	});
+}
+
+vector<value> Collection::QueryValuesParallel(
+	const SqlQuerySpec& query,
+	const ParallelQueryOptions& options) const
+{
+	return this->QueryValuesParallelAsync(query, options).get();
+}
+
+pplx::task<vector<shared_ptr<Document>>> Collection::QueryDocumentsParallelAsync(
+	const SqlQuerySpec& query,
+	const ParallelQueryOptions& options) const
+{
+	shared_ptr<const Collection> self = shared_from_this();
+	return QueryValuesParallelAsync(query, options).then([self](vector<value> results)
+	{
+		vector<shared_ptr<Document>> documents;
+		documents.reserve(results.size());
+		for (auto iter = results.begin(); iter != results.end(); ++iter)
+		{
+			documents.push_back(self->DocumentFromJson(make_shared<const value>(move(*iter))));
+		}
+		return documents;
+	});
+}
+
+vector<shared_ptr<Document>> Collection::QueryDocumentsParallel(
+	const SqlQuerySpec& query,
+	const ParallelQueryOptions& options) const
+{
+	return this->QueryDocumentsParallelAsync(query, options).get();
+}
+
+pplx::task<void> Collection::StreamQueryPageAsync(
+	const SqlQuerySpec& query,
+	const int page_size,
+	const string_t& continuation_id,
+	const ResponseBodyReader& read_body) const
+{
+	const string_t requestUri = this->self() + *docs_;
+	shared_ptr<const Collection> self = shared_from_this();
+
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateQueryRequest(
+			query,
+			page_size,
+			RESOURCE_PATH_DOCS,
+			this->resource_id(),
+			this->document_db_configuration()->request_signer(),
+			continuation_id,
+			false,
+			!partition_key_.empty());
+		request.set_request_uri(requestUri);
+		return request;
+	}, read_body).then([=](const DocumentDBResponse& response) -> pplx::task<void>
+	{
+		if (response.status_code() != status_codes::OK)
+		{
+			ThrowExceptionFromResponse(response.status_code(), response.json());
+		}
+
+		string_t next_continuation_id = response.header(HEADER_MS_CONTINUATION);
+		if (next_continuation_id.empty())
+		{
+			return pplx::task_from_result();
+		}
+
+		return self->StreamQueryPageAsync(query, page_size, next_continuation_id, read_body);
+	});
+}
+
+pplx::task<void> Collection::QueryDocumentsAsync(
+	const SqlQuerySpec& query,
+	const function<void(const shared_ptr<Document>&)>& on_document,
+	const int page_size) const
+{
+	return StreamQueryPageAsync(query, page_size, string_t(), StreamDocuments(on_document));
+}
+
+void Collection::QueryDocuments(
+	const SqlQuerySpec& query,
+	const function<void(const shared_ptr<Document>&)>& on_document,
+	const int page_size) const
+{
+	this->QueryDocumentsAsync(query, on_document, page_size).get();
+}
+
+pplx::task<RawResponse> Collection::CreateDocumentRawAsync(
+	const shared_ptr<const vector<unsigned char>>& document,
+	const PartitionKey& partition_key) const
+{
+	// The buffer stays alive with the request factory for every attempt
+	return ExecuteRawRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::POST,
+			RESOURCE_PATH_DOCS,
+			this->resource_id(),
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *docs_);
+		SetPartitionKey(request, partition_key);
+
+		SetRawBody(request, document);
+		return request;
+	}, status_codes::Created);
+}
+
+RawResponse Collection::CreateDocumentRaw(
+	const shared_ptr<const vector<unsigned char>>& document,
+	const PartitionKey& partition_key) const
+{
+	return this->CreateDocumentRawAsync(document, partition_key).get();
+}
+
+pplx::task<RawResponse> Collection::GetDocumentRawAsync(
+	const string_t& resource_id,
+	const PartitionKey& partition_key) const
+{
+	return ExecuteRawRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::GET,
+			RESOURCE_PATH_DOCS,
+			resource_id,
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *docs_ + resource_id);
+		SetPartitionKey(request, partition_key);
+		return request;
+	}, status_codes::OK);
+}
+
+RawResponse Collection::GetDocumentRaw(
+	const string_t& resource_id,
+	const PartitionKey& partition_key) const
+{
+	return this->GetDocumentRawAsync(resource_id, partition_key).get();
+}
+
+pplx::task<RawResponse> Collection::ReplaceDocumentRawAsync(
 	const string_t& resource_id,
-	const value& document) const
+	const shared_ptr<const vector<unsigned char>>& document,
+	const PartitionKey& partition_key) const
 {
-	http_request request = CreateRequest(
-		methods::PUT,
-		RESOURCE_PATH_DOCS,
-		resource_id,
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + docs_ + resource_id);
-
-	value body = document;
-	if (!body.has_field(DOCUMENT_ID))
+	// The replacement is not parsed, so it is not written through
+	if (document_cache_)
 	{
-		body[DOCUMENT_ID] = value::string(GenerateGuid());
+		document_cache_->Remove(resource_id);
 	}
 
-	request.set_body(body);
-
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+	return ExecuteRawRequestAsync(*this->document_db_configuration(), [=]()
 	{
-		value json_response = response.extract_json().get();
-
-		if (response.status_code() == status_codes::OK)
-		{
-			assert(resource_id == json_response.at(RESPONSE_RESOURCE_RID).as_string());
-			return DocumentFromJson(json_response);
-		}
+		http_request request = CreateRequest(
+			methods::PUT,
+			RESOURCE_PATH_DOCS,
+			resource_id,
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *docs_ + resource_id);
+		SetPartitionKey(request, partition_key);
 
-		ThrowExceptionFromResponse(response.status_code(), json_response);
-	});
+		SetRawBody(request, document);
+		return request;
+	}, status_codes::OK);
 }
 
-shared_ptr<Document> Collection::ReplaceDocument(
+RawResponse Collection::ReplaceDocumentRaw(
 	const string_t& resource_id,
-	const value& document) const
+	const shared_ptr<const vector<unsigned char>>& document,
+	const PartitionKey& partition_key) const
 {
-	return this->ReplaceDocumentAsync(resource_id, document).get();
+	return this->ReplaceDocumentRawAsync(resource_id, document, partition_key).get();
 }
 
-pplx::task<void> Collection::DeleteDocumentAsync(
-	const shared_ptr<Document>& document) const
+pplx::task<RawResponse> Collection::QueryDocumentsRawAsync(
+	const SqlQuerySpec& query,
+	const string_t& continuation_id,
+	const int page_size) const
 {
-	return DeleteDocumentAsync(document->resource_id());
-}
+	const string_t requestUri = this->self() + *docs_;
 
-void Collection::DeleteDocument(
-	const shared_ptr<Document>& document) const
+	return ExecuteRawRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateQueryRequest(
+			query,
+			page_size,
+			RESOURCE_PATH_DOCS,
+			this->resource_id(),
+			this->document_db_configuration()->request_signer(),
+			continuation_id,
+			false,
+			!partition_key_.empty());
+		request.set_request_uri(requestUri);
+		return request;
+	}, status_codes::OK);
+}
+
+RawResponse Collection::QueryDocumentsRaw(
+	const SqlQuerySpec& query,
+	const string_t& continuation_id,
+	const int page_size) const
 {
-	this->DeleteDocumentAsync(document).get();
+	return this->QueryDocumentsRawAsync(query, continuation_id, page_size).get();
 }
 
-pplx::task<void> Collection::DeleteDocumentAsync(
-	const string_t& resource_id) const
+pplx::task<void> Collection::GetDocumentTextAsync(
+	const string_t& resource_id,
+	const PartitionKey& partition_key,
+	const function<void(const std::string&)>& on_document) const
 {
-	http_request request = CreateRequest(
-		methods::DEL,
-		RESOURCE_PATH_DOCS,
-		resource_id,
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + docs_ + resource_id);
-
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
 	{
-		if (response.status_code() == status_codes::NoContent)
+		http_request request = CreateRequest(
+			methods::GET,
+			RESOURCE_PATH_DOCS,
+			resource_id,
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *docs_ + resource_id);
+		SetPartitionKey(request, partition_key);
+		return request;
+	}, ReadBodyText(on_document)).then([=](const DocumentDBResponse& response)
+	{
+		if (response.status_code() != status_codes::OK)
 		{
-			return;
+			ThrowExceptionFromResponse(response.status_code(), response.json());
 		}
-
-		value json_response = response.extract_json().get();
-		ThrowExceptionFromResponse(response.status_code(), json_response);
 	});
 }
 
-void Collection::DeleteDocument(
-	const string_t& resource_id) const
-{
-	this->DeleteDocumentAsync(resource_id).get();
-}
-
-pplx::task<shared_ptr<DocumentIterator>> Collection::QueryDocumentsAsync(
-	const string_t& query,
-	const int page_size) const
+pplx::task<void> Collection::CreateDocumentTextAsync(
+	std::string document,
+	bool has_id,
+	const PartitionKey& partition_key,
+	const function<void(const std::string&)>& on_document) const
 {
-	http_request request = CreateQueryRequest(
-		query,
-		page_size,
-		RESOURCE_PATH_DOCS,
-		this->resource_id(),
-		this->document_db_configuration()->master_key());
-	const string_t requestUri = this->self() + docs_;
-	request.set_request_uri(requestUri);
+	if (!has_id && document.size() > 1 && document[0] == '{')
+	{
+		// Spliced in like SerializeNewDocument does
+		std::string id_field = "\"" + utility::conversions::to_utf8string(DOCUMENT_ID) + "\":\""
+			+ utility::conversions::to_utf8string(GenerateGuid()) + "\"";
+		if (document[1] != '}')
+		{
+			id_field += ",";
+		}
+		document.insert(1, id_field);
+	}
 
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+	// The text is only parsed when the collection is partitioned
+	PartitionKey document_partition_key = partition_key;
+	if (document_partition_key.empty() && !partition_key_.empty())
 	{
-		string_t continuation_id = response.headers()[HEADER_MS_CONTINUATION];
-		value json_response = response.extract_json().get();
+		document_partition_key = partition_key_.Extract(value::parse(utility::conversions::to_string_t(document)));
+	}
 
-		if (response.status_code() == status_codes::OK)
-		{
-			assert(this->resource_id() == json_response.at(RESPONSE_RESOURCE_RID).as_string());
+	// Encoded once, every attempt sends the same body
+	shared_ptr<const std::string> body = make_shared<const std::string>(move(document));
 
-			return make_shared<DocumentIterator>(
-				shared_from_this(),
-				query,
-				page_size,
-				requestUri,
-				continuation_id,
-				json_response.at(RESPONSE_QUERY_DOCUMENTS));
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::POST,
+			RESOURCE_PATH_DOCS,
+			this->resource_id(),
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *docs_);
+		SetPartitionKey(request, document_partition_key);
+
+		// The UTF-8 overload, the text is sent as it is
+		request.set_body(*body, "application/json");
+		return request;
+	}, ReadBodyText(on_document)).then([=](const DocumentDBResponse& response)
+	{
+		if (response.status_code() != status_codes::Created)
+		{
+			ThrowExceptionFromResponse(response.status_code(), response.json());
 		}
-
-		ThrowExceptionFromResponse(response.status_code(), json_response);
 	});
 }
 
-shared_ptr<DocumentIterator> Collection::QueryDocuments(
-	const string_t& query,
-	const int page_size) const
+pplx::task<void> Collection::QueryDocumentsTextAsync(
+	const SqlQuerySpec& query,
+	const int page_size,
+	const function<void(const std::string&)>& on_document) const
 {
-	return this->QueryDocumentsAsync(query, page_size).get();
+	return StreamQueryPageAsync(query, page_size, string_t(), [on_document](const http_response& response)
+	{
+		return ReadJsonArrayTextAsync(response, RESPONSE_QUERY_DOCUMENTS, on_document);
+	});
 }
 
 pplx::task<shared_ptr<Trigger>> Collection::CreateTriggerAsync(
@@ -461,24 +1497,26 @@ pplx::task<shared_ptr<Trigger>> Collection::CreateTriggerAsync(
 	const TriggerOperation& triggerOperation,
 	const TriggerType& triggerType) const
 {
-	http_request request = CreateRequest(
-		methods::POST,
-		RESOURCE_PATH_TRIGGERS,
-		this->resource_id(),
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + triggers_);
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::POST,
+			RESOURCE_PATH_TRIGGERS,
+			this->resource_id(),
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *triggers_);
 	
-	value body_;
-	body_[DOCUMENT_ID] = value::string(id);
-	body_[BODY] = value::string(body);
-	body_[TRIGGER_OPERATION] = value::string(triggerOperationToWstring(triggerOperation));
-	body_[TRIGGER_TYPE] = value::string(triggerTypeToWstring(triggerType));
+		value body_;
+		body_[DOCUMENT_ID] = value::string(id);
+		body_[BODY] = value::string(body);
+		body_[TRIGGER_OPERATION] = value::string(triggerOperationToWstring(triggerOperation));
+		body_[TRIGGER_TYPE] = value::string(triggerTypeToWstring(triggerType));
 	
-	request.set_body(body_);
-
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+		request.set_body(body_);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
 	{
-		value json_response = response.extract_json().get();
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::Created)
 		{
@@ -501,16 +1539,30 @@ shared_ptr<Trigger> Collection::CreateTrigger(
 pplx::task<shared_ptr<Trigger>> Collection::GetTriggerAsync(
 	const string_t& resource_id) const
 {
-	http_request request = CreateRequest(
-		methods::GET,
-		RESOURCE_PATH_TRIGGERS,
-		resource_id,
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + triggers_ + resource_id);
+	shared_ptr<const Collection> self = shared_from_this();
+	return this->document_db_configuration()->metadata_cache()->GetAsync<Trigger>(
+		this->self() + *triggers_ + resource_id,
+		[self, resource_id]()
+		{
+			return self->ReadTriggerAsync(resource_id);
+		});
+}
 
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+pplx::task<shared_ptr<Trigger>> Collection::ReadTriggerAsync(
+	const string_t& resource_id) const
+{
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::GET,
+			RESOURCE_PATH_TRIGGERS,
+			resource_id,
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *triggers_ + resource_id);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
 	{
-		value json_response = response.extract_json().get();
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::OK)
 		{
@@ -529,15 +1581,35 @@ shared_ptr<Trigger> Collection::GetTrigger(
 
 pplx::task<vector<shared_ptr<Trigger>>> Collection::ListTriggersAsync() const
 {
-	http_request request = CreateRequest(
-		methods::GET,
-		RESOURCE_PATH_TRIGGERS,
-		this->resource_id(),
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + triggers_);
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+	shared_ptr<const Collection> self = shared_from_this();
+	return this->document_db_configuration()->metadata_cache()->GetAsync<vector<shared_ptr<Trigger>>>(
+		this->self() + *triggers_,
+		[self]()
+		{
+			return self->ReadTriggersAsync().then([](vector<shared_ptr<Trigger>> triggers)
+			{
+				return make_shared<vector<shared_ptr<Trigger>>>(move(triggers));
+			});
+		}).then([](shared_ptr<vector<shared_ptr<Trigger>>> triggers)
+	{
+		return *triggers;
+	});
+}
+
+pplx::task<vector<shared_ptr<Trigger>>> Collection::ReadTriggersAsync() const
+{
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::GET,
+			RESOURCE_PATH_TRIGGERS,
+			this->resource_id(),
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *triggers_);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
 	{
-		value json_response = response.extract_json().get();
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::OK)
 		{
@@ -563,6 +1635,22 @@ vector<shared_ptr<Trigger>> Collection::ListTriggers() const
 	return ListTriggersAsync().get();
 }
 
+pplx::task<void> Collection::ListTriggersAsync(
+	const function<void(const shared_ptr<Trigger>&)>& on_trigger) const
+{
+	shared_ptr<const Collection> self = shared_from_this();
+	return StreamResourcesAsync(RESOURCE_PATH_TRIGGERS, *triggers_, RESPONSE_QUERY_TRIGGERS, [self, on_trigger](value&& json)
+	{
+		on_trigger(self->TriggerFromJson(&json));
+	});
+}
+
+void Collection::ListTriggers(
+	const function<void(const shared_ptr<Trigger>&)>& on_trigger) const
+{
+	this->ListTriggersAsync(on_trigger).get();
+}
+
 pplx::task<shared_ptr<Trigger>> Collection::ReplaceTriggerAsync(
 	const string_t& id,
 	const string_t& new_id,
@@ -570,24 +1658,26 @@ pplx::task<shared_ptr<Trigger>> Collection::ReplaceTriggerAsync(
 	const TriggerOperation& triggerOperation,
 	const TriggerType& triggerType) const
 {
-	http_request request = CreateRequest(
-		methods::PUT,
-		RESOURCE_PATH_TRIGGERS,
-		id,
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + triggers_ + id);
-
-	value body_;
-	body_[DOCUMENT_ID] = value::string(new_id);
-	body_[BODY] = value::string(body);
-	body_[TRIGGER_OPERATION] = value::string(triggerOperationToWstring(triggerOperation));
-	body_[TRIGGER_TYPE] = value::string(triggerTypeToWstring(triggerType));
-
-	request.set_body(body_);
-
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
 	{
-		value json_response = response.extract_json().get();
+		http_request request = CreateRequest(
+			methods::PUT,
+			RESOURCE_PATH_TRIGGERS,
+			id,
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *triggers_ + id);
+
+		value body_;
+		body_[DOCUMENT_ID] = value::string(new_id);
+		body_[BODY] = value::string(body);
+		body_[TRIGGER_OPERATION] = value::string(triggerOperationToWstring(triggerOperation));
+		body_[TRIGGER_TYPE] = value::string(triggerTypeToWstring(triggerType));
+
+		request.set_body(body_);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
+	{
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::OK)
 		{
@@ -623,21 +1713,23 @@ void Collection::DeleteTrigger(
 pplx::task<void> Collection::DeleteTriggerAsync(
 	const string_t& resource_id) const
 {
-	http_request request = CreateRequest(
-		methods::DEL,
-		RESOURCE_PATH_TRIGGERS,
-		resource_id,
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + triggers_ + resource_id);
-
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::DEL,
+			RESOURCE_PATH_TRIGGERS,
+			resource_id,
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *triggers_ + resource_id);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
 	{
 		if (response.status_code() == status_codes::NoContent)
 		{
 			return;
 		}
 
-		value json_response = response.extract_json().get();
+		const value& json_response = response.json();
 		ThrowExceptionFromResponse(response.status_code(), json_response);
 	});
 }
@@ -649,22 +1741,25 @@ void Collection::DeleteTrigger(
 }
 
 pplx::task<shared_ptr<TriggerIterator>> Collection::QueryTriggersAsync(
-	const string_t& query,
+	const SqlQuerySpec& query,
 	const int page_size) const
 {
-	http_request request = CreateQueryRequest(
-		query,
-		page_size,
-		RESOURCE_PATH_TRIGGERS,
-		this->resource_id(),
-		this->document_db_configuration()->master_key());
-	const string_t requestUri = this->self() + triggers_;
-	request.set_request_uri(requestUri);
+	const string_t requestUri = this->self() + *triggers_;
 
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateQueryRequest(
+			query,
+			page_size,
+			RESOURCE_PATH_TRIGGERS,
+			this->resource_id(),
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(requestUri);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
 	{
-		string_t continuation_id = response.headers()[HEADER_MS_CONTINUATION];
-		value json_response = response.extract_json().get();
+		string_t continuation_id = response.header(HEADER_MS_CONTINUATION);
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::OK)
 		{
@@ -676,7 +1771,8 @@ pplx::task<shared_ptr<TriggerIterator>> Collection::QueryTriggersAsync(
 				page_size,
 				requestUri,
 				continuation_id,
-				json_response.at(RESPONSE_QUERY_TRIGGERS));
+				response.shared_json(),
+				response.diagnostics());
 		}
 
 		ThrowExceptionFromResponse(response.status_code(), json_response);
@@ -684,7 +1780,7 @@ pplx::task<shared_ptr<TriggerIterator>> Collection::QueryTriggersAsync(
 }
 
 shared_ptr<TriggerIterator> Collection::QueryTriggers(
-	const string_t& query,
+	const SqlQuerySpec& query,
 	const int page_size) const
 {
 	return QueryTriggersAsync(query, page_size).get();
@@ -694,22 +1790,24 @@ pplx::task<shared_ptr<StoredProcedure>> Collection::CreateStoredProcedureAsync(
 	const string_t& id,
 	const string_t& body) const
 {
-	http_request request = CreateRequest(
-		methods::POST,
-		RESOURCE_PATH_SPROCS,
-		this->resource_id(),
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + sprocs_);
-
-	value body_;
-	body_[DOCUMENT_ID] = value::string(id);
-	body_[BODY] = value::string(body);
-
-	request.set_body(body_);
-
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::POST,
+			RESOURCE_PATH_SPROCS,
+			this->resource_id(),
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *sprocs_);
+
+		value body_;
+		body_[DOCUMENT_ID] = value::string(id);
+		body_[BODY] = value::string(body);
+
+		request.set_body(body_);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
 	{
-		value json_response = response.extract_json().get();
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::Created)
 		{
@@ -730,16 +1828,30 @@ shared_ptr<StoredProcedure> Collection::CreateStoredProcedure(
 pplx::task<shared_ptr<StoredProcedure>> Collection::GetStoredProcedureAsync(
 	const string_t& resource_id) const
 {
-	http_request request = CreateRequest(
-		methods::GET,
-		RESOURCE_PATH_SPROCS,
-		resource_id,
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + sprocs_ + resource_id);
+	shared_ptr<const Collection> self = shared_from_this();
+	return this->document_db_configuration()->metadata_cache()->GetAsync<StoredProcedure>(
+		this->self() + *sprocs_ + resource_id,
+		[self, resource_id]()
+		{
+			return self->ReadStoredProcedureAsync(resource_id);
+		});
+}
 
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+pplx::task<shared_ptr<StoredProcedure>> Collection::ReadStoredProcedureAsync(
+	const string_t& resource_id) const
+{
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
 	{
-		value json_response = response.extract_json().get();
+		http_request request = CreateRequest(
+			methods::GET,
+			RESOURCE_PATH_SPROCS,
+			resource_id,
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *sprocs_ + resource_id);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
+	{
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::OK)
 		{
@@ -758,15 +1870,35 @@ shared_ptr<StoredProcedure> Collection::GetStoredProcedure(
 
 pplx::task<vector<shared_ptr<StoredProcedure>>> Collection::ListStoredProceduresAsync() const
 {
-	http_request request = CreateRequest(
-		methods::GET,
-		RESOURCE_PATH_SPROCS,
-		this->resource_id(),
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + sprocs_);
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+	shared_ptr<const Collection> self = shared_from_this();
+	return this->document_db_configuration()->metadata_cache()->GetAsync<vector<shared_ptr<StoredProcedure>>>(
+		this->self() + *sprocs_,
+		[self]()
+		{
+			return self->ReadStoredProceduresAsync().then([](vector<shared_ptr<StoredProcedure>> sprocs)
+			{
+				return make_shared<vector<shared_ptr<StoredProcedure>>>(move(sprocs));
+			});
+		}).then([](shared_ptr<vector<shared_ptr<StoredProcedure>>> sprocs)
+	{
+		return *sprocs;
+	});
+}
+
+pplx::task<vector<shared_ptr<StoredProcedure>>> Collection::ReadStoredProceduresAsync() const
+{
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
 	{
-		value json_response = response.extract_json().get();
+		http_request request = CreateRequest(
+			methods::GET,
+			RESOURCE_PATH_SPROCS,
+			this->resource_id(),
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *sprocs_);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
+	{
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::OK)
 		{
@@ -792,27 +1924,45 @@ vector<shared_ptr<StoredProcedure>> Collection::ListStoredProcedures() const
 	return ListStoredProceduresAsync().get();
 }
 
+pplx::task<void> Collection::ListStoredProceduresAsync(
+	const function<void(const shared_ptr<StoredProcedure>&)>& on_stored_procedure) const
+{
+	shared_ptr<const Collection> self = shared_from_this();
+	return StreamResourcesAsync(RESOURCE_PATH_SPROCS, *sprocs_, RESPONSE_QUERY_SPROCS, [self, on_stored_procedure](value&& json)
+	{
+		on_stored_procedure(self->StoredProcedureFromJson(&json));
+	});
+}
+
+void Collection::ListStoredProcedures(
+	const function<void(const shared_ptr<StoredProcedure>&)>& on_stored_procedure) const
+{
+	this->ListStoredProceduresAsync(on_stored_procedure).get();
+}
+
 pplx::task<shared_ptr<StoredProcedure>> Collection::ReplaceStoredProcedureAsync(
 	const string_t& id,
 	const string_t& new_id,
 	const string_t& body) const
 {
-	http_request request = CreateRequest(
-		methods::PUT,
-		RESOURCE_PATH_SPROCS,
-		id,
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + sprocs_ + id);
-
-	value body_;
-	body_[DOCUMENT_ID] = value::string(new_id);
-	body_[BODY] = value::string(body);
-
-	request.set_body(body_);
-
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::PUT,
+			RESOURCE_PATH_SPROCS,
+			id,
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *sprocs_ + id);
+
+		value body_;
+		body_[DOCUMENT_ID] = value::string(new_id);
+		body_[BODY] = value::string(body);
+
+		request.set_body(body_);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
 	{
-		value json_response = response.extract_json().get();
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::OK)
 		{
@@ -846,21 +1996,23 @@ void Collection::DeleteStoredProcedure(
 pplx::task<void> Collection::DeleteStoredProcedureAsync(
 	const string_t& resource_id) const
 {
-	http_request request = CreateRequest(
-		methods::DEL,
-		RESOURCE_PATH_SPROCS,
-		resource_id,
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + sprocs_ + resource_id);
-
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::DEL,
+			RESOURCE_PATH_SPROCS,
+			resource_id,
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *sprocs_ + resource_id);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
 	{
 		if (response.status_code() == status_codes::NoContent)
 		{
 			return;
 		}
 
-		value json_response = response.extract_json().get();
+		const value& json_response = response.json();
 		ThrowExceptionFromResponse(response.status_code(), json_response);
 	});
 }
@@ -872,22 +2024,25 @@ void Collection::DeleteStoredProcedure(
 }
 
 pplx::task<shared_ptr<StoredProcedureIterator>> Collection::QueryStoredProceduresAsync(
-	const string_t& query,
+	const SqlQuerySpec& query,
 	const int page_size) const
 {
-	http_request request = CreateQueryRequest(
-		query,
-		page_size,
-		RESOURCE_PATH_SPROCS,
-		this->resource_id(),
-		this->document_db_configuration()->master_key());
-	const string_t requestUri = this->self() + sprocs_;
-	request.set_request_uri(requestUri);
+	const string_t requestUri = this->self() + *sprocs_;
 
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
 	{
-		string_t continuation_id = response.headers()[HEADER_MS_CONTINUATION];
-		value json_response = response.extract_json().get();
+		http_request request = CreateQueryRequest(
+			query,
+			page_size,
+			RESOURCE_PATH_SPROCS,
+			this->resource_id(),
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(requestUri);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
+	{
+		string_t continuation_id = response.header(HEADER_MS_CONTINUATION);
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::OK)
 		{
@@ -900,7 +2055,8 @@ pplx::task<shared_ptr<StoredProcedureIterator>> Collection::QueryStoredProcedure
 				page_size,
 				requestUri,
 				continuation_id,
-				json_response.at(RESPONSE_QUERY_SPROCS));
+				response.shared_json(),
+				response.diagnostics());
 		}
 
 		ThrowExceptionFromResponse(response.status_code(), json_response);
@@ -908,64 +2064,346 @@ pplx::task<shared_ptr<StoredProcedureIterator>> Collection::QueryStoredProcedure
 }
 
 shared_ptr<StoredProcedureIterator> Collection::QueryStoredProcedures(
-	const string_t& query,
+	const SqlQuerySpec& query,
 	const int page_size) const
 {
 	return QueryStoredProceduresAsync(query, page_size).get();
 }
 
-pplx::task<void> Collection::ExecuteStoredProcedureAsync(
+pplx::task<DocumentDBResponse> Collection::SendExecuteStoredProcedureAsync(
 	const string_t& resource_id,
-	const value& input) const
+	const string_t& input,
+	const PartitionKey& partition_key) const
 {
-	http_request request = CreateRequest(
-		methods::POST,
-		RESOURCE_PATH_SPROCS,
-		resource_id,
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + sprocs_ + resource_id);
-
-	request.set_body(input);
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::POST,
+			RESOURCE_PATH_SPROCS,
+			resource_id,
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *sprocs_ + resource_id);
+		SetPartitionKey(request, partition_key);
+
+		request.set_body(input, MIME_TYPE_APPLICATION_JSON);
+		return request;
+	});
+}
 
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+pplx::task<StoredProcedureResponse> Collection::ExecuteStoredProcedureAsync(
+	const string_t& resource_id,
+	const value& input,
+	const PartitionKey& partition_key) const
+{
+	return SendExecuteStoredProcedureAsync(resource_id, input.serialize(), partition_key).then([=](const DocumentDBResponse& response)
 	{
 		if (response.status_code() == status_codes::OK)
 		{
-			return;
+			return StoredProcedureResponse(response.shared_json(), response.diagnostics());
 		}
 
-		value json_response = response.extract_json().get();
+		const value& json_response = response.json();
 		ThrowExceptionFromResponse(response.status_code(), json_response);
 	});
 }
 
-void Collection::ExecuteStoredProcedure(
+StoredProcedureResponse Collection::ExecuteStoredProcedure(
 	const string_t& resource_id,
-	const value& input) const
+	const value& input,
+	const PartitionKey& partition_key) const
 {
-	ExecuteStoredProcedureAsync(resource_id, input).get();
+	return ExecuteStoredProcedureAsync(resource_id, input, partition_key).get();
 }
 
-pplx::task<std::shared_ptr<UserDefinedFunction>> Collection::CreateUserDefinedFunctionAsync(
-	const string_t& id,
-	const string_t& body) const
+pplx::task<StoredProcedureResponse> Collection::ExecuteStoredProcedureUntilDoneAsync(
+	const string_t& resource_id,
+	const value& input,
+	const function<bool(const StoredProcedureResponse&, value&)>& next,
+	const PartitionKey& partition_key) const
+{
+	shared_ptr<const Collection> self = shared_from_this();
+	return ExecuteStoredProcedureAsync(resource_id, input, partition_key).then(
+		[self, resource_id, next, partition_key](const StoredProcedureResponse& response) -> pplx::task<StoredProcedureResponse>
+	{
+		value next_input;
+		if (!next(response, next_input))
+		{
+			return pplx::task_from_result(response);
+		}
+
+		return self->ExecuteStoredProcedureUntilDoneAsync(resource_id, next_input, next, partition_key);
+	});
+}
+
+StoredProcedureResponse Collection::ExecuteStoredProcedureUntilDone(
+	const string_t& resource_id,
+	const value& input,
+	const function<bool(const StoredProcedureResponse&, value&)>& next,
+	const PartitionKey& partition_key) const
+{
+	return ExecuteStoredProcedureUntilDoneAsync(resource_id, input, next, partition_key).get();
+}
+
+namespace
+{
+	// Creates the documents passed in order until all are created or the server
+	// stops accepting requests as the execution time limit nears, and responds
+	// with the number created. A failing create throws, which rolls back the
+	// whole call.
+	const utility::char_t* BULK_IMPORT_STORED_PROCEDURE_BODY = _XPLATSTR(
+		"function bulkImport(docs) {"
+		"  var collection = getContext().getCollection();"
+		"  var collectionLink = collection.getSelfLink();"
+		"  var count = 0;"
+		"  if (!docs || docs.length == 0) {"
+		"    getContext().getResponse().setBody(0);"
+		"    return;"
+		"  }"
+		"  tryCreate();"
+		"  function tryCreate() {"
+		"    if (!collection.createDocument(collectionLink, docs[count], onCreated)) {"
+		"      getContext().getResponse().setBody(count);"
+		"    }"
+		"  }"
+		"  function onCreated(err) {"
+		"    if (err) throw err;"
+		"    count++;"
+		"    if (count == docs.length) {"
+		"      getContext().getResponse().setBody(count);"
+		"    } else {"
+		"      tryCreate();"
+		"    }"
+		"  }"
+		"}");
+
+	// Calls in a row that did not create anything before a batch is given up
+	const int MAX_STALLED_BULK_IMPORT_CALLS = 3;
+}
+
+struct Collection::BulkImportState
+{
+	BulkImportState()
+		: next_batch(0)
+		, imported(0)
+		, failed(false)
+	{
+	}
+
+	string_t stored_procedure_id;
+	// Serialized documents of every batch, all in the partition of its key
+	vector<vector<string_t>> batches;
+	vector<PartitionKey> batch_partition_keys;
+	size_t next_batch;
+	size_t imported;
+	bool failed;
+	mutex state_mutex;
+};
+
+pplx::task<size_t> Collection::ImportDocumentsAsync(
+	const vector<value>& documents,
+	const BulkImportOptions& options) const
+{
+	if (documents.empty())
+	{
+		return pplx::task_from_result<size_t>(0);
+	}
+
+	// Sizes are in characters of the serialized documents, which is bytes for
+	// the UTF-8 strings used outside Windows. Each partition key fills its own
+	// batch, keyed by its header; there is only the empty one when the
+	// collection is not partitioned.
+	shared_ptr<BulkImportState> state = make_shared<BulkImportState>();
+	map<string_t, pair<size_t, size_t>> open_batches;
+	for (const value& document : documents)
+	{
+		PartitionKey partition_key = partition_key_.Extract(document);
+		string_t serialized = SerializeNewDocument(document);
+		size_t size = serialized.size() + 1;
+
+		auto open_batch = open_batches.find(partition_key.header());
+		if (open_batch == open_batches.end()
+			|| open_batch->second.second + size > options.max_batch_size_bytes())
+		{
+			state->batches.push_back(vector<string_t>());
+			state->batch_partition_keys.push_back(partition_key);
+			open_batches[partition_key.header()] = make_pair(state->batches.size() - 1, size_t(0));
+			open_batch = open_batches.find(partition_key.header());
+		}
+
+		state->batches[open_batch->second.first].push_back(move(serialized));
+		open_batch->second.second += size;
+	}
+
+	size_t workers = min(max<size_t>(options.max_concurrent_batches(), 1), state->batches.size());
+	shared_ptr<const Collection> self = shared_from_this();
+	return DeployBulkImportStoredProcedureAsync().then([self, state, workers](const string_t& stored_procedure_id)
+	{
+		state->stored_procedure_id = stored_procedure_id;
+
+		vector<pplx::task<void>> batch_tasks;
+		for (size_t i = 0; i < workers; i++)
+		{
+			batch_tasks.push_back(self->ImportNextBatchAsync(state));
+		}
+
+		return pplx::when_all(batch_tasks.begin(), batch_tasks.end());
+	}).then([state]()
+	{
+		return state->imported;
+	});
+}
+
+size_t Collection::ImportDocuments(
+	const vector<value>& documents,
+	const BulkImportOptions& options) const
+{
+	return ImportDocumentsAsync(documents, options).get();
+}
+
+pplx::task<string_t> Collection::DeployBulkImportStoredProcedureAsync() const
+{
+	shared_ptr<const Collection> self = shared_from_this();
+	auto find = [self]()
+	{
+		return self->QueryStoredProceduresAsync(
+			string_t(_XPLATSTR("SELECT * FROM root r WHERE r.id = '")) + BULK_IMPORT_STORED_PROCEDURE_ID + _XPLATSTR("'"))
+			.then([](shared_ptr<StoredProcedureIterator> iterator)
+		{
+			return iterator->NextAsync();
+		}).then([](shared_ptr<StoredProcedure> stored_procedure)
+		{
+			return stored_procedure ? stored_procedure->resource_id() : string_t();
+		});
+	};
+
+	return find().then([self, find](const string_t& stored_procedure_id) -> pplx::task<string_t>
+	{
+		if (!stored_procedure_id.empty())
+		{
+			return pplx::task_from_result(stored_procedure_id);
+		}
+
+		return self->CreateStoredProcedureAsync(BULK_IMPORT_STORED_PROCEDURE_ID, BULK_IMPORT_STORED_PROCEDURE_BODY)
+			.then([find](pplx::task<shared_ptr<StoredProcedure>> create_task) -> pplx::task<string_t>
+		{
+			try
+			{
+				return pplx::task_from_result(create_task.get()->resource_id());
+			}
+			catch (const ResourceAlreadyExistsException&)
+			{
+				// Deployed by a concurrent import in the meantime
+				return find();
+			}
+		});
+	});
+}
+
+pplx::task<void> Collection::ImportNextBatchAsync(
+	const shared_ptr<BulkImportState>& state) const
+{
+	size_t batch;
+	{
+		lock_guard<mutex> lock(state->state_mutex);
+		if (state->failed || state->next_batch == state->batches.size())
+		{
+			return pplx::task_from_result();
+		}
+		batch = state->next_batch++;
+	}
+
+	shared_ptr<const Collection> self = shared_from_this();
+	return ImportBatchAsync(state, batch, 0, 0).then([self, state](pplx::task<void> batch_task)
+	{
+		try
+		{
+			batch_task.get();
+		}
+		catch (...)
+		{
+			// Lets the other workers stop after their current batch
+			lock_guard<mutex> lock(state->state_mutex);
+			state->failed = true;
+			throw;
+		}
+
+		return self->ImportNextBatchAsync(state);
+	});
+}
+
+pplx::task<void> Collection::ImportBatchAsync(
+	const shared_ptr<BulkImportState>& state,
+	size_t batch,
+	size_t offset,
+	int stalled_calls) const
 {
-	http_request request = CreateRequest(
-		methods::POST,
-		RESOURCE_PATH_UDFS,
-		this->resource_id(),
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + udfs_);
+	const vector<string_t>& documents = state->batches[batch];
+	string_t input = _XPLATSTR("[[");
+	for (size_t i = offset; i < documents.size(); i++)
+	{
+		if (i != offset)
+		{
+			input += _XPLATSTR(',');
+		}
+		input += documents[i];
+	}
+	input += _XPLATSTR("]]");
 
-	value body_;
-	body_[DOCUMENT_ID] = value::string(id);
-	body_[BODY] = value::string(body);
+	shared_ptr<const Collection> self = shared_from_this();
+	return SendExecuteStoredProcedureAsync(state->stored_procedure_id, input, state->batch_partition_keys[batch])
+		.then([self, state, batch, offset, stalled_calls](const DocumentDBResponse& response) -> pplx::task<void>
+	{
+		if (response.status_code() != status_codes::OK)
+		{
+			ThrowExceptionFromResponse(response.status_code(), response.json());
+		}
+
+		size_t created = (size_t)response.json().as_integer();
+		{
+			lock_guard<mutex> lock(state->state_mutex);
+			state->imported += created;
+		}
+
+		// The procedure stops early when its execution time runs out, resume after
+		// the last document it created
+		size_t reached = offset + created;
+		if (reached >= state->batches[batch].size())
+		{
+			return pplx::task_from_result();
+		}
+
+		int stalled = created == 0 ? stalled_calls + 1 : 0;
+		if (stalled >= MAX_STALLED_BULK_IMPORT_CALLS)
+		{
+			throw DocumentDBRuntimeException(_XPLATSTR("Bulk import stored procedure does not make progress"));
+		}
 
-	request.set_body(body_);
+		return self->ImportBatchAsync(state, batch, reached, stalled);
+	});
+}
 
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+pplx::task<std::shared_ptr<UserDefinedFunction>> Collection::CreateUserDefinedFunctionAsync(
+	const string_t& id,
+	const string_t& body) const
+{
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
 	{
-		value json_response = response.extract_json().get();
+		http_request request = CreateRequest(
+			methods::POST,
+			RESOURCE_PATH_UDFS,
+			this->resource_id(),
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *udfs_);
+
+		value body_;
+		body_[DOCUMENT_ID] = value::string(id);
+		body_[BODY] = value::string(body);
+
+		request.set_body(body_);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
+	{
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::Created)
 		{
@@ -983,19 +2421,33 @@ std::shared_ptr<UserDefinedFunction> Collection::CreateUserDefinedFunction(
 	return CreateUserDefinedFunctionAsync(id, body).get();
 }
 
-pplx::task<std::shared_ptr<UserDefinedFunction>> Collection::GetUserDefinedFunctionAsync(
+pplx::task<shared_ptr<UserDefinedFunction>> Collection::GetUserDefinedFunctionAsync(
 	const string_t& resource_id) const
 {
-	http_request request = CreateRequest(
-		methods::GET,
-		RESOURCE_PATH_UDFS,
-		resource_id,
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + udfs_ + resource_id);
+	shared_ptr<const Collection> self = shared_from_this();
+	return this->document_db_configuration()->metadata_cache()->GetAsync<UserDefinedFunction>(
+		this->self() + *udfs_ + resource_id,
+		[self, resource_id]()
+		{
+			return self->ReadUserDefinedFunctionAsync(resource_id);
+		});
+}
 
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+pplx::task<std::shared_ptr<UserDefinedFunction>> Collection::ReadUserDefinedFunctionAsync(
+	const string_t& resource_id) const
+{
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::GET,
+			RESOURCE_PATH_UDFS,
+			resource_id,
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *udfs_ + resource_id);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
 	{
-		value json_response = response.extract_json().get();
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::OK)
 		{
@@ -1012,17 +2464,37 @@ std::shared_ptr<UserDefinedFunction> Collection::GetUserDefinedFunction(
 	return GetUserDefinedFunctionAsync(resource_id).get();
 }
 
-pplx::task<std::vector<std::shared_ptr<UserDefinedFunction>>> Collection::ListUserDefinedFunctionsAsync() const
+pplx::task<vector<shared_ptr<UserDefinedFunction>>> Collection::ListUserDefinedFunctionsAsync() const
 {
-	http_request request = CreateRequest(
-		methods::GET,
-		RESOURCE_PATH_UDFS,
-		this->resource_id(),
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + udfs_);
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+	shared_ptr<const Collection> self = shared_from_this();
+	return this->document_db_configuration()->metadata_cache()->GetAsync<vector<shared_ptr<UserDefinedFunction>>>(
+		this->self() + *udfs_,
+		[self]()
+		{
+			return self->ReadUserDefinedFunctionsAsync().then([](vector<shared_ptr<UserDefinedFunction>> udfs)
+			{
+				return make_shared<vector<shared_ptr<UserDefinedFunction>>>(move(udfs));
+			});
+		}).then([](shared_ptr<vector<shared_ptr<UserDefinedFunction>>> udfs)
+	{
+		return *udfs;
+	});
+}
+
+pplx::task<std::vector<std::shared_ptr<UserDefinedFunction>>> Collection::ReadUserDefinedFunctionsAsync() const
+{
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::GET,
+			RESOURCE_PATH_UDFS,
+			this->resource_id(),
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *udfs_);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
 	{
-		value json_response = response.extract_json().get();
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::OK)
 		{
@@ -1048,27 +2520,45 @@ std::vector<std::shared_ptr<UserDefinedFunction>> Collection::ListUserDefinedFun
 	return ListUserDefinedFunctionsAsync().get();
 }
 
+pplx::task<void> Collection::ListUserDefinedFunctionsAsync(
+	const function<void(const shared_ptr<UserDefinedFunction>&)>& on_user_defined_function) const
+{
+	shared_ptr<const Collection> self = shared_from_this();
+	return StreamResourcesAsync(RESOURCE_PATH_UDFS, *udfs_, RESPONSE_QUERY_UDFS, [self, on_user_defined_function](value&& json)
+	{
+		on_user_defined_function(self->UserDefinedFunctionFromJson(&json));
+	});
+}
+
+void Collection::ListUserDefinedFunctions(
+	const function<void(const shared_ptr<UserDefinedFunction>&)>& on_user_defined_function) const
+{
+	this->ListUserDefinedFunctionsAsync(on_user_defined_function).get();
+}
+
 pplx::task<std::shared_ptr<UserDefinedFunction>> Collection::ReplaceUserDefinedFunctionAsync(
 	const string_t& id,
 	const string_t& new_id,
 	const string_t& body) const
 {
-	http_request request = CreateRequest(
-		methods::PUT,
-		RESOURCE_PATH_UDFS,
-		id,
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + udfs_ + id);
-
-	value body_;
-	body_[DOCUMENT_ID] = value::string(new_id);
-	body_[BODY] = value::string(body);
-
-	request.set_body(body_);
-
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
 	{
-		value json_response = response.extract_json().get();
+		http_request request = CreateRequest(
+			methods::PUT,
+			RESOURCE_PATH_UDFS,
+			id,
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *udfs_ + id);
+
+		value body_;
+		body_[DOCUMENT_ID] = value::string(new_id);
+		body_[BODY] = value::string(body);
+
+		request.set_body(body_);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
+	{
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::OK)
 		{
@@ -1102,21 +2592,23 @@ void Collection::DeleteUserDefinedFunction(
 pplx::task<void> Collection::DeleteUserDefinedFunctionAsync(
 	const string_t& resource_id) const
 {
-	http_request request = CreateRequest(
-		methods::DEL,
-		RESOURCE_PATH_UDFS,
-		resource_id,
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + udfs_ + resource_id);
-
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::DEL,
+			RESOURCE_PATH_UDFS,
+			resource_id,
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *udfs_ + resource_id);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
 	{
 		if (response.status_code() == status_codes::NoContent)
 		{
 			return;
 		}
 
-		value json_response = response.extract_json().get();
+		const value& json_response = response.json();
 		ThrowExceptionFromResponse(response.status_code(), json_response);
 	});
 }
@@ -1128,22 +2620,25 @@ void Collection::DeleteUserDefinedFunction(
 }
 
 pplx::task<std::shared_ptr<UserDefinedFunctionIterator>> Collection::QueryUserDefinedFunctionsAsync(
-	const string_t& query,
+	const SqlQuerySpec& query,
 	const int page_size) const
 {
-	http_request request = CreateQueryRequest(
-		query,
-		page_size,
-		RESOURCE_PATH_UDFS,
-		this->resource_id(),
-		this->document_db_configuration()->master_key());
-	const string_t requestUri = this->self() + udfs_;
-	request.set_request_uri(requestUri);
+	const string_t requestUri = this->self() + *udfs_;
 
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateQueryRequest(
+			query,
+			page_size,
+			RESOURCE_PATH_UDFS,
+			this->resource_id(),
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(requestUri);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
 	{
-		string_t continuation_id = response.headers()[HEADER_MS_CONTINUATION];
-		value json_response = response.extract_json().get();
+		string_t continuation_id = response.header(HEADER_MS_CONTINUATION);
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::OK)
 		{
@@ -1156,7 +2651,8 @@ pplx::task<std::shared_ptr<UserDefinedFunctionIterator>> Collection::QueryUserDe
 				page_size,
 				requestUri,
 				continuation_id,
-				json_response.at(RESPONSE_QUERY_UDFS));
+				response.shared_json(),
+				response.diagnostics());
 		}
 
 		ThrowExceptionFromResponse(response.status_code(), json_response);
@@ -1164,7 +2660,7 @@ pplx::task<std::shared_ptr<UserDefinedFunctionIterator>> Collection::QueryUserDe
 }
 
 std::shared_ptr<UserDefinedFunctionIterator> Collection::QueryUserDefinedFunctions(
-	const string_t& query,
+	const SqlQuerySpec& query,
 	const int page_size) const
 {
 	return QueryUserDefinedFunctionsAsync(query, page_size).get();
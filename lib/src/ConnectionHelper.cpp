@@ -30,14 +30,23 @@
 #endif
 
 #include <stdlib.h>
+#include <algorithm>
+#include <chrono>
 #include <locale>
 #include <codecvt>
+#include <mutex>
+#include <random>
 #include <time.h>
 
+#ifndef _WIN32
+#include <boost/asio.hpp>
+#endif
+
 #include <cpprest/json.h>
+#include <pplx/threadpool.h>
 
-#include "hmac_bcrypt.h"
 #include "DocumentDBConstants.h"
+#include "JsonArrayReader.h"
 
 using namespace documentdb;
 using namespace std;
@@ -58,7 +67,7 @@ string_t GetCurrentRequestTime()
 {
 	time_t t;
 	struct tm tm;
-	char* buf = new char[RFC1123_TIME_LEN+1];
+	char buf[RFC1123_TIME_LEN+1];
 
 	time(&t);
 #ifdef _WIN32
@@ -78,7 +87,6 @@ string_t GetCurrentRequestTime()
 #else
 	string_t timeAsString = string_t(buf);
 #endif
-	delete[] buf;
 	return timeAsString;
 }
 
@@ -86,37 +94,18 @@ http_request CreateRequest(
 	const method& method,
 	const string_t& resource_type,
 	const string_t& resource_id,
-	const vector<unsigned char>& master_key)
+	const RequestSigner& request_signer,
+	bool name_based_link)
 {
 	string_t requestTime = GetCurrentRequestTime();
 
-	string_t text = method + _XPLATSTR("\n") + resource_type + _XPLATSTR("\n") + resource_id + _XPLATSTR("\n") + requestTime + _XPLATSTR("\n\n");
-	string_t textLowerCase(text);
-	transform(text.begin(), text.end(), textLowerCase.begin(), ::tolower);
-
-	unsigned char buffer[1000];
-#ifdef _UTF16_STRINGS
-	wcstombs_s(nullptr, (char*)buffer, 1000, textLowerCase.c_str(), textLowerCase.size());
-#else
-	strcpy((char*)buffer, textLowerCase.c_str());
-#endif
-	int hashSize = 0;
-	unsigned char* result = hmac((unsigned char*)&master_key[0], master_key.size(), buffer, strlen((const char*)buffer), &hashSize);
-
-	utility::string_t signature = utility::conversions::to_base64(vector<unsigned char>(result, result + hashSize));
-#ifdef _WIN32
-	HeapFree(GetProcessHeap(), 0, result);
-#else
-	delete[] result;
-#endif
-
 	http_request request(method);
 	request.headers().add(web::http::header_names::accept, MIME_TYPE_APPLICATION_JSON);
 	request.headers().add(web::http::header_names::user_agent, _XPLATSTR("cpprestsdk/2.4.0.1"));
 	//request.headers ().add (web::http::header_names::cache_control, _XPLATSTR("no-cache"));
 	request.headers().add(
 		web::http::header_names::authorization,
-		uri::encode_data_string(_XPLATSTR("type=master&ver=1.0&sig=") + signature));
+		request_signer.Authorization(method, resource_type, resource_id, requestTime, name_based_link));
 	request.headers().add(HEADER_MS_DATE, requestTime);
 	request.headers().add(HEADER_MS_VERSION, _XPLATSTR("2017-02-22"));
 
@@ -124,15 +113,17 @@ http_request CreateRequest(
 }
 
 http_request CreateQueryRequest(
-	const string_t& query,
+	const SqlQuerySpec& query,
 	const int page_size,
 	const string_t& resource_type,
 	const string_t& resource_id,
-	const vector<unsigned char>& master_key,
-	const string_t& continuation_id)
+	const RequestSigner& request_signer,
+	const string_t& continuation_id,
+	bool name_based_link,
+	bool enable_cross_partition)
 {
-	http_request request = CreateRequest(methods::POST, resource_type, resource_id, master_key);
-	request.headers().add(web::http::header_names::content_type, MIME_TYPE_APPLICATION_SQL);
+	http_request request = CreateRequest(methods::POST, resource_type, resource_id, request_signer, name_based_link);
+	request.headers().add(web::http::header_names::content_type, query.content_type());
 	request.headers().add(HEADER_MS_DOCUMENTDB_IS_QUERY, true);
 	request.headers().add(HEADER_MS_MAX_ITEM_COUNT, page_size);
 
@@ -141,11 +132,471 @@ http_request CreateQueryRequest(
 		request.headers().add(HEADER_MS_CONTINUATION, continuation_id);
 	}
 
-	request.set_body(query);
+	if (enable_cross_partition)
+	{
+		request.headers().add(HEADER_MS_DOCUMENTDB_QUERY_ENABLECROSSPARTITION, _XPLATSTR("true"));
+	}
+
+	request.set_body(query.body(), query.content_type());
 
 	return request;
 }
 
+void SetPartitionKey(
+	http_request& request,
+	const PartitionKey& partition_key)
+{
+	if (!partition_key.empty())
+	{
+		request.headers().add(HEADER_MS_DOCUMENTDB_PARTITIONKEY, partition_key.header());
+	}
+}
+
+namespace
+{
+	typedef chrono::steady_clock clock;
+
+	chrono::microseconds MicrosecondsSince(
+		const clock::time_point& start)
+	{
+		return chrono::duration_cast<chrono::microseconds>(clock::now() - start);
+	}
+
+	// Completes with the response headers. A slot of the limiter, if any, is held
+	// until the response body has been read.
+	pplx::task<http_response> SendRequestAsync(
+		http_client client,
+		const shared_ptr<RequestLimiter>& limiter,
+		const http_request& request)
+	{
+		if (limiter->limit() == 0)
+		{
+			return client.request(request);
+		}
+
+		return limiter->AcquireAsync().then([=]() mutable
+		{
+			return client.request(request);
+		}).then([=](pplx::task<http_response> response_task)
+		{
+			try
+			{
+				http_response response = response_task.get();
+				response.content_ready().then([=](pplx::task<http_response> ready_task)
+				{
+					limiter->Release();
+					try
+					{
+						ready_task.wait();
+					}
+					catch (...)
+					{
+						// Observed by whoever reads the body
+					}
+				});
+				return response;
+			}
+			catch (...)
+			{
+				limiter->Release();
+				throw;
+			}
+		});
+	}
+
+#ifdef _WIN32
+	VOID CALLBACK OnDelayElapsed(
+		PTP_CALLBACK_INSTANCE,
+		PVOID context,
+		PTP_TIMER timer)
+	{
+		unique_ptr<pplx::task_completion_event<void>> elapsed(
+			static_cast<pplx::task_completion_event<void>*>(context));
+		// The timer is released once this callback returns
+		CloseThreadpoolTimer(timer);
+		elapsed->set();
+	}
+#endif
+}
+
+// Completes after the delay without holding a thread while waiting.
+pplx::task<void> DelayAsync(
+	const chrono::milliseconds& delay)
+{
+	pplx::task_completion_event<void> elapsed;
+
+#ifdef _WIN32
+	unique_ptr<pplx::task_completion_event<void>> context(new pplx::task_completion_event<void>(elapsed));
+	PTP_TIMER timer = CreateThreadpoolTimer(OnDelayElapsed, context.get(), nullptr);
+	if (timer == nullptr)
+	{
+		throw DocumentDBRuntimeException(_XPLATSTR("CreateThreadpoolTimer failed"));
+	}
+	context.release();
+
+	// Negative due time is relative, in 100 nanosecond units
+	ULARGE_INTEGER due_time;
+	due_time.QuadPart = static_cast<ULONGLONG>(-static_cast<LONGLONG>(delay.count()) * 10000);
+	FILETIME file_time;
+	file_time.dwLowDateTime = due_time.LowPart;
+	file_time.dwHighDateTime = due_time.HighPart;
+	SetThreadpoolTimer(timer, &file_time, 0, 0);
+#else
+	shared_ptr<boost::asio::deadline_timer> timer = make_shared<boost::asio::deadline_timer>(
+		crossplat::threadpool::shared_instance().service(),
+		boost::posix_time::milliseconds(delay.count()));
+	timer->async_wait([timer, elapsed](const boost::system::error_code&)
+	{
+		elapsed.set();
+	});
+#endif
+
+	return pplx::task<void>(elapsed);
+}
+
+// Uniform in [0, backoff] where backoff doubles with every attempt.
+chrono::milliseconds JitteredBackoff(
+	const RetryOptions& options,
+	int attempt)
+{
+	static mutex random_mutex;
+	static default_random_engine random_engine((unsigned int)time(nullptr));
+
+	long long backoff = options.initial_backoff().count();
+	for (int i = 0; i < attempt && backoff < options.max_backoff().count(); i++)
+	{
+		backoff *= 2;
+	}
+	backoff = min(backoff, (long long)options.max_backoff().count());
+
+	lock_guard<mutex> lock(random_mutex);
+	return chrono::milliseconds(uniform_int_distribution<long long>(0, backoff)(random_engine));
+}
+
+namespace
+{
+	struct RetryContext
+	{
+		http_client client;
+		shared_ptr<RequestLimiter> limiter;
+		shared_ptr<RetryBudget> retry_budget;
+		shared_ptr<MetadataCache> metadata_cache;
+		RetryOptions options;
+		function<http_request()> create_request;
+		ResponseBodyReader read_body;
+		function<void(const ResponseDiagnostics&)> diagnostics_handler;
+		bool safe_to_resend;
+		int throttled_attempts;
+		int transient_attempts;
+		chrono::milliseconds throttled_wait_time;
+		clock::time_point start_time;
+		ResponseDiagnostics diagnostics;
+
+		RetryContext(
+			const DocumentDBConfiguration& document_db_configuration,
+			const function<http_request()>& create_request,
+			const ResponseBodyReader& read_body)
+			: client(document_db_configuration.http_client())
+			, limiter(document_db_configuration.request_limiter())
+			, retry_budget(document_db_configuration.retry_budget())
+			, metadata_cache(document_db_configuration.metadata_cache())
+			, options(document_db_configuration.connection_policy().retry_options())
+			, create_request(create_request)
+			, read_body(read_body)
+			, diagnostics_handler(document_db_configuration.diagnostics_handler())
+			, safe_to_resend(false)
+			, throttled_attempts(0)
+			, transient_attempts(0)
+			, throttled_wait_time(0)
+			, start_time(clock::now())
+		{
+		}
+	};
+
+	bool ShouldRetryTransient(
+		RetryContext& context,
+		chrono::milliseconds& delay)
+	{
+		if (context.transient_attempts >= context.options.max_retry_attempts_on_transient_errors()
+			|| !context.retry_budget->TryAcquire())
+		{
+			return false;
+		}
+
+		delay = JitteredBackoff(context.options, context.transient_attempts++);
+		return true;
+	}
+
+	bool ShouldRetryThrottled(
+		RetryContext& context,
+		const http_response& response,
+		chrono::milliseconds& delay)
+	{
+		delay = context.options.initial_backoff();
+		http_headers::const_iterator retry_after = response.headers().find(HEADER_MS_RETRY_AFTER_MS);
+		if (retry_after != response.headers().end())
+		{
+			delay = chrono::milliseconds(utility::conversions::scan_string<long long>(retry_after->second));
+		}
+
+		if (context.throttled_attempts >= context.options.max_retry_attempts_on_throttled_requests()
+			|| context.throttled_wait_time + delay > context.options.max_retry_wait_time()
+			|| !context.retry_budget->TryAcquire())
+		{
+			return false;
+		}
+
+		context.throttled_attempts++;
+		context.throttled_wait_time += delay;
+		return true;
+	}
+
+	// Completes the diagnostics of the final response and reports them.
+	// Drops the cached metadata the final response of a request shows to be
+	// out of date.
+	void InvalidateMetadata(
+		MetadataCache& metadata_cache,
+		const ResponseDiagnostics& diagnostics,
+		const http_response& response)
+	{
+		const status_code status = response.status_code();
+		const string_t link = diagnostics.resource_link();
+
+		if (status == status_codes::NotFound || status == status_codes::Gone)
+		{
+			// The collection or database the request went through may be gone too
+			http_headers::const_iterator substatus = response.headers().find(HEADER_MS_SUBSTATUS);
+			bool owner_gone = status == status_codes::Gone
+				|| (substatus != response.headers().end() && substatus->second == SUBSTATUS_OWNER_RESOURCE_NOT_FOUND);
+			metadata_cache.Invalidate(link, owner_gone);
+		}
+		else if (status == status_codes::Created)
+		{
+			// Lists the resource was created in
+			metadata_cache.Invalidate(link);
+		}
+		else if (status >= 200 && status < 300
+			&& (diagnostics.method() == methods::PUT || diagnostics.method() == methods::DEL))
+		{
+			metadata_cache.Invalidate(link);
+
+			size_t end = link.find_last_not_of(_XPLATSTR('/'));
+			size_t parent = end == string_t::npos ? string_t::npos : link.find_last_of(_XPLATSTR('/'), end);
+			if (parent != string_t::npos)
+			{
+				metadata_cache.Invalidate(link.substr(0, parent));
+			}
+		}
+	}
+
+	DocumentDBResponse CompleteResponse(
+		const shared_ptr<RetryContext>& context,
+		const http_response& response,
+		const shared_ptr<const value>& json)
+	{
+		ResponseDiagnostics& diagnostics = context->diagnostics;
+		diagnostics.set_status_code(response.status_code());
+		diagnostics.set_response_size(response.headers().content_length());
+		diagnostics.set_retry_count(context->throttled_attempts + context->transient_attempts);
+		diagnostics.set_throttled_retry_count(context->throttled_attempts);
+		const http_headers& headers = response.headers();
+		http_headers::const_iterator header = headers.find(HEADER_MS_REQUEST_CHARGE);
+		if (header != headers.end())
+		{
+			diagnostics.set_request_charge(utility::conversions::scan_string<double>(header->second));
+		}
+		header = headers.find(HEADER_MS_ACTIVITY_ID);
+		if (header != headers.end())
+		{
+			diagnostics.set_activity_id(header->second);
+		}
+		header = headers.find(HEADER_MS_SESSION_TOKEN);
+		if (header != headers.end())
+		{
+			diagnostics.set_session_token(header->second);
+		}
+		header = headers.find(HEADER_MS_RESOURCE_USAGE);
+		if (header != headers.end())
+		{
+			diagnostics.set_resource_usage(header->second);
+		}
+		diagnostics.set_total_time(MicrosecondsSince(context->start_time));
+
+		if (context->metadata_cache->ttl().count() != 0)
+		{
+			InvalidateMetadata(*context->metadata_cache, diagnostics, response);
+		}
+
+		if (context->diagnostics_handler)
+		{
+			context->diagnostics_handler(diagnostics);
+		}
+
+		return DocumentDBResponse(response, json, diagnostics);
+	}
+
+	// Reads and parses the body of the final response and reports its diagnostics.
+	pplx::task<DocumentDBResponse> ReadResponseAsync(
+		const shared_ptr<RetryContext>& context,
+		const http_response& response)
+	{
+		clock::time_point receive_start = clock::now();
+		if (context->read_body && response.status_code() >= 200 && response.status_code() < 300)
+		{
+			// Parsed while received, the time spent is all receive time
+			return context->read_body(response).then([context, response, receive_start](shared_ptr<const value> json)
+			{
+				context->diagnostics.set_receive_time(MicrosecondsSince(receive_start));
+				return CompleteResponse(context, response, json);
+			});
+		}
+
+		return response.content_ready().then([context, receive_start](http_response response)
+		{
+			ResponseDiagnostics& diagnostics = context->diagnostics;
+			diagnostics.set_receive_time(MicrosecondsSince(receive_start));
+
+			clock::time_point parse_start = clock::now();
+			shared_ptr<value> json = make_shared<value>();
+			if (response.status_code() != status_codes::NoContent
+				&& response.status_code() != status_codes::NotModified)
+			{
+				*json = response.extract_json().get();
+			}
+			diagnostics.set_parse_time(MicrosecondsSince(parse_start));
+
+			return CompleteResponse(context, response, json);
+		});
+	}
+
+	pplx::task<shared_ptr<const value>> ReadJsonArrayChunksAsync(
+		const concurrency::streams::istream& body,
+		const shared_ptr<JsonArrayReader>& reader,
+		const shared_ptr<vector<uint8_t>>& chunk)
+	{
+		return body.streambuf().getn(chunk->data(), chunk->size()).then([body, reader, chunk](size_t read)
+		{
+			if (read == 0)
+			{
+				return pplx::task_from_result<shared_ptr<const value>>(make_shared<const value>(reader->Finish()));
+			}
+
+			reader->Read(reinterpret_cast<const char*>(chunk->data()), read);
+			return ReadJsonArrayChunksAsync(body, reader, chunk);
+		});
+	}
+
+	pplx::task<DocumentDBResponse> ExecuteAttemptAsync(
+		const shared_ptr<RetryContext>& context)
+	{
+		// The request is created anew for every attempt, a sent request cannot be resent
+		clock::time_point signing_start = clock::now();
+		http_request request = context->create_request();
+		context->diagnostics.set_signing_time(MicrosecondsSince(signing_start));
+		context->diagnostics.set_method(request.method());
+		context->diagnostics.set_resource_link(request.request_uri().path());
+		context->safe_to_resend = IsSafeToResend(request);
+
+		clock::time_point send_start = clock::now();
+		return SendRequestAsync(context->client, context->limiter, request)
+			.then([context, send_start](pplx::task<http_response> response_task) -> pplx::task<DocumentDBResponse>
+		{
+			chrono::milliseconds delay;
+			try
+			{
+				http_response response = response_task.get();
+				context->diagnostics.set_time_to_first_byte(MicrosecondsSince(send_start));
+				status_code status = response.status_code();
+
+				bool retry = false;
+				if (status == STATUS_CODE_TOO_MANY_REQUESTS)
+				{
+					retry = ShouldRetryThrottled(*context, response, delay);
+				}
+				else if (status == STATUS_CODE_RETRY_WITH || status == status_codes::ServiceUnavailable)
+				{
+					retry = ShouldRetryTransient(*context, delay);
+				}
+				else if (context->throttled_attempts == 0 && context->transient_attempts == 0)
+				{
+					context->retry_budget->OnSuccess();
+				}
+
+				if (!retry)
+				{
+					return ReadResponseAsync(context, response);
+				}
+			}
+			catch (const http_exception&)
+			{
+				// The request may have been carried out before the connection
+				// dropped
+				if (!context->safe_to_resend || !ShouldRetryTransient(*context, delay))
+				{
+					throw;
+				}
+			}
+
+			return DelayAsync(delay).then([context]()
+			{
+				return ExecuteAttemptAsync(context);
+			});
+		});
+	}
+}
+
+bool IsSafeToResend(
+	const http_request& request)
+{
+	const method& verb = request.method();
+	if (verb == methods::GET || verb == methods::HEAD || verb == methods::PUT || verb == methods::DEL)
+	{
+		return true;
+	}
+
+	return verb == methods::POST &&
+		(request.headers().has(HEADER_MS_DOCUMENTDB_IS_QUERY) || request.headers().has(HEADER_MS_DOCUMENTDB_IS_UPSERT));
+}
+
+pplx::task<DocumentDBResponse> ExecuteRequestAsync(
+	const DocumentDBConfiguration& document_db_configuration,
+	const function<http_request()>& create_request)
+{
+	return ExecuteRequestAsync(document_db_configuration, create_request, ResponseBodyReader());
+}
+
+pplx::task<DocumentDBResponse> ExecuteRequestAsync(
+	const DocumentDBConfiguration& document_db_configuration,
+	const function<http_request()>& create_request,
+	const ResponseBodyReader& read_body)
+{
+	// The continuations may outlive the configuration, so the context holds its
+	// own copy of the client and references to the shared limiter and budget.
+	return ExecuteAttemptAsync(make_shared<RetryContext>(document_db_configuration, create_request, read_body));
+}
+
+pplx::task<shared_ptr<const value>> ReadJsonArrayAsync(
+	const http_response& response,
+	const string_t& array_field,
+	const function<void(value&&)>& on_item)
+{
+	return ReadJsonArrayChunksAsync(
+		response.body(),
+		make_shared<JsonArrayReader>(array_field, on_item),
+		make_shared<vector<uint8_t>>(64 * 1024));
+}
+
+pplx::task<shared_ptr<const value>> ReadJsonArrayTextAsync(
+	const http_response& response,
+	const string_t& array_field,
+	const function<void(const std::string&)>& on_item_text)
+{
+	return ReadJsonArrayChunksAsync(
+		response.body(),
+		JsonArrayReader::TextReader(array_field, on_item_text),
+		make_shared<vector<uint8_t>>(64 * 1024));
+}
+
 __declspec(noreturn)
 void ThrowExceptionFromResponse(
 const status_code& status_code,
@@ -174,6 +625,14 @@ const value& json_response)
 	{
 		throw DocumentTooLargeException(status_code, code, message);
 	}
+	else if (status_code == status_codes::PreconditionFailed)
+	{
+		throw PreconditionFailedException(status_code, code, message);
+	}
+	else if (status_code == STATUS_CODE_TOO_MANY_REQUESTS)
+	{
+		throw RequestRateTooLargeException(status_code, code, message);
+	}
 	else
 	{
 		throw DocumentDBResponseException(status_code, code, message);
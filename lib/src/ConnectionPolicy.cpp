@@ -0,0 +1,154 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#include "ConnectionPolicy.h"
+
+#ifndef _WIN32
+#include <atomic>
+#include <memory>
+
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#endif
+
+using namespace documentdb;
+using namespace std;
+using namespace utility;
+using namespace web::http::client;
+
+#ifndef _WIN32
+namespace
+{
+	// cpprest hands out the socket of a new connection before resolving and
+	// connecting it. Opening it here, with the address family of the account
+	// host, lets the options be set before the first request is sent; cpprest
+	// connects a socket that is already open as it is. The family is resolved
+	// once and shared by every connection of the configuration.
+	boost::system::error_code OpenSocket(
+		boost::asio::ip::tcp::socket& socket,
+		const string& host,
+		const string& port,
+		atomic<int>& family)
+	{
+		boost::system::error_code error;
+		if (family == 0)
+		{
+			boost::asio::io_service service;
+			boost::asio::ip::tcp::resolver resolver(service);
+			boost::asio::ip::tcp::resolver::iterator endpoints = resolver.resolve(
+				boost::asio::ip::tcp::resolver::query(host, port),
+				error);
+			if (error)
+			{
+				return error;
+			}
+			if (endpoints == boost::asio::ip::tcp::resolver::iterator())
+			{
+				return boost::asio::error::host_not_found;
+			}
+
+			family = endpoints->endpoint().protocol().family();
+		}
+
+		socket.open(
+			family == boost::asio::ip::tcp::v6().family() ? boost::asio::ip::tcp::v6() : boost::asio::ip::tcp::v4(),
+			error);
+		return error;
+	}
+}
+#endif
+
+ConnectionPolicy::ConnectionPolicy()
+	: max_connections_(0)
+	, request_timeout_(30)
+	, tcp_no_delay_(true)
+	, keep_alive_(true)
+	, query_prefetch_pages_(0)
+	, query_prefetch_max_bytes_(4 * 1024 * 1024)
+	, metadata_cache_ttl_(0)
+{
+}
+
+ConnectionPolicy::~ConnectionPolicy()
+{
+}
+
+#ifndef _WIN32
+boost::system::error_code ConnectionPolicy::ApplySocketOptions(
+	boost::asio::ip::tcp::socket& socket) const
+{
+	if (!socket.is_open())
+	{
+		return boost::asio::error::bad_descriptor;
+	}
+
+	boost::system::error_code no_delay_error;
+	socket.set_option(boost::asio::ip::tcp::no_delay(tcp_no_delay_), no_delay_error);
+	boost::system::error_code keep_alive_error;
+	socket.set_option(boost::asio::socket_base::keep_alive(keep_alive_), keep_alive_error);
+	return no_delay_error ? no_delay_error : keep_alive_error;
+}
+#endif
+
+http_client_config ConnectionPolicy::ToHttpClientConfig(
+	const string_t& url_connection) const
+{
+	http_client_config config;
+	config.set_timeout(request_timeout_);
+
+#ifndef _WIN32
+	// With Boost.Asio the native handle is the socket for http and the ssl stream
+	// on top of it for https. WinHTTP does not expose the socket, so there is
+	// nothing to set on Windows.
+	// Socket options are an optimization only, so failing to set them does not
+	// fail the request; they are reported to the socket error handler instead.
+	const web::uri uri(url_connection);
+	const bool is_https = uri.scheme() == _XPLATSTR("https");
+	const string host = conversions::to_utf8string(uri.host());
+	const string port = uri.port() > 0 ? std::to_string(uri.port()) : (is_https ? "443" : "80");
+	const shared_ptr<atomic<int>> family = make_shared<atomic<int>>(0);
+	const ConnectionPolicy policy = *this;
+	config.set_nativehandle_options([=](native_handle handle)
+	{
+		boost::asio::ip::tcp::socket& socket = is_https
+			? static_cast<boost::asio::ssl::stream<boost::asio::ip::tcp::socket&>*>(handle)->next_layer()
+			: *static_cast<boost::asio::ip::tcp::socket*>(handle);
+		boost::system::error_code error;
+		if (!socket.is_open())
+		{
+			error = OpenSocket(socket, host, port, *family);
+		}
+		if (!error)
+		{
+			error = policy.ApplySocketOptions(socket);
+		}
+		if (error && policy.socket_error_handler())
+		{
+			policy.socket_error_handler()(error);
+		}
+	});
+#endif
+
+	return config;
+}
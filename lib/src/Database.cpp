@@ -30,6 +30,7 @@
 #include "ConnectionHelper.h"
 #include "DocumentDBConstants.h"
 #include "IndexingPolicy.h"
+#include "PartitionKeyDefinition.h"
 #include "exceptions.h"
 
 using namespace documentdb;
@@ -49,8 +50,8 @@ Database::Database(
 		const string_t& colls,
 		const string_t& users)
 	: DocumentDBEntity(document_db_configuration, id, resource_id, ts, self, etag)
-	, colls_(colls)
-	, users_(users)
+	, colls_(ShareLink(colls))
+	, users_(ShareLink(users))
 {
 	// TODO: deal with users, triggers, sprocs...
 }
@@ -60,6 +61,20 @@ Database::~Database()
 {
 }
 
+shared_ptr<Database> Database::WithDiagnosticsHandler(
+	const function<void(const ResponseDiagnostics&)>& diagnostics_handler) const
+{
+	return make_shared<Database>(
+		document_db_configuration()->WithDiagnosticsHandler(diagnostics_handler),
+		id(),
+		resource_id(),
+		ts(),
+		self(),
+		etag(),
+		*colls_,
+		*users_);
+}
+
 shared_ptr<Collection> Database::CollectionFromJson(
 	const value* json_collection) const
 {
@@ -81,6 +96,12 @@ shared_ptr<Collection> Database::CollectionFromJson(
 		indexing_policy = IndexingPolicy::FromJson(indexing_policy_json);
 	}
 
+	PartitionKeyDefinition partition_key;
+	if (json_collection->has_field(RESPONSE_PARTITION_KEY))
+	{
+		partition_key = PartitionKeyDefinition::FromJson(json_collection->at(RESPONSE_PARTITION_KEY));
+	}
+
 	return make_shared<Collection>(
 		this->document_db_configuration(),
 		id,
@@ -93,7 +114,8 @@ shared_ptr<Collection> Database::CollectionFromJson(
 		triggers,
 		udfs,
 		conflicts,
-		indexing_policy);
+		indexing_policy,
+		partition_key);
 }
 
 shared_ptr<User> Database::UserFromJson(
@@ -126,20 +148,44 @@ shared_ptr<User> Database::UserFromJson(
 pplx::task<shared_ptr<Collection>> Database::CreateCollectionAsync(
 	const string_t& id) const
 {
-	http_request request = CreateRequest(
-		methods::POST,
-		RESOURCE_PATH_COLLS,
-		this->resource_id(),
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + colls_);
+	return CreateCollectionAsync(id, PartitionKeyDefinition());
+}
+
+shared_ptr<Collection> Database::CreateCollection(
+	const string_t& id) const
+{
+	return this->CreateCollectionAsync(id).get();
+}
 
-	value body;
-	body[DOCUMENT_ID] = value::string(id);
-	request.set_body(body);
+pplx::task<shared_ptr<Collection>> Database::CreateCollectionAsync(
+	const string_t& id,
+	const PartitionKeyDefinition& partition_key,
+	int offer_throughput) const
+{
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::POST,
+			RESOURCE_PATH_COLLS,
+			this->resource_id(),
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *colls_);
+		if (offer_throughput > 0)
+		{
+			request.headers().add(HEADER_MS_OFFER_THROUGHPUT, offer_throughput);
+		}
 
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+		value body;
+		body[DOCUMENT_ID] = value::string(id);
+		if (!partition_key.empty())
+		{
+			body[RESPONSE_PARTITION_KEY] = partition_key.ToJson();
+		}
+		request.set_body(body);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
 	{
-		value json_response = response.extract_json().get();
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::Created)
 		{
@@ -151,9 +197,11 @@ pplx::task<shared_ptr<Collection>> Database::CreateCollectionAsync(
 }
 
 shared_ptr<Collection> Database::CreateCollection(
-	const string_t& id) const
+	const string_t& id,
+	const PartitionKeyDefinition& partition_key,
+	int offer_throughput) const
 {
-	return this->CreateCollectionAsync(id).get();
+	return this->CreateCollectionAsync(id, partition_key, offer_throughput).get();
 }
 
 pplx::task<void> Database::DeleteCollectionAsync(
@@ -171,21 +219,23 @@ void Database::DeleteCollection(
 pplx::task<void> Database::DeleteCollectionAsync(
 	const string_t& resource_id) const
 {
-	http_request request = CreateRequest(
-		methods::DEL,
-		RESOURCE_PATH_COLLS,
-		resource_id,
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + colls_ + resource_id);
-
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::DEL,
+			RESOURCE_PATH_COLLS,
+			resource_id,
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *colls_ + resource_id);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
 	{
 		if (response.status_code() == status_codes::NoContent)
 		{
 			return;
 		}
 
-		value json_response = response.extract_json().get();
+		const value& json_response = response.json();
 		ThrowExceptionFromResponse(response.status_code(), json_response);
 	});
 }
@@ -199,16 +249,78 @@ void Database::DeleteCollection(
 pplx::task<shared_ptr<Collection>> Database::GetCollectionAsync(
 	const string_t& resource_id) const
 {
-	http_request request = CreateRequest(
-		methods::GET,
-		RESOURCE_PATH_COLLS,
-		resource_id,
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + colls_ + resource_id);
+	// A copy, the cache may read the collection again after this one is gone
+	shared_ptr<const Database> self = make_shared<Database>(*this);
+	return this->document_db_configuration()->metadata_cache()->GetAsync<Collection>(
+		this->self() + *colls_ + resource_id,
+		[self, resource_id]()
+		{
+			return self->ReadCollectionAsync(resource_id);
+		});
+}
 
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+pplx::task<shared_ptr<Collection>> Database::GetCollectionByIdAsync(
+	const string_t& id) const
+{
+	shared_ptr<const Database> self = make_shared<Database>(*this);
+	const string_t separator = _XPLATSTR("/");
+	const string_t link = RESOURCE_PATH_DBS + separator + this->id() + separator + RESOURCE_PATH_COLLS + separator + id;
+	const string_t uri = RESOURCE_PATH_DBS + separator + web::uri::encode_data_string(this->id())
+		+ separator + RESOURCE_PATH_COLLS + separator + web::uri::encode_data_string(id);
+
+	return this->document_db_configuration()->metadata_cache()->GetAsync<Collection>(
+		uri,
+		[self, link, uri]()
+		{
+			return ExecuteRequestAsync(*self->document_db_configuration(), [=]()
+			{
+				http_request request = CreateRequest(
+					methods::GET,
+					RESOURCE_PATH_COLLS,
+					link,
+					self->document_db_configuration()->request_signer(),
+					true);
+				request.set_request_uri(uri);
+				return request;
+			}).then([self](const DocumentDBResponse& response)
+			{
+				const value& json_response = response.json();
+
+				if (response.status_code() == status_codes::OK)
+				{
+					return self->CollectionFromJson(&json_response);
+				}
+
+				ThrowExceptionFromResponse(response.status_code(), json_response);
+			});
+		},
+		[](const Collection& collection)
+		{
+			return collection.self();
+		});
+}
+
+shared_ptr<Collection> Database::GetCollectionById(
+	const string_t& id) const
+{
+	return this->GetCollectionByIdAsync(id).get();
+}
+
+pplx::task<shared_ptr<Collection>> Database::ReadCollectionAsync(
+	const string_t& resource_id) const
+{
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
 	{
-		value json_response = response.extract_json().get();
+		http_request request = CreateRequest(
+			methods::GET,
+			RESOURCE_PATH_COLLS,
+			resource_id,
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *colls_ + resource_id);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
+	{
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::OK)
 		{
@@ -227,15 +339,18 @@ shared_ptr<Collection> Database::GetCollection(
 
 pplx::task<vector<shared_ptr<Collection>>> Database::ListCollectionsAsync() const
 {
-	http_request request = CreateRequest(
-		methods::GET,
-		RESOURCE_PATH_COLLS,
-		this->resource_id(),
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + colls_);
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::GET,
+			RESOURCE_PATH_COLLS,
+			this->resource_id(),
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *colls_);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
 	{
-		value json_response = response.extract_json().get();
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::OK)
 		{
@@ -264,20 +379,22 @@ vector<shared_ptr<Collection>> Database::ListCollections() const
 pplx::task<shared_ptr<User>> Database::CreateUserAsync(
 	const string_t& id) const
 {
-	http_request request = CreateRequest(
-		methods::POST,
-		RESOURCE_PATH_USERS,
-		this->resource_id(),
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + users_);
-
-	value body;
-	body[DOCUMENT_ID] = value::string(id);
-	request.set_body(body);
-
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
 	{
-		value json_response = response.extract_json().get();
+		http_request request = CreateRequest(
+			methods::POST,
+			RESOURCE_PATH_USERS,
+			this->resource_id(),
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *users_);
+
+		value body;
+		body[DOCUMENT_ID] = value::string(id);
+		request.set_body(body);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
+	{
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::Created)
 		{
@@ -298,20 +415,22 @@ shared_ptr<User> Database::CreateUser(
 pplx::task<void> Database::DeleteUserAsync(
 	const string_t& resource_id) const
 {
-	http_request request = CreateRequest(
-		methods::DEL,
-		RESOURCE_PATH_USERS,
-		resource_id,
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + users_ + resource_id);
-
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::DEL,
+			RESOURCE_PATH_USERS,
+			resource_id,
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *users_ + resource_id);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
 	{
 		if (response.status_code() == status_codes::NoContent)
 		{
 			return;
 		}
-		value json_response = response.extract_json().get();
+		const value& json_response = response.json();
 		ThrowExceptionFromResponse(response.status_code(), json_response);
 	});
 }
@@ -337,16 +456,18 @@ void Database::DeleteUser(
 pplx::task<shared_ptr<User>> Database::GetUserAsync(
 	const string_t& resource_id) const
 {
-	http_request request = CreateRequest(
-		methods::GET,
-		RESOURCE_PATH_USERS,
-		resource_id,
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + users_ + resource_id);
-
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::GET,
+			RESOURCE_PATH_USERS,
+			resource_id,
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *users_ + resource_id);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
 	{
-		value json_response = response.extract_json().get();
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::OK)
 		{
@@ -365,15 +486,18 @@ shared_ptr<User> Database::GetUser(
 
 pplx::task<vector<shared_ptr<User>>> Database::ListUsersAsync() const
 {
-	http_request request = CreateRequest(
-		methods::GET,
-		RESOURCE_PATH_USERS,
-		this->resource_id(),
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + users_);
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::GET,
+			RESOURCE_PATH_USERS,
+			this->resource_id(),
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *users_);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
 	{
-		value json_response = response.extract_json().get();
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::OK)
 		{
@@ -398,20 +522,22 @@ pplx::task<shared_ptr<User>> Database::ReplaceUserAsync(
 	const string_t& resource_id,
 	const string_t& new_id) const
 {
-	http_request request = CreateRequest(
-		methods::PUT,
-		RESOURCE_PATH_USERS,
-		resource_id,
-		document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + users_ + resource_id);
-
-	value body;
-	body[DOCUMENT_ID] = value::string(new_id);
-	request.set_body(body);
-
-	return document_db_configuration()->http_client().request(request).then([=](http_response response)
+	return ExecuteRequestAsync(*document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::PUT,
+			RESOURCE_PATH_USERS,
+			resource_id,
+			document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *users_ + resource_id);
+
+		value body;
+		body[DOCUMENT_ID] = value::string(new_id);
+		request.set_body(body);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
 	{
-		value json_response = response.extract_json().get();
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::OK)
 		{
@@ -49,7 +49,31 @@ Document::Document(
 		const string_t& attachments,
 		const value& payload)
 	: DocumentDBEntity(document_db_configuration, id, resource_id, ts, self, etag)
-	, attachments_(attachments)
+	, attachments_(ShareLink(attachments))
+	, payload_(make_shared<const value>(payload))
+{
+}
+
+Document::Document(
+		const shared_ptr<const DocumentDBConfiguration>& document_db_configuration,
+		const string_t& id,
+		const string_t& resource_id,
+		const unsigned long ts,
+		const string_t& self,
+		const string_t& etag,
+		const string_t& attachments,
+		const shared_ptr<const value>& payload)
+	: DocumentDBEntity(document_db_configuration, id, resource_id, ts, self, etag)
+	, attachments_(ShareLink(attachments))
+	, payload_(payload)
+{
+}
+
+Document::Document(
+		const shared_ptr<const DocumentDBConfiguration>& document_db_configuration,
+		const shared_ptr<const value>& payload)
+	: DocumentDBEntity(document_db_configuration, payload)
+	, attachments_(ShareLink(payload->at(RESPONSE_RESOURCE_ATTACHMENTS).as_string()))
 	, payload_(payload)
 {
 }
@@ -58,6 +82,33 @@ Document::~Document()
 {
 }
 
+shared_ptr<Document> Document::Detach() const
+{
+	return make_shared<Document>(
+		document_db_configuration(),
+		id(),
+		resource_id(),
+		ts(),
+		self(),
+		etag(),
+		*attachments_,
+		*payload_);
+}
+
+shared_ptr<Document> Document::WithDiagnosticsHandler(
+	const function<void(const ResponseDiagnostics&)>& diagnostics_handler) const
+{
+	return make_shared<Document>(
+		document_db_configuration()->WithDiagnosticsHandler(diagnostics_handler),
+		id(),
+		resource_id(),
+		ts(),
+		self(),
+		etag(),
+		*attachments_,
+		payload_);
+}
+
 shared_ptr<Attachment> Document::AttachmentFromJson(
 	const value& json_attachment) const
 {
@@ -85,22 +136,24 @@ pplx::task<shared_ptr<Attachment>> Document::CreateAttachmentAsync(
 	const string_t& contentType,
 	const string_t& media) const
 {
-	http_request request = CreateRequest(
-		methods::POST,
-		RESOURCE_PATH_ATTACHMENTS,
-		this->resource_id(),
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + attachments_);
-
-	value body;
-	body[ATTACHMENT_ID] = value::string(id);
-	body[CONTENT_TYPE] = value::string(contentType);
-	body[MEDIA] = value::string(media);
-	request.set_body(body);
-
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::POST,
+			RESOURCE_PATH_ATTACHMENTS,
+			this->resource_id(),
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *attachments_);
+
+		value body;
+		body[ATTACHMENT_ID] = value::string(id);
+		body[CONTENT_TYPE] = value::string(contentType);
+		body[MEDIA] = value::string(media);
+		request.set_body(body);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
 	{
-		value json_response = response.extract_json().get();
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::Created)
 		{
@@ -116,20 +169,22 @@ pplx::task<shared_ptr<Attachment>> Document::CreateAttachmentAsync(
 	const string_t& contentType,
 	const vector<unsigned char>& raw_media) const
 {
-	http_request request = CreateRequest(
-		methods::POST,
-		RESOURCE_PATH_ATTACHMENTS,
-		this->resource_id(),
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + attachments_);
-
-	request.headers().add(web::http::header_names::content_type, contentType);
-	request.headers().add(_XPLATSTR("Slug"), id);
-	request.set_body(raw_media);
-
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
 	{
-		value json_response = response.extract_json().get();
+		http_request request = CreateRequest(
+			methods::POST,
+			RESOURCE_PATH_ATTACHMENTS,
+			this->resource_id(),
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *attachments_);
+
+		request.headers().add(web::http::header_names::content_type, contentType);
+		request.headers().add(_XPLATSTR("Slug"), id);
+		request.set_body(raw_media);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
+	{
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::Created)
 		{
@@ -159,16 +214,18 @@ shared_ptr<Attachment> Document::CreateAttachment(
 pplx::task<shared_ptr<Attachment>> Document::GetAttachmentAsync(
 	const string_t& resource_id) const
 {
-	http_request request = CreateRequest(
-		methods::GET,
-		RESOURCE_PATH_ATTACHMENTS,
-		resource_id,
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + attachments_ + resource_id);
-
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::GET,
+			RESOURCE_PATH_ATTACHMENTS,
+			resource_id,
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *attachments_ + resource_id);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
 	{
-		value json_response = response.extract_json().get();
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::OK)
 		{
@@ -187,15 +244,18 @@ shared_ptr<Attachment> Document::GetAttachment(
 
 pplx::task<vector<shared_ptr<Attachment>>> Document::ListAttachmentsAsync() const
 {
-	http_request request = CreateRequest(
-		methods::GET,
-		RESOURCE_PATH_ATTACHMENTS,
-		this->resource_id(),
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + attachments_);
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::GET,
+			RESOURCE_PATH_ATTACHMENTS,
+			this->resource_id(),
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *attachments_);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
 	{
-		value json_response = response.extract_json().get();
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::OK)
 		{
@@ -221,29 +281,65 @@ vector<shared_ptr<Attachment>> Document::ListAttachments() const
 	return ListAttachmentsAsync().get();
 }
 
+pplx::task<void> Document::ListAttachmentsAsync(
+	const function<void(const shared_ptr<Attachment>&)>& on_attachment) const
+{
+	shared_ptr<const Document> self = shared_from_this();
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::GET,
+			RESOURCE_PATH_ATTACHMENTS,
+			this->resource_id(),
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *attachments_);
+		return request;
+	}, [self, on_attachment](const http_response& response)
+	{
+		return ReadJsonArrayAsync(response, RESPONSE_QUERY_ATTACHMENTS, [self, on_attachment](value&& attachment)
+		{
+			on_attachment(self->AttachmentFromJson(attachment));
+		});
+	}).then([](const DocumentDBResponse& response)
+	{
+		if (response.status_code() != status_codes::OK)
+		{
+			ThrowExceptionFromResponse(response.status_code(), response.json());
+		}
+	});
+}
+
+void Document::ListAttachments(
+	const function<void(const shared_ptr<Attachment>&)>& on_attachment) const
+{
+	this->ListAttachmentsAsync(on_attachment).get();
+}
+
 pplx::task<shared_ptr<Attachment>> Document::ReplaceAttachmentAsync(
 	const string_t& id,
 	const string_t& new_id,
 	const string_t& contentType,
 	const string_t& media) const
 {
-	http_request request = CreateRequest(
-		methods::PUT,
-		RESOURCE_PATH_ATTACHMENTS,
-		id,
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + attachments_ + id);
-
-	value body_;
-	body_[DOCUMENT_ID] = value::string(new_id);
-	body_[MEDIA] = value::string(media);
-	body_[CONTENT_TYPE] = value::string(contentType);
-
-	request.set_body(body_);
-
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::PUT,
+			RESOURCE_PATH_ATTACHMENTS,
+			id,
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *attachments_ + id);
+
+		value body_;
+		body_[DOCUMENT_ID] = value::string(new_id);
+		body_[MEDIA] = value::string(media);
+		body_[CONTENT_TYPE] = value::string(contentType);
+
+		request.set_body(body_);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
 	{
-		value json_response = response.extract_json().get();
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::OK)
 		{
@@ -278,21 +374,23 @@ void Document::DeleteAttachment(
 pplx::task<void> Document::DeleteAttachmentAsync(
 	const string_t& resource_id) const
 {
-	http_request request = CreateRequest(
-		methods::DEL,
-		RESOURCE_PATH_ATTACHMENTS,
-		resource_id,
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + attachments_ + resource_id);
-
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::DEL,
+			RESOURCE_PATH_ATTACHMENTS,
+			resource_id,
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *attachments_ + resource_id);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
 	{
 		if (response.status_code() == status_codes::NoContent)
 		{
 			return;
 		}
 
-		value json_response = response.extract_json().get();
+		const value& json_response = response.json();
 		ThrowExceptionFromResponse(response.status_code(), json_response);
 	});
 }
@@ -304,22 +402,25 @@ void Document::DeleteAttachment(
 }
 
 pplx::task<shared_ptr<AttachmentIterator>> Document::QueryAttachmentsAsync(
-	const string_t& query,
+	const SqlQuerySpec& query,
 	const int page_size) const
 {
-	http_request request = CreateQueryRequest(
-		query,
-		page_size,
-		RESOURCE_PATH_ATTACHMENTS,
-		this->resource_id(),
-		this->document_db_configuration()->master_key());
-	const string_t requestUri = this->self() + attachments_;
-	request.set_request_uri(requestUri);
-
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+	const string_t requestUri = this->self() + *attachments_;
+
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateQueryRequest(
+			query,
+			page_size,
+			RESOURCE_PATH_ATTACHMENTS,
+			this->resource_id(),
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(requestUri);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
 	{
-		string_t continuation_id = response.headers()[HEADER_MS_CONTINUATION];
-		value json_response = response.extract_json().get();
+		string_t continuation_id = response.header(HEADER_MS_CONTINUATION);
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::OK)
 		{
@@ -331,7 +432,8 @@ pplx::task<shared_ptr<AttachmentIterator>> Document::QueryAttachmentsAsync(
 				page_size,
 				requestUri,
 				continuation_id,
-				json_response.at(RESPONSE_QUERY_ATTACHMENTS));
+				response.shared_json(),
+				response.diagnostics());
 		}
 
 		ThrowExceptionFromResponse(response.status_code(), json_response);
@@ -339,7 +441,7 @@ pplx::task<shared_ptr<AttachmentIterator>> Document::QueryAttachmentsAsync(
 }
 
 shared_ptr<AttachmentIterator> Document::QueryAttachments(
-	const string_t& query,
+	const SqlQuerySpec& query,
 	const int page_size) const
 {
 	return QueryAttachmentsAsync(query, page_size).get();
@@ -0,0 +1,247 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#include "DocumentCache.h"
+
+#include <functional>
+
+#include "Document.h"
+
+using namespace documentdb;
+using namespace std;
+using namespace utility;
+
+namespace
+{
+	// Bytes accounted for an entry besides its payload
+	const size_t ENTRY_OVERHEAD = 128;
+
+	// Sketch width per byte of capacity, assuming documents of about 1 KiB
+	const size_t BYTES_PER_COUNTER = 1024;
+	const size_t MIN_SKETCH_WIDTH = 64;
+	const size_t MAX_SKETCH_WIDTH = 1 << 22;
+
+	const unsigned int MAX_FREQUENCY = 15;
+
+	uint64_t Mix(
+		uint64_t hash)
+	{
+		hash ^= hash >> 33;
+		hash *= 0xFF51AFD7ED558CCDULL;
+		hash ^= hash >> 33;
+		hash *= 0xC4CEB9FE1A85EC53ULL;
+		hash ^= hash >> 33;
+		return hash;
+	}
+}
+
+DocumentCache::DocumentCache(
+	size_t max_bytes,
+	const chrono::milliseconds& not_found_ttl)
+	: max_bytes_(max_bytes)
+	, not_found_ttl_(not_found_ttl)
+	, bytes_(0)
+	, sketch_width_(MIN_SKETCH_WIDTH)
+	, additions_(0)
+{
+	while (sketch_width_ < MAX_SKETCH_WIDTH && sketch_width_ * BYTES_PER_COUNTER < max_bytes)
+	{
+		sketch_width_ *= 2;
+	}
+	sketch_.assign(SKETCH_ROWS * sketch_width_, 0);
+	sample_size_ = 10 * sketch_width_;
+}
+
+DocumentCache::~DocumentCache()
+{
+}
+
+bool DocumentCache::TryGet(
+	const string_t& resource_id,
+	shared_ptr<Document>& document,
+	exception_ptr& not_found)
+{
+	const uint64_t hash = Mix(std::hash<string_t>()(resource_id));
+
+	lock_guard<mutex> lock(mutex_);
+	RecordAccess(hash);
+
+	auto found = index_.find(resource_id);
+	if (found == index_.end())
+	{
+		return false;
+	}
+
+	EntryList::iterator entry = found->second;
+	if (entry->not_found && entry->expires <= clock::now())
+	{
+		Erase(entry);
+		return false;
+	}
+
+	entries_.splice(entries_.begin(), entries_, entry);
+	document = entry->document;
+	not_found = entry->not_found;
+	return true;
+}
+
+void DocumentCache::Put(
+	const string_t& resource_id,
+	const shared_ptr<Document>& document,
+	size_t size)
+{
+	Entry entry;
+	entry.resource_id = resource_id;
+	entry.hash = Mix(std::hash<string_t>()(resource_id));
+	entry.document = document;
+	entry.size = size + resource_id.size() * sizeof(char_t) + ENTRY_OVERHEAD;
+
+	lock_guard<mutex> lock(mutex_);
+	Insert(move(entry));
+}
+
+void DocumentCache::PutNotFound(
+	const string_t& resource_id,
+	const exception_ptr& not_found)
+{
+	Entry entry;
+	entry.resource_id = resource_id;
+	entry.hash = Mix(std::hash<string_t>()(resource_id));
+	entry.not_found = not_found;
+	entry.expires = clock::now() + not_found_ttl_;
+	entry.size = resource_id.size() * sizeof(char_t) + ENTRY_OVERHEAD;
+
+	lock_guard<mutex> lock(mutex_);
+	Insert(move(entry));
+}
+
+void DocumentCache::Remove(
+	const string_t& resource_id)
+{
+	lock_guard<mutex> lock(mutex_);
+	auto found = index_.find(resource_id);
+	if (found != index_.end())
+	{
+		Erase(found->second);
+	}
+}
+
+size_t DocumentCache::bytes() const
+{
+	lock_guard<mutex> lock(mutex_);
+	return bytes_;
+}
+
+size_t DocumentCache::count() const
+{
+	lock_guard<mutex> lock(mutex_);
+	return entries_.size();
+}
+
+void DocumentCache::Insert(
+	Entry&& entry)
+{
+	// Whatever is cached is out of date, the new entry is admitted or not on
+	// its own merits
+	auto found = index_.find(entry.resource_id);
+	if (found != index_.end())
+	{
+		Erase(found->second);
+	}
+
+	if (entry.size > max_bytes_)
+	{
+		return;
+	}
+
+	const unsigned int frequency = Frequency(entry.hash);
+	while (bytes_ + entry.size > max_bytes_)
+	{
+		EntryList::iterator victim = --entries_.end();
+
+		// Expired misses go first, otherwise the candidate has to be more
+		// popular than the entry it replaces
+		if (!(victim->not_found && victim->expires <= clock::now())
+			&& frequency <= Frequency(victim->hash))
+		{
+			return;
+		}
+
+		Erase(victim);
+	}
+
+	bytes_ += entry.size;
+	entries_.push_front(move(entry));
+	index_[entries_.front().resource_id] = entries_.begin();
+}
+
+void DocumentCache::Erase(
+	EntryList::iterator entry)
+{
+	bytes_ -= entry->size;
+	index_.erase(entry->resource_id);
+	entries_.erase(entry);
+}
+
+void DocumentCache::RecordAccess(
+	uint64_t hash)
+{
+	for (size_t row = 0; row < SKETCH_ROWS; row++)
+	{
+		uint8_t& counter = sketch_[CounterIndex(hash, row)];
+		if (counter < MAX_FREQUENCY)
+		{
+			counter++;
+		}
+	}
+
+	if (++additions_ >= sample_size_)
+	{
+		for (auto iter = sketch_.begin(); iter != sketch_.end(); ++iter)
+		{
+			*iter >>= 1;
+		}
+		additions_ /= 2;
+	}
+}
+
+unsigned int DocumentCache::Frequency(
+	uint64_t hash) const
+{
+	unsigned int frequency = MAX_FREQUENCY;
+	for (size_t row = 0; row < SKETCH_ROWS; row++)
+	{
+		frequency = min<unsigned int>(frequency, sketch_[CounterIndex(hash, row)]);
+	}
+	return frequency;
+}
+
+size_t DocumentCache::CounterIndex(
+	uint64_t hash,
+	size_t row) const
+{
+	// Rows index with independent hashes, widths are powers of two
+	const uint64_t row_hash = Mix(hash + row * 0x9E3779B97F4A7C15ULL);
+	return row * sketch_width_ + static_cast<size_t>(row_hash & (sketch_width_ - 1));
+}
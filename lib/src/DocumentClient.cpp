@@ -54,6 +54,22 @@ DocumentClient::DocumentClient(
 	document_db_configuration_ = make_shared<DocumentDBConfiguration>(document_db_configuration);
 }
 
+DocumentClient::DocumentClient(
+	const string_t& url_connection,
+	const string_t& master_key,
+	const ConnectionPolicy& connection_policy)
+{
+	document_db_configuration_ = make_shared<DocumentDBConfiguration>(url_connection, master_key, connection_policy);
+}
+
+DocumentClient DocumentClient::WithDiagnosticsHandler(
+	const function<void(const ResponseDiagnostics&)>& diagnostics_handler) const
+{
+	DocumentClient client(*this);
+	client.document_db_configuration_ = document_db_configuration_->WithDiagnosticsHandler(diagnostics_handler);
+	return client;
+}
+
 shared_ptr<Database> DocumentClient::DatabaseFromJson(
 	const value& json_database) const
 {
@@ -71,19 +87,21 @@ shared_ptr<Database> DocumentClient::DatabaseFromJson(
 pplx::task<shared_ptr<Database>> DocumentClient::CreateDatabaseAsync(
 	const string_t& id) const
 {
-	http_request request = CreateRequest(
-		methods::POST,
-		RESOURCE_PATH_DBS,
-		_XPLATSTR(""),
-		document_db_configuration_->master_key());
-	request.set_request_uri(RESOURCE_PATH_DBS);
-	value body;
-	body[DOCUMENT_ID] = value::string(id);
-	request.set_body(body);
-
-	return document_db_configuration_->http_client().request(request).then([=](http_response response)
+	return ExecuteRequestAsync(*document_db_configuration_, [=]()
 	{
-		value json_response = response.extract_json().get();
+		http_request request = CreateRequest(
+			methods::POST,
+			RESOURCE_PATH_DBS,
+			_XPLATSTR(""),
+			document_db_configuration_->request_signer());
+		request.set_request_uri(RESOURCE_PATH_DBS);
+		value body;
+		body[DOCUMENT_ID] = value::string(id);
+		request.set_body(body);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
+	{
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::Created)
 		{
@@ -115,21 +133,23 @@ void DocumentClient::DeleteDatabase(
 pplx::task<void> DocumentClient::DeleteDatabaseAsync(
 	const string_t& resource_id) const
 {
-	http_request request = CreateRequest(
-		methods::DEL,
-		RESOURCE_PATH_DBS,
-		resource_id,
-		document_db_configuration_->master_key());
-	request.set_request_uri(string_t(RESOURCE_PATH_DBS) + _XPLATSTR("/") + resource_id);
-
-	return document_db_configuration_->http_client().request(request).then([=](http_response response)
+	return ExecuteRequestAsync(*document_db_configuration_, [=]()
+	{
+		http_request request = CreateRequest(
+			methods::DEL,
+			RESOURCE_PATH_DBS,
+			resource_id,
+			document_db_configuration_->request_signer());
+		request.set_request_uri(string_t(RESOURCE_PATH_DBS) + _XPLATSTR("/") + resource_id);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
 	{
 		if (response.status_code() == status_codes::NoContent)
 		{
 			return;
 		}
 
-		value json_response = response.extract_json().get();
+		const value& json_response = response.json();
 		ThrowExceptionFromResponse(response.status_code(), json_response);
 	});
 }
@@ -143,16 +163,76 @@ void DocumentClient::DeleteDatabase(
 pplx::task<shared_ptr<Database>> DocumentClient::GetDatabaseAsync(
 	const string_t& resource_id) const
 {
-	http_request request = CreateRequest(
-		methods::GET,
-		RESOURCE_PATH_DBS,
-		resource_id,
-		document_db_configuration_->master_key());
-	request.set_request_uri(string_t(RESOURCE_PATH_DBS) + _XPLATSTR("/") + resource_id);
+	// A copy, the cache may read the database again after this client is gone
+	shared_ptr<const DocumentClient> self = make_shared<DocumentClient>(*this);
+	return document_db_configuration_->metadata_cache()->GetAsync<Database>(
+		string_t(RESOURCE_PATH_DBS) + _XPLATSTR("/") + resource_id,
+		[self, resource_id]()
+		{
+			return self->ReadDatabaseAsync(resource_id);
+		});
+}
 
-	return document_db_configuration_->http_client().request(request).then([=](http_response response)
+pplx::task<shared_ptr<Database>> DocumentClient::GetDatabaseByIdAsync(
+	const string_t& id) const
+{
+	shared_ptr<const DocumentClient> self = make_shared<DocumentClient>(*this);
+	const string_t link = string_t(RESOURCE_PATH_DBS) + _XPLATSTR("/") + id;
+	const string_t uri = string_t(RESOURCE_PATH_DBS) + _XPLATSTR("/") + web::uri::encode_data_string(id);
+
+	return document_db_configuration_->metadata_cache()->GetAsync<Database>(
+		uri,
+		[self, link, uri]()
+		{
+			return ExecuteRequestAsync(*self->document_db_configuration_, [=]()
+			{
+				http_request request = CreateRequest(
+					methods::GET,
+					RESOURCE_PATH_DBS,
+					link,
+					self->document_db_configuration_->request_signer(),
+					true);
+				request.set_request_uri(uri);
+				return request;
+			}).then([self](const DocumentDBResponse& response)
+			{
+				const value& json_response = response.json();
+
+				if (response.status_code() == status_codes::OK)
+				{
+					return self->DatabaseFromJson(json_response);
+				}
+
+				ThrowExceptionFromResponse(response.status_code(), json_response);
+			});
+		},
+		[](const Database& database)
+		{
+			return database.self();
+		});
+}
+
+shared_ptr<Database> DocumentClient::GetDatabaseById(
+	const string_t& id) const
+{
+	return this->GetDatabaseByIdAsync(id).get();
+}
+
+pplx::task<shared_ptr<Database>> DocumentClient::ReadDatabaseAsync(
+	const string_t& resource_id) const
+{
+	return ExecuteRequestAsync(*document_db_configuration_, [=]()
 	{
-		value json_response = response.extract_json().get();
+		http_request request = CreateRequest(
+			methods::GET,
+			RESOURCE_PATH_DBS,
+			resource_id,
+			document_db_configuration_->request_signer());
+		request.set_request_uri(string_t(RESOURCE_PATH_DBS) + _XPLATSTR("/") + resource_id);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
+	{
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::OK)
 		{
@@ -173,16 +253,18 @@ shared_ptr<Database> DocumentClient::GetDatabase(
 
 pplx::task<vector<shared_ptr<Database>>> DocumentClient::ListDatabasesAsync() const
 {
-	http_request request = CreateRequest(
-		methods::GET,
-		RESOURCE_PATH_DBS,
-		_XPLATSTR(""),
-		document_db_configuration_->master_key());
-	request.set_request_uri(RESOURCE_PATH_DBS);
-
-	return document_db_configuration_->http_client().request(request).then([=](http_response response)
+	return ExecuteRequestAsync(*document_db_configuration_, [=]()
 	{
-		value json_response = response.extract_json().get();
+		http_request request = CreateRequest(
+			methods::GET,
+			RESOURCE_PATH_DBS,
+			_XPLATSTR(""),
+			document_db_configuration_->request_signer());
+		request.set_request_uri(RESOURCE_PATH_DBS);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
+	{
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::OK)
 		{
@@ -209,3 +291,10 @@ vector<shared_ptr<Database>> DocumentClient::ListDatabases() const
 {
 	return this->ListDatabasesAsync().get();
 }
+
+NamedCollection DocumentClient::CollectionByName(
+	const string_t& database_id,
+	const string_t& collection_id) const
+{
+	return NamedCollection(document_db_configuration_, database_id, collection_id);
+}
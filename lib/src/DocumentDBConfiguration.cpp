@@ -24,20 +24,39 @@
 
 #include "DocumentDBConfiguration.h"
 
+using namespace documentdb;
 using namespace std;
 using namespace utility;
 using namespace web::http;
 
 DocumentDBConfiguration::DocumentDBConfiguration(
 		string_t url_connection,
-		string_t master_key)
+		string_t master_key,
+		const ConnectionPolicy& connection_policy)
 	: url_connection_(url_connection)
-	, http_client_(url_connection)
+	, connection_policy_(connection_policy)
 {
+	http_client_ = make_shared<client::http_client>(
+		url_connection,
+		connection_policy.ToHttpClientConfig(url_connection));
+	request_limiter_ = make_shared<RequestLimiter>(connection_policy.max_connections());
+	retry_budget_ = make_shared<RetryBudget>(
+		connection_policy.retry_options().retry_budget_tokens(),
+		connection_policy.retry_options().retry_budget_refill_ratio());
+	metadata_cache_ = make_shared<MetadataCache>(connection_policy.metadata_cache_ttl());
 	master_key_ = utility::conversions::from_base64(master_key);
+	request_signer_ = make_shared<RequestSigner>(master_key_);
 }
 
 
 DocumentDBConfiguration::~DocumentDBConfiguration()
 {
 }
+
+shared_ptr<DocumentDBConfiguration> DocumentDBConfiguration::WithDiagnosticsHandler(
+	const function<void(const ResponseDiagnostics&)>& diagnostics_handler) const
+{
+	shared_ptr<DocumentDBConfiguration> configuration = make_shared<DocumentDBConfiguration>(*this);
+	configuration->set_diagnostics_handler(diagnostics_handler);
+	return configuration;
+}
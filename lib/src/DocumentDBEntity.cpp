@@ -24,10 +24,35 @@
 
 #include "DocumentDBEntity.h"
 
+#include "DocumentDBConstants.h"
+
 using namespace documentdb;
 using namespace std;
 using namespace utility;
+using namespace web::json;
+
+namespace
+{
+	struct OwnedMetadata
+	{
+		OwnedMetadata(
+			const string_t& id,
+			const string_t& resource_id,
+			const string_t& self,
+			const string_t& etag)
+			: id(id)
+			, resource_id(resource_id)
+			, self(self)
+			, etag(etag)
+		{
+		}
 
+		string_t id;
+		string_t resource_id;
+		string_t self;
+		string_t etag;
+	};
+}
 
 DocumentDBEntity::DocumentDBEntity(
 		const shared_ptr<const DocumentDBConfiguration>& document_db_configuration,
@@ -37,12 +62,55 @@ DocumentDBEntity::DocumentDBEntity(
 		const string_t& self,
 		const string_t& etag)
 	: document_db_configuration_(document_db_configuration)
-	, id_(id)
-	, resource_id_(resource_id)
 	, ts_(ts)
-	, self_(self)
-	, etag_(etag)
 {
+	shared_ptr<const OwnedMetadata> metadata = make_shared<const OwnedMetadata>(id, resource_id, self, etag);
+	metadata_ = metadata;
+	id_ = &metadata->id;
+	resource_id_ = &metadata->resource_id;
+	self_ = &metadata->self;
+	etag_ = &metadata->etag;
+}
+
+DocumentDBEntity::DocumentDBEntity(
+		const shared_ptr<const DocumentDBConfiguration>& document_db_configuration,
+		const shared_ptr<const value>& json_resource)
+	: document_db_configuration_(document_db_configuration)
+	, metadata_(json_resource)
+	, id_(&json_resource->at(DOCUMENT_ID).as_string())
+	, resource_id_(&json_resource->at(RESPONSE_RESOURCE_RID).as_string())
+	, ts_(json_resource->at(RESPONSE_RESOURCE_TS).as_integer())
+	, self_(&json_resource->at(RESPONSE_RESOURCE_SELF).as_string())
+	, etag_(&json_resource->at(RESPONSE_RESOURCE_ETAG).as_string())
+{
+}
+
+shared_ptr<const string_t> DocumentDBEntity::ShareLink(
+	const string_t& link)
+{
+	// Built once and only read afterwards, so no lock is needed
+	static const shared_ptr<const string_t> known_links[] =
+	{
+		make_shared<const string_t>(string_t(RESOURCE_PATH_DOCS) + _XPLATSTR("/")),
+		make_shared<const string_t>(string_t(RESOURCE_PATH_COLLS) + _XPLATSTR("/")),
+		make_shared<const string_t>(string_t(RESOURCE_PATH_USERS) + _XPLATSTR("/")),
+		make_shared<const string_t>(string_t(RESOURCE_PATH_PERMISSIONS) + _XPLATSTR("/")),
+		make_shared<const string_t>(string_t(RESOURCE_PATH_TRIGGERS) + _XPLATSTR("/")),
+		make_shared<const string_t>(string_t(RESOURCE_PATH_SPROCS) + _XPLATSTR("/")),
+		make_shared<const string_t>(string_t(RESOURCE_PATH_UDFS) + _XPLATSTR("/")),
+		make_shared<const string_t>(_XPLATSTR("attachments/")),
+		make_shared<const string_t>(_XPLATSTR("conflicts/"))
+	};
+
+	for (const shared_ptr<const string_t>& known_link : known_links)
+	{
+		if (*known_link == link)
+		{
+			return known_link;
+		}
+	}
+
+	return make_shared<const string_t>(link);
 }
 
 DocumentDBEntity::~DocumentDBEntity()
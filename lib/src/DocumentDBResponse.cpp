@@ -0,0 +1,52 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#include "DocumentDBResponse.h"
+
+using namespace documentdb;
+using namespace std;
+using namespace utility;
+using namespace web::http;
+using namespace web::json;
+
+DocumentDBResponse::DocumentDBResponse(
+	const http_response& response,
+	const shared_ptr<const value>& json,
+	const ResponseDiagnostics& diagnostics)
+	: response_(response)
+	, json_(json)
+	, diagnostics_(diagnostics)
+{
+}
+
+DocumentDBResponse::~DocumentDBResponse()
+{
+}
+
+string_t DocumentDBResponse::header(
+	const string_t& name) const
+{
+	http_headers::const_iterator it = response_.headers().find(name);
+	return it == response_.headers().end() ? string_t() : it->second;
+}
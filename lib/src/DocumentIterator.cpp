@@ -40,70 +40,84 @@ using namespace web::http::client;
 
 DocumentIterator::DocumentIterator(
 		const shared_ptr<const Collection>& collection,
-		const string_t& original_query,
+		const SqlQuerySpec& original_query,
 		const int page_size,
 		const string_t& original_request_uri,
 		const string_t& continuation_id,
-		const value& buffer)
+		const shared_ptr<const value>& response_json,
+		const ResponseDiagnostics& diagnostics)
 	: collection_(collection)
-	, original_query_(original_query)
-	, page_size_(page_size)
-	, original_request_uri_(original_request_uri)
-	, continuation_id_(continuation_id)
-	, buffer_(buffer)
+	, page_(response_json)
+	, items_(&page_->at(RESPONSE_QUERY_DOCUMENTS).as_array())
 	, current_(0)
-{}
+	, diagnostics_(diagnostics)
+{
+	const ConnectionPolicy& connection_policy = collection->document_db_configuration()->connection_policy();
+	shared_ptr<const Collection> owner = collection;
+	pager_ = make_shared<QueryPager>(
+		[owner, original_query, page_size, original_request_uri](const string_t& continuation)
+		{
+			return ExecuteRequestAsync(*owner->document_db_configuration(), [=]()
+			{
+				http_request request = CreateQueryRequest(
+					original_query,
+					page_size,
+					RESOURCE_PATH_DOCS,
+					owner->resource_id(),
+					owner->document_db_configuration()->request_signer(),
+					continuation,
+					false,
+					!owner->partition_key().empty());
+				request.set_request_uri(original_request_uri);
+				return request;
+			});
+		},
+		RESPONSE_QUERY_DOCUMENTS,
+		continuation_id,
+		connection_policy.query_prefetch_pages(),
+		connection_policy.query_prefetch_max_bytes());
+	pager_->Prefetch();
+}
 
 DocumentIterator::~DocumentIterator()
 {}
 
-bool DocumentIterator::HasMore()
+pplx::task<bool> DocumentIterator::HasMoreAsync()
 {
-	if (current_ < buffer_.as_array().size())
-	{
-		return true;
-	}
-
-
-	if (continuation_id_.empty())
+	if (current_ < items_->size())
 	{
-		return false;
+		return pplx::task_from_result(true);
 	}
 
-	// Case where we have continuation, but we are not really sure do we have anything more, need to fetch it.
+	// Pages may come back empty while the continuation says there is more
 	//
-	http_request request = CreateQueryRequest(
-		original_query_,
-		page_size_,
-		RESOURCE_PATH_DOCS,
-		collection_->resource_id(),
-		collection_->document_db_configuration()->master_key(),
-		continuation_id_);
-	request.set_request_uri(original_request_uri_);
-
-	http_response response = collection_->document_db_configuration()->http_client().request(request).get();
-	value json_response = response.extract_json().get();
-
-	if (response.status_code() == status_codes::OK)
+	shared_ptr<DocumentIterator> self = shared_from_this();
+	return pager_->NextPageAsync().then([self](const QueryPager::Page& page)
 	{
-		string_t new_continuation_id = response.headers()[HEADER_MS_CONTINUATION];
-		int count = stoi(response.headers()[HEADER_MS_MAX_ITEM_COUNT]);
+		if (page.items == nullptr)
+		{
+			return pplx::task_from_result(false);
+		}
 
-		buffer_ = json_response.at(RESPONSE_QUERY_DOCUMENTS);
-		continuation_id_ = new_continuation_id;
-		current_ = 0;
-		return count > 0;
-	}
+		self->page_ = page.json;
+		self->items_ = page.items;
+		self->current_ = 0;
+		self->diagnostics_ = page.diagnostics;
+		return self->HasMoreAsync();
+	});
+}
 
-	ThrowExceptionFromResponse(response.status_code(), json_response);
+bool DocumentIterator::HasMore()
+{
+	return HasMoreAsync().get();
 }
 
 shared_ptr<Document> DocumentIterator::Next()
 {
-	if (current_ < buffer_.as_array().size())
+	if (current_ < items_->size())
 	{
-		value document_json = buffer_.as_array().at(current_++);
-		return collection_->DocumentFromJson(document_json);
+		// Shares the page, which stays alive with the document
+		return collection_->DocumentFromJson(shared_ptr<const value>(page_, &items_->at(current_++)));
 	}
 
 	// Did you called hasMore()?
@@ -111,3 +125,57 @@ shared_ptr<Document> DocumentIterator::Next()
 	assert(false);
 	throw DocumentDBRuntimeException(_XPLATSTR("Calling Next without checking HasMore before that."));
 }
+
+pplx::task<shared_ptr<Document>> DocumentIterator::NextAsync()
+{
+	shared_ptr<DocumentIterator> self = shared_from_this();
+	return HasMoreAsync().then([self](bool has_more)
+	{
+		return has_more ? self->Next() : shared_ptr<Document>();
+	});
+}
+
+pplx::task<vector<shared_ptr<Document>>> DocumentIterator::NextPageAsync()
+{
+	shared_ptr<DocumentIterator> self = shared_from_this();
+	return HasMoreAsync().then([self](bool has_more)
+	{
+		vector<shared_ptr<Document>> results;
+		if (has_more)
+		{
+			results.reserve(self->items_->size() - self->current_);
+			while (self->current_ < self->items_->size())
+			{
+				results.push_back(self->Next());
+			}
+		}
+
+		return results;
+	});
+}
+
+vector<shared_ptr<Document>> DocumentIterator::NextPage()
+{
+	return NextPageAsync().get();
+}
+
+pplx::task<DocumentPage> DocumentIterator::NextPageViewAsync()
+{
+	shared_ptr<DocumentIterator> self = shared_from_this();
+	return HasMoreAsync().then([self](bool has_more)
+	{
+		if (!has_more)
+		{
+			return DocumentPage();
+		}
+
+		DocumentPage page(self->collection_, self->page_, self->items_, self->current_, self->diagnostics_);
+		self->current_ = (unsigned int)self->items_->size();
+		return page;
+	});
+}
+
+DocumentPage DocumentIterator::NextPageView()
+{
+	return NextPageViewAsync().get();
+}
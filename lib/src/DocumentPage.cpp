@@ -0,0 +1,94 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#include "DocumentPage.h"
+
+#include "Collection.h"
+#include "DocumentDBConstants.h"
+#include "exceptions.h"
+
+using namespace documentdb;
+using namespace std;
+using namespace utility;
+using namespace web::json;
+
+namespace
+{
+	const web::json::array& EmptyArray()
+	{
+		static const value empty = value::array();
+		return empty.as_array();
+	}
+}
+
+DocumentPage::DocumentPage()
+	: begin_(EmptyArray().begin())
+	, end_(EmptyArray().end())
+{}
+
+DocumentPage::DocumentPage(
+	const shared_ptr<const Collection>& collection,
+	const shared_ptr<const value>& page,
+	const web::json::array* items,
+	size_t begin,
+	const ResponseDiagnostics& diagnostics)
+	: collection_(collection)
+	, page_(page)
+	, begin_(items->begin() + begin)
+	, end_(items->end())
+	, diagnostics_(diagnostics)
+{}
+
+DocumentPage::~DocumentPage()
+{}
+
+const value& DocumentPage::at(size_t index) const
+{
+	if (index >= size())
+	{
+		throw DocumentDBRuntimeException(_XPLATSTR("Index out of the range of the page."));
+	}
+
+	return (*this)[index];
+}
+
+const string_t& DocumentPage::id(size_t index) const
+{
+	return at(index).at(DOCUMENT_ID).as_string();
+}
+
+const string_t& DocumentPage::resource_id(size_t index) const
+{
+	return at(index).at(RESPONSE_RESOURCE_RID).as_string();
+}
+
+const string_t& DocumentPage::etag(size_t index) const
+{
+	return at(index).at(RESPONSE_RESOURCE_ETAG).as_string();
+}
+
+shared_ptr<Document> DocumentPage::document(size_t index) const
+{
+	return collection_->DocumentFromJson(shared_ptr<const value>(page_, &at(index)));
+}
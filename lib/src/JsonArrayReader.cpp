@@ -0,0 +1,197 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#include "JsonArrayReader.h"
+
+#include "exceptions.h"
+
+using namespace documentdb;
+using namespace std;
+using namespace utility;
+using namespace web::json;
+
+namespace
+{
+	bool IsWhitespace(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+	}
+}
+
+JsonArrayReader::JsonArrayReader(
+	const string_t& array_field,
+	const ItemHandler& on_item)
+	: array_field_(utility::conversions::to_utf8string(array_field))
+	, on_item_(on_item)
+	, depth_(0)
+	, in_string_(false)
+	, escaped_(false)
+	, reading_key_(false)
+	, in_array_(false)
+	, in_item_(false)
+	, item_depth_(0)
+{
+}
+
+JsonArrayReader::~JsonArrayReader()
+{
+}
+
+shared_ptr<JsonArrayReader> JsonArrayReader::TextReader(
+	const string_t& array_field,
+	const ItemTextHandler& on_item_text)
+{
+	shared_ptr<JsonArrayReader> reader = make_shared<JsonArrayReader>(array_field, ItemHandler());
+	reader->on_item_text_ = on_item_text;
+	return reader;
+}
+
+void JsonArrayReader::Read(
+	const char* data,
+	size_t size)
+{
+	// Only ASCII characters are structural, bytes of multibyte UTF-8 sequences
+	// never match them
+	for (size_t i = 0; i < size; i++)
+	{
+		char c = data[i];
+
+		if (in_string_)
+		{
+			(in_item_ ? item_ : envelope_) += c;
+			if (escaped_)
+			{
+				escaped_ = false;
+			}
+			else if (c == '\\')
+			{
+				escaped_ = true;
+			}
+			else if (c == '"')
+			{
+				in_string_ = false;
+				reading_key_ = false;
+				if (in_item_ && depth_ == item_depth_)
+				{
+					EndItem();
+				}
+			}
+			else if (reading_key_)
+			{
+				key_ += c;
+			}
+			continue;
+		}
+
+		if (in_array_ && !in_item_ && depth_ == 2)
+		{
+			// Between elements of the array
+			if (IsWhitespace(c) || c == ',')
+			{
+				continue;
+			}
+
+			if (c == ']')
+			{
+				in_array_ = false;
+				depth_--;
+				envelope_ += c;
+				continue;
+			}
+
+			BeginItem();
+		}
+
+		if (in_item_ && depth_ == item_depth_ && (c == ',' || c == ']' || IsWhitespace(c)))
+		{
+			// End of a number or literal element
+			EndItem();
+			i--;
+			continue;
+		}
+
+		(in_item_ ? item_ : envelope_) += c;
+		switch (c)
+		{
+		case '"':
+			in_string_ = true;
+			reading_key_ = depth_ == 1 && !in_item_;
+			if (reading_key_)
+			{
+				key_.clear();
+			}
+			break;
+
+		case '{':
+		case '[':
+			depth_++;
+			if (c == '[' && depth_ == 2 && !in_item_ && key_ == array_field_)
+			{
+				in_array_ = true;
+			}
+			break;
+
+		case '}':
+		case ']':
+			depth_--;
+			if (in_item_ && depth_ == item_depth_)
+			{
+				EndItem();
+			}
+			break;
+		}
+	}
+}
+
+void JsonArrayReader::BeginItem()
+{
+	in_item_ = true;
+	item_depth_ = depth_;
+	item_.clear();
+}
+
+void JsonArrayReader::EndItem()
+{
+	in_item_ = false;
+	if (on_item_text_)
+	{
+		on_item_text_(item_);
+		item_.clear();
+		return;
+	}
+
+	value item = value::parse(utility::conversions::to_string_t(move(item_)));
+	item_.clear();
+	on_item_(move(item));
+}
+
+web::json::value JsonArrayReader::Finish()
+{
+	if (depth_ != 0 || in_string_ || in_item_)
+	{
+		throw DocumentDBRuntimeException(_XPLATSTR("Response body ended before the end of its JSON."));
+	}
+
+	return value::parse(utility::conversions::to_string_t(envelope_));
+}
@@ -0,0 +1,434 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#include "JsonReader.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#include "exceptions.h"
+
+using namespace documentdb;
+using namespace std;
+using namespace utility;
+using namespace web::json;
+
+namespace
+{
+	void AppendUtf8(
+		std::string& output,
+		unsigned long code_point)
+	{
+		if (code_point < 0x80)
+		{
+			output += static_cast<char>(code_point);
+		}
+		else if (code_point < 0x800)
+		{
+			output += static_cast<char>(0xC0 | (code_point >> 6));
+			output += static_cast<char>(0x80 | (code_point & 0x3F));
+		}
+		else if (code_point < 0x10000)
+		{
+			output += static_cast<char>(0xE0 | (code_point >> 12));
+			output += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+			output += static_cast<char>(0x80 | (code_point & 0x3F));
+		}
+		else
+		{
+			output += static_cast<char>(0xF0 | (code_point >> 18));
+			output += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+			output += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+			output += static_cast<char>(0x80 | (code_point & 0x3F));
+		}
+	}
+}
+
+JsonReader::JsonReader(
+	const char* data,
+	size_t size)
+	: data_(data)
+	, end_(data + size)
+	, current_(data)
+{
+}
+
+JsonReader::~JsonReader()
+{
+}
+
+bool JsonReader::ReadNull()
+{
+	if (Peek() != 'n')
+	{
+		return false;
+	}
+
+	SkipLiteral("null");
+	return true;
+}
+
+void JsonReader::BeginObject()
+{
+	Expect('{');
+}
+
+bool JsonReader::NextField(
+	std::string& name)
+{
+	char c = Peek();
+	if (c == '}')
+	{
+		current_++;
+		return false;
+	}
+
+	if (c == ',')
+	{
+		current_++;
+	}
+
+	ReadString(name);
+	Expect(':');
+	return true;
+}
+
+void JsonReader::BeginArray()
+{
+	Expect('[');
+}
+
+bool JsonReader::NextElement()
+{
+	char c = Peek();
+	if (c == ']')
+	{
+		current_++;
+		return false;
+	}
+
+	if (c == ',')
+	{
+		current_++;
+	}
+
+	return true;
+}
+
+bool JsonReader::ReadBool()
+{
+	if (Peek() == 't')
+	{
+		SkipLiteral("true");
+		return true;
+	}
+
+	SkipLiteral("false");
+	return false;
+}
+
+long long JsonReader::ReadInteger()
+{
+	Peek();
+	const char* start = current_;
+	size_t length = SkipNumber();
+
+	// Numbers are copied out first, the text is not null terminated
+	char buffer[32];
+	if (length >= sizeof(buffer))
+	{
+		Fail("integer out of range");
+	}
+	memcpy(buffer, start, length);
+	buffer[length] = '\0';
+
+	char* number_end;
+	long long value = strtoll(buffer, &number_end, 10);
+	if (*number_end != '\0')
+	{
+		Fail("integer expected");
+	}
+	return value;
+}
+
+double JsonReader::ReadDouble()
+{
+	Peek();
+	const char* start = current_;
+	size_t length = SkipNumber();
+
+	char buffer[64];
+	if (length >= sizeof(buffer))
+	{
+		Fail("number too long");
+	}
+	memcpy(buffer, start, length);
+	buffer[length] = '\0';
+	return strtod(buffer, nullptr);
+}
+
+void JsonReader::ReadString(
+	std::string& value)
+{
+	Expect('"');
+	value.clear();
+	while (true)
+	{
+		const char* run = current_;
+		while (current_ < end_ && *current_ != '"' && *current_ != '\\')
+		{
+			current_++;
+		}
+		value.append(run, current_);
+
+		if (current_ == end_)
+		{
+			Fail("unterminated string");
+		}
+
+		if (*current_++ == '"')
+		{
+			return;
+		}
+
+		if (current_ == end_)
+		{
+			Fail("unterminated string");
+		}
+
+		char escaped = *current_++;
+		switch (escaped)
+		{
+		case '"': value += '"'; break;
+		case '\\': value += '\\'; break;
+		case '/': value += '/'; break;
+		case 'b': value += '\b'; break;
+		case 'f': value += '\f'; break;
+		case 'n': value += '\n'; break;
+		case 'r': value += '\r'; break;
+		case 't': value += '\t'; break;
+		case 'u':
+		{
+			unsigned long code_point = 0;
+			for (int pair = 0; pair < 2; pair++)
+			{
+				if (end_ - current_ < 4)
+				{
+					Fail("truncated escape");
+				}
+
+				unsigned long unit = 0;
+				for (int i = 0; i < 4; i++)
+				{
+					char hex = *current_++;
+					unit <<= 4;
+					if (hex >= '0' && hex <= '9') unit |= hex - '0';
+					else if (hex >= 'a' && hex <= 'f') unit |= hex - 'a' + 10;
+					else if (hex >= 'A' && hex <= 'F') unit |= hex - 'A' + 10;
+					else Fail("invalid escape");
+				}
+
+				if (pair == 0)
+				{
+					code_point = unit;
+					// A high surrogate is followed by the escaped low one
+					if (unit < 0xD800 || unit > 0xDBFF
+						|| end_ - current_ < 2 || current_[0] != '\\' || current_[1] != 'u')
+					{
+						break;
+					}
+					current_ += 2;
+				}
+				else
+				{
+					code_point = 0x10000 + ((code_point - 0xD800) << 10) + (unit - 0xDC00);
+				}
+			}
+			AppendUtf8(value, code_point);
+			break;
+		}
+		default:
+			Fail("invalid escape");
+		}
+	}
+}
+
+value JsonReader::ReadValue()
+{
+	Peek();
+	const char* start = current_;
+	SkipValue();
+	return value::parse(utility::conversions::to_string_t(std::string(start, current_)));
+}
+
+void JsonReader::SkipValue()
+{
+	switch (Peek())
+	{
+	case '{':
+	{
+		current_++;
+		bool first = true;
+		while (Peek() != '}')
+		{
+			if (!first)
+			{
+				Expect(',');
+			}
+			first = false;
+			Peek();
+			SkipString();
+			Expect(':');
+			SkipValue();
+		}
+		current_++;
+		break;
+	}
+	case '[':
+	{
+		current_++;
+		bool first = true;
+		while (Peek() != ']')
+		{
+			if (!first)
+			{
+				Expect(',');
+			}
+			first = false;
+			SkipValue();
+		}
+		current_++;
+		break;
+	}
+	case '"':
+		SkipString();
+		break;
+	case 't':
+		SkipLiteral("true");
+		break;
+	case 'f':
+		SkipLiteral("false");
+		break;
+	case 'n':
+		SkipLiteral("null");
+		break;
+	default:
+		SkipNumber();
+	}
+}
+
+void JsonReader::End()
+{
+	SkipWhitespace();
+	if (current_ != end_)
+	{
+		Fail("unexpected text after the value");
+	}
+}
+
+void JsonReader::SkipWhitespace()
+{
+	while (current_ < end_ && (*current_ == ' ' || *current_ == '\t' || *current_ == '\r' || *current_ == '\n'))
+	{
+		current_++;
+	}
+}
+
+char JsonReader::Peek()
+{
+	SkipWhitespace();
+	if (current_ == end_)
+	{
+		Fail("unexpected end");
+	}
+	return *current_;
+}
+
+void JsonReader::Expect(
+	char c)
+{
+	if (Peek() != c)
+	{
+		Fail("unexpected character");
+	}
+	current_++;
+}
+
+size_t JsonReader::SkipNumber()
+{
+	const char* start = current_;
+	while (current_ < end_
+		&& ((*current_ >= '0' && *current_ <= '9')
+			|| *current_ == '-' || *current_ == '+' || *current_ == '.' || *current_ == 'e' || *current_ == 'E'))
+	{
+		current_++;
+	}
+
+	if (current_ == start)
+	{
+		Fail("value expected");
+	}
+	return current_ - start;
+}
+
+void JsonReader::SkipString()
+{
+	Expect('"');
+	while (current_ < end_ && *current_ != '"')
+	{
+		if (*current_ == '\\')
+		{
+			current_++;
+		}
+		current_++;
+	}
+
+	if (current_ >= end_)
+	{
+		Fail("unterminated string");
+	}
+	current_++;
+}
+
+void JsonReader::SkipLiteral(
+	const char* literal)
+{
+	size_t length = strlen(literal);
+	if ((size_t)(end_ - current_) < length || memcmp(current_, literal, length) != 0)
+	{
+		Fail("unexpected literal");
+	}
+	current_ += length;
+}
+
+__declspec(noreturn)
+void JsonReader::Fail(
+	const char* what) const
+{
+	throw DocumentDBRuntimeException(
+		_XPLATSTR("Malformed JSON at offset ")
+		+ utility::conversions::print_string(current_ - data_)
+		+ _XPLATSTR(": ")
+		+ utility::conversions::to_string_t(std::string(what)));
+}
@@ -0,0 +1,166 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#include "JsonWriter.h"
+
+#include <cmath>
+#include <locale>
+#include <sstream>
+
+#include "exceptions.h"
+
+using namespace documentdb;
+using namespace std;
+using namespace web::json;
+
+JsonWriter::JsonWriter(
+	std::string& output)
+	: output_(output)
+	, needs_comma_(false)
+{
+}
+
+JsonWriter::~JsonWriter()
+{
+}
+
+void JsonWriter::BeginObject()
+{
+	BeginValue();
+	output_ += '{';
+	needs_comma_ = false;
+}
+
+void JsonWriter::EndObject()
+{
+	output_ += '}';
+	needs_comma_ = true;
+}
+
+void JsonWriter::Name(
+	const std::string& name)
+{
+	WriteString(name);
+	output_ += ':';
+	needs_comma_ = false;
+}
+
+void JsonWriter::BeginArray()
+{
+	BeginValue();
+	output_ += '[';
+	needs_comma_ = false;
+}
+
+void JsonWriter::EndArray()
+{
+	output_ += ']';
+	needs_comma_ = true;
+}
+
+void JsonWriter::WriteNull()
+{
+	BeginValue();
+	output_ += "null";
+}
+
+void JsonWriter::WriteBool(
+	bool value)
+{
+	BeginValue();
+	output_ += value ? "true" : "false";
+}
+
+void JsonWriter::WriteInteger(
+	long long value)
+{
+	BeginValue();
+	output_ += std::to_string(value);
+}
+
+void JsonWriter::WriteDouble(
+	double value)
+{
+	if (value != value || value == HUGE_VAL || value == -HUGE_VAL)
+	{
+		throw DocumentDBRuntimeException(_XPLATSTR("JSON cannot represent NaN or infinity."));
+	}
+
+	BeginValue();
+	// Enough digits to read back the same double, whatever the global locale
+	std::ostringstream number;
+	number.imbue(std::locale::classic());
+	number.precision(17);
+	number << value;
+	output_ += number.str();
+}
+
+void JsonWriter::WriteString(
+	const std::string& value)
+{
+	BeginValue();
+	output_ += '"';
+	for (std::string::const_iterator c = value.begin(); c != value.end(); ++c)
+	{
+		switch (*c)
+		{
+		case '"': output_ += "\\\""; break;
+		case '\\': output_ += "\\\\"; break;
+		case '\b': output_ += "\\b"; break;
+		case '\f': output_ += "\\f"; break;
+		case '\n': output_ += "\\n"; break;
+		case '\r': output_ += "\\r"; break;
+		case '\t': output_ += "\\t"; break;
+		default:
+			if (static_cast<unsigned char>(*c) < 0x20)
+			{
+				static const char hex[] = "0123456789abcdef";
+				output_ += "\\u00";
+				output_ += hex[(*c >> 4) & 0xF];
+				output_ += hex[*c & 0xF];
+			}
+			else
+			{
+				output_ += *c;
+			}
+		}
+	}
+	output_ += '"';
+}
+
+void JsonWriter::WriteValue(
+	const value& value)
+{
+	BeginValue();
+	output_ += utility::conversions::to_utf8string(value.serialize());
+}
+
+void JsonWriter::BeginValue()
+{
+	if (needs_comma_)
+	{
+		output_ += ',';
+	}
+	needs_comma_ = true;
+}
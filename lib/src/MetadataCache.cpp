@@ -0,0 +1,376 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#include "MetadataCache.h"
+
+#include "DocumentDBConstants.h"
+
+using namespace documentdb;
+using namespace std;
+using namespace utility;
+
+namespace
+{
+	bool IsSegment(
+		const string_t& link,
+		size_t begin,
+		size_t end,
+		const string_t& segment)
+	{
+		return end - begin == segment.size() && link.compare(begin, segment.size(), segment) == 0;
+	}
+
+	// Whether link is that of documents or attachments, or under one. Resource
+	// types and ids alternate in links: dbs/{id}/colls/{id}/docs/{id}.
+	bool IsDocumentLink(
+		const string_t& link)
+	{
+		const string_t docs = RESOURCE_PATH_DOCS;
+		const string_t attachments = RESOURCE_PATH_ATTACHMENTS;
+		bool is_type = true;
+		for (size_t begin = 0; begin < link.size(); is_type = !is_type)
+		{
+			size_t end = link.find(_XPLATSTR('/'), begin);
+			if (end == string_t::npos)
+			{
+				end = link.size();
+			}
+
+			if (is_type && (IsSegment(link, begin, end, docs) || IsSegment(link, begin, end, attachments)))
+			{
+				return true;
+			}
+			begin = end + 1;
+		}
+		return false;
+	}
+
+	// Whether descendant is link itself or a link under it
+	bool Contains(
+		const string_t& link,
+		const string_t& descendant)
+	{
+		return descendant.compare(0, link.size(), link) == 0
+			&& (descendant.size() == link.size() || descendant[link.size()] == _XPLATSTR('/'));
+	}
+}
+
+MetadataCache::MetadataCache(
+	const chrono::milliseconds& ttl)
+	: ttl_(ttl)
+{
+}
+
+MetadataCache::~MetadataCache()
+{
+}
+
+pplx::task<shared_ptr<void>> MetadataCache::GetAsync(
+	const string_t& link,
+	const Loader& load,
+	const SelfLinkOf& self_link_of)
+{
+	if (ttl_.count() == 0)
+	{
+		return load();
+	}
+
+	const string_t key = Normalize(link);
+	shared_ptr<Entry> stale;
+	pplx::task_completion_event<shared_ptr<void>> loaded;
+	shared_ptr<Loading> loading = make_shared<Loading>();
+	loading->task = pplx::create_task(loaded);
+	loading->invalidated = false;
+	{
+		lock_guard<mutex> lock(mutex_);
+		auto found = entries_.find(key);
+		if (found != entries_.end())
+		{
+			shared_ptr<Entry> entry = found->second;
+			if (!entry->refreshing && clock::now() - entry->loaded >= ttl_)
+			{
+				entry->refreshing = true;
+				stale = entry;
+			}
+
+			if (!stale)
+			{
+				return pplx::task_from_result(entry->resource);
+			}
+		}
+		else
+		{
+			auto pending = loading_.find(key);
+			if (pending != loading_.end())
+			{
+				return pending->second->task;
+			}
+
+			loading_[key] = loading;
+		}
+	}
+
+	if (stale)
+	{
+		shared_ptr<void> resource = stale->resource;
+		Refresh(stale);
+		return pplx::task_from_result(resource);
+	}
+
+	shared_ptr<MetadataCache> self = shared_from_this();
+	shared_ptr<Entry> entry = make_shared<Entry>();
+	entry->refreshing = false;
+	entry->links.push_back(key);
+	entry->load = load;
+	entry->self_link_of = self_link_of;
+
+	// Load outside of the lock, it may complete on this thread
+	pplx::task<shared_ptr<void>> load_task;
+	try
+	{
+		load_task = load();
+	}
+	catch (...)
+	{
+		load_task = pplx::task_from_exception<shared_ptr<void>>(current_exception());
+	}
+
+	load_task.then([self, key, entry, loading, loaded](pplx::task<shared_ptr<void>> resource_task)
+	{
+		try
+		{
+			entry->resource = resource_task.get();
+			entry->loaded = clock::now();
+			if (entry->self_link_of)
+			{
+				entry->links.push_back(Normalize(entry->self_link_of(entry->resource)));
+			}
+		}
+		catch (...)
+		{
+			{
+				lock_guard<mutex> lock(self->mutex_);
+				self->EraseLoading(key, loading);
+			}
+			loaded.set_exception(current_exception());
+			return;
+		}
+
+		{
+			// A resource read before its link was invalidated is returned, but
+			// not cached
+			lock_guard<mutex> lock(self->mutex_);
+			self->EraseLoading(key, loading);
+			if (!loading->invalidated)
+			{
+				self->Insert(entry);
+			}
+		}
+		loaded.set(entry->resource);
+	});
+
+	return pplx::create_task(loaded);
+}
+
+void MetadataCache::Refresh(
+	const shared_ptr<Entry>& entry)
+{
+	shared_ptr<MetadataCache> self = shared_from_this();
+	pplx::task<shared_ptr<void>> loading;
+	try
+	{
+		loading = entry->load();
+	}
+	catch (...)
+	{
+		loading = pplx::task_from_exception<shared_ptr<void>>(current_exception());
+	}
+
+	loading.then([self, entry](pplx::task<shared_ptr<void>> resource_task)
+	{
+		shared_ptr<void> resource;
+		try
+		{
+			resource = resource_task.get();
+		}
+		catch (...)
+		{
+			// The stale resource is served until a refresh succeeds, unless the
+			// failed request invalidated it
+			lock_guard<mutex> lock(self->mutex_);
+			entry->refreshing = false;
+			return;
+		}
+
+		lock_guard<mutex> lock(self->mutex_);
+		entry->refreshing = false;
+		auto found = self->entries_.find(entry->links.front());
+		if (found == self->entries_.end() || found->second != entry)
+		{
+			// Invalidated while refreshing
+			return;
+		}
+
+		shared_ptr<Entry> refreshed = make_shared<Entry>();
+		refreshed->resource = resource;
+		refreshed->loaded = clock::now();
+		refreshed->refreshing = false;
+		refreshed->links.push_back(entry->links.front());
+		refreshed->load = entry->load;
+		refreshed->self_link_of = entry->self_link_of;
+		self->Erase(entry);
+		self->entries_[refreshed->links.front()] = refreshed;
+		if (refreshed->self_link_of)
+		{
+			refreshed->links.push_back(Normalize(refreshed->self_link_of(resource)));
+			self->entries_[refreshed->links.back()] = refreshed;
+		}
+	});
+}
+
+void MetadataCache::Insert(
+	const shared_ptr<Entry>& entry)
+{
+	for (auto link = entry->links.begin(); link != entry->links.end(); ++link)
+	{
+		auto found = entries_.find(*link);
+		if (found != entries_.end() && found->second != entry)
+		{
+			Erase(found->second);
+		}
+		entries_[*link] = entry;
+	}
+}
+
+void MetadataCache::EraseLoading(
+	const string_t& key,
+	const shared_ptr<Loading>& loading)
+{
+	// An invalidated load may have been replaced by a newer one
+	auto found = loading_.find(key);
+	if (found != loading_.end() && found->second == loading)
+	{
+		loading_.erase(found);
+	}
+}
+
+void MetadataCache::Erase(
+	const shared_ptr<Entry>& entry)
+{
+	for (auto link = entry->links.begin(); link != entry->links.end(); ++link)
+	{
+		auto found = entries_.find(*link);
+		if (found != entries_.end() && found->second == entry)
+		{
+			entries_.erase(found);
+		}
+	}
+}
+
+void MetadataCache::Invalidate(
+	const string_t& link,
+	bool with_ancestors)
+{
+	const string_t key = Normalize(link);
+
+	// Nothing cached is under a document, so document writes and misses, the
+	// bulk of the requests, do not contend for the cache
+	if (!with_ancestors && IsDocumentLink(key))
+	{
+		return;
+	}
+
+	lock_guard<mutex> lock(mutex_);
+	for (auto iter = loading_.begin(); iter != loading_.end();)
+	{
+		if (Contains(key, iter->first) || (with_ancestors && Contains(iter->first, key)))
+		{
+			// Later lookups start a load of their own
+			iter->second->invalidated = true;
+			iter = loading_.erase(iter);
+		}
+		else
+		{
+			++iter;
+		}
+	}
+
+	if (entries_.empty())
+	{
+		return;
+	}
+
+	vector<shared_ptr<Entry>> invalidated;
+	for (auto iter = entries_.begin(); iter != entries_.end(); ++iter)
+	{
+		if (Contains(key, iter->first) || (with_ancestors && Contains(iter->first, key)))
+		{
+			invalidated.push_back(iter->second);
+		}
+	}
+
+	for (auto entry = invalidated.begin(); entry != invalidated.end(); ++entry)
+	{
+		Erase(*entry);
+	}
+}
+
+void MetadataCache::Clear()
+{
+	lock_guard<mutex> lock(mutex_);
+	for (auto iter = loading_.begin(); iter != loading_.end(); ++iter)
+	{
+		iter->second->invalidated = true;
+	}
+	loading_.clear();
+	entries_.clear();
+}
+
+size_t MetadataCache::count() const
+{
+	lock_guard<mutex> lock(mutex_);
+	size_t count = 0;
+	for (auto iter = entries_.begin(); iter != entries_.end(); ++iter)
+	{
+		// Counted once, under the link it was read from
+		if (iter->first == iter->second->links.front())
+		{
+			count++;
+		}
+	}
+	return count;
+}
+
+string_t MetadataCache::Normalize(
+	const string_t& link)
+{
+	size_t begin = link.find_first_not_of(_XPLATSTR('/'));
+	if (begin == string_t::npos)
+	{
+		return string_t();
+	}
+
+	size_t end = link.find_last_not_of(_XPLATSTR('/'));
+	return link.substr(begin, end - begin + 1);
+}
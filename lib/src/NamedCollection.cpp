@@ -0,0 +1,231 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#include "NamedCollection.h"
+
+#include <cpprest/http_client.h>
+
+#include "Collection.h"
+#include "ConnectionHelper.h"
+#include "DocumentDBConstants.h"
+#include "exceptions.h"
+
+using namespace documentdb;
+using namespace std;
+using namespace utility;
+using namespace web::http;
+using namespace web::json;
+
+NamedCollection::NamedCollection(
+		const shared_ptr<const DocumentDBConfiguration>& document_db_configuration,
+		const string_t& database_id,
+		const string_t& collection_id)
+	: document_db_configuration_(document_db_configuration)
+	, database_id_(database_id)
+	, collection_id_(collection_id)
+{
+	const string_t separator = _XPLATSTR("/");
+	link_ = RESOURCE_PATH_DBS + separator + database_id + separator + RESOURCE_PATH_COLLS + separator + collection_id;
+	uri_ = RESOURCE_PATH_DBS + separator + web::uri::encode_data_string(database_id)
+		+ separator + RESOURCE_PATH_COLLS + separator + web::uri::encode_data_string(collection_id);
+}
+
+NamedCollection::~NamedCollection()
+{
+}
+
+NamedCollection NamedCollection::WithDiagnosticsHandler(
+	const function<void(const ResponseDiagnostics&)>& diagnostics_handler) const
+{
+	return NamedCollection(
+		document_db_configuration_->WithDiagnosticsHandler(diagnostics_handler),
+		database_id_,
+		collection_id_);
+}
+
+string_t NamedCollection::DocumentLink(
+	const string_t& id) const
+{
+	return link_ + _XPLATSTR("/") + RESOURCE_PATH_DOCS + _XPLATSTR("/") + id;
+}
+
+string_t NamedCollection::DocumentUri(
+	const string_t& id) const
+{
+	return uri_ + _XPLATSTR("/") + RESOURCE_PATH_DOCS + _XPLATSTR("/") + web::uri::encode_data_string(id);
+}
+
+pplx::task<shared_ptr<Document>> NamedCollection::GetDocumentAsync(
+	const string_t& id,
+	const PartitionKey& partition_key) const
+{
+	shared_ptr<const DocumentDBConfiguration> config = document_db_configuration_;
+	const string_t link = DocumentLink(id);
+	const string_t uri = DocumentUri(id);
+
+	return ExecuteRequestAsync(*config, [=]()
+	{
+		http_request request = CreateRequest(
+			methods::GET,
+			RESOURCE_PATH_DOCS,
+			link,
+			config->request_signer(),
+			true);
+		request.set_request_uri(uri);
+		SetPartitionKey(request, partition_key);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
+	{
+		if (response.status_code() == status_codes::OK)
+		{
+			return make_shared<Document>(config, response.shared_json());
+		}
+
+		ThrowExceptionFromResponse(response.status_code(), response.json());
+	});
+}
+
+shared_ptr<Document> NamedCollection::GetDocument(
+	const string_t& id,
+	const PartitionKey& partition_key) const
+{
+	return this->GetDocumentAsync(id, partition_key).get();
+}
+
+pplx::task<shared_ptr<Document>> NamedCollection::CreateDocumentAsync(
+	const value& document,
+	const PartitionKey& partition_key) const
+{
+	shared_ptr<const DocumentDBConfiguration> config = document_db_configuration_;
+	const string_t link = link_;
+	const string_t uri = uri_ + _XPLATSTR("/") + RESOURCE_PATH_DOCS;
+	shared_ptr<const string_t> body = make_shared<const string_t>(Collection::SerializeNewDocument(document));
+
+	return ExecuteRequestAsync(*config, [=]()
+	{
+		http_request request = CreateRequest(
+			methods::POST,
+			RESOURCE_PATH_DOCS,
+			link,
+			config->request_signer(),
+			true);
+		request.set_request_uri(uri);
+		SetPartitionKey(request, partition_key);
+
+		request.set_body(*body, MIME_TYPE_APPLICATION_JSON);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
+	{
+		if (response.status_code() == status_codes::Created)
+		{
+			return make_shared<Document>(config, response.shared_json());
+		}
+
+		ThrowExceptionFromResponse(response.status_code(), response.json());
+	});
+}
+
+shared_ptr<Document> NamedCollection::CreateDocument(
+	const value& document,
+	const PartitionKey& partition_key) const
+{
+	return this->CreateDocumentAsync(document, partition_key).get();
+}
+
+pplx::task<shared_ptr<Document>> NamedCollection::ReplaceDocumentAsync(
+	const string_t& id,
+	const value& document,
+	const PartitionKey& partition_key) const
+{
+	shared_ptr<const DocumentDBConfiguration> config = document_db_configuration_;
+	const string_t link = DocumentLink(id);
+	const string_t uri = DocumentUri(id);
+	shared_ptr<const string_t> body = make_shared<const string_t>(Collection::SerializeNewDocument(document));
+
+	return ExecuteRequestAsync(*config, [=]()
+	{
+		http_request request = CreateRequest(
+			methods::PUT,
+			RESOURCE_PATH_DOCS,
+			link,
+			config->request_signer(),
+			true);
+		request.set_request_uri(uri);
+		SetPartitionKey(request, partition_key);
+
+		request.set_body(*body, MIME_TYPE_APPLICATION_JSON);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
+	{
+		if (response.status_code() == status_codes::OK)
+		{
+			return make_shared<Document>(config, response.shared_json());
+		}
+
+		ThrowExceptionFromResponse(response.status_code(), response.json());
+	});
+}
+
+shared_ptr<Document> NamedCollection::ReplaceDocument(
+	const string_t& id,
+	const value& document,
+	const PartitionKey& partition_key) const
+{
+	return this->ReplaceDocumentAsync(id, document, partition_key).get();
+}
+
+pplx::task<void> NamedCollection::DeleteDocumentAsync(
+	const string_t& id,
+	const PartitionKey& partition_key) const
+{
+	shared_ptr<const DocumentDBConfiguration> config = document_db_configuration_;
+	const string_t link = DocumentLink(id);
+	const string_t uri = DocumentUri(id);
+
+	return ExecuteRequestAsync(*config, [=]()
+	{
+		http_request request = CreateRequest(
+			methods::DEL,
+			RESOURCE_PATH_DOCS,
+			link,
+			config->request_signer(),
+			true);
+		request.set_request_uri(uri);
+		SetPartitionKey(request, partition_key);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
+	{
+		if (response.status_code() != status_codes::NoContent)
+		{
+			ThrowExceptionFromResponse(response.status_code(), response.json());
+		}
+	});
+}
+
+void NamedCollection::DeleteDocument(
+	const string_t& id,
+	const PartitionKey& partition_key) const
+{
+	this->DeleteDocumentAsync(id, partition_key).get();
+}
@@ -0,0 +1,418 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#include "ParallelQuery.h"
+
+#include <algorithm>
+#include <queue>
+
+#include "Collection.h"
+#include "ConnectionHelper.h"
+#include "DocumentDBConstants.h"
+#include "exceptions.h"
+
+using namespace documentdb;
+using namespace std;
+using namespace utility;
+using namespace web::http;
+using namespace web::json;
+
+namespace
+{
+	// Property names along a path such as /address/city.
+	vector<string_t> SplitPath(
+		const string_t& path)
+	{
+		vector<string_t> segments;
+		size_t position = 0;
+		while (position < path.size())
+		{
+			size_t end = min(path.find(_XPLATSTR('/'), position), path.size());
+			if (end > position)
+			{
+				segments.push_back(path.substr(position, end - position));
+			}
+			position = end + 1;
+		}
+		return segments;
+	}
+
+	// Null if the result lacks the property, which sorts it first.
+	const value* FindProperty(
+		const value& result,
+		const vector<string_t>& segments)
+	{
+		const value* property = &result;
+		for (auto iter = segments.cbegin(); iter != segments.cend(); ++iter)
+		{
+			if (!property->is_object() || !property->has_field(*iter))
+			{
+				return nullptr;
+			}
+			property = &property->at(*iter);
+		}
+		return property;
+	}
+
+	int TypeRank(
+		const value* property)
+	{
+		if (property == nullptr)
+		{
+			return 0;
+		}
+
+		switch (property->type())
+		{
+		case value::Null:
+			return 1;
+		case value::Boolean:
+			return 2;
+		case value::Number:
+			return 3;
+		case value::String:
+			return 4;
+		default:
+			return 5;
+		}
+	}
+
+	// Orders as the service does: undefined, null, booleans, numbers, strings.
+	int CompareProperties(
+		const value* left,
+		const value* right)
+	{
+		int left_rank = TypeRank(left);
+		int right_rank = TypeRank(right);
+		if (left_rank != right_rank)
+		{
+			return left_rank < right_rank ? -1 : 1;
+		}
+
+		switch (left_rank)
+		{
+		case 2:
+			return (int)left->as_bool() - (int)right->as_bool();
+		case 3:
+			return left->as_double() < right->as_double() ? -1 : (right->as_double() < left->as_double() ? 1 : 0);
+		case 4:
+			return left->as_string().compare(right->as_string());
+		default:
+			return 0;
+		}
+	}
+
+	bool IsIdentifierCharacter(
+		char_t character)
+	{
+		return (character >= _XPLATSTR('a') && character <= _XPLATSTR('z'))
+			|| (character >= _XPLATSTR('A') && character <= _XPLATSTR('Z'))
+			|| (character >= _XPLATSTR('0') && character <= _XPLATSTR('9'))
+			|| character == _XPLATSTR('_')
+			|| character == _XPLATSTR('.');
+	}
+
+	// Whether the query calls AVG outside of its string literals.
+	bool CallsAverage(
+		const string_t& query)
+	{
+		static const string_t name = _XPLATSTR("avg");
+		for (size_t i = 0; i < query.size(); i++)
+		{
+			char_t character = query[i];
+			if (character == _XPLATSTR('\'') || character == _XPLATSTR('"'))
+			{
+				for (i++; i < query.size() && query[i] != character; i++)
+				{
+					if (query[i] == _XPLATSTR('\\'))
+					{
+						i++;
+					}
+				}
+				continue;
+			}
+
+			if (i > 0 && IsIdentifierCharacter(query[i - 1]))
+			{
+				continue;
+			}
+
+			size_t end = i;
+			while (end < query.size() && end - i < name.size()
+				&& (query[end] == name[end - i] || query[end] - _XPLATSTR('A') + _XPLATSTR('a') == name[end - i]))
+			{
+				end++;
+			}
+			if (end - i < name.size())
+			{
+				continue;
+			}
+
+			while (end < query.size() && (query[end] == _XPLATSTR(' ') || query[end] == _XPLATSTR('\t')
+				|| query[end] == _XPLATSTR('\r') || query[end] == _XPLATSTR('\n')))
+			{
+				end++;
+			}
+			if (end < query.size() && query[end] == _XPLATSTR('('))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	vector<value> MergeAggregate(
+		const vector<vector<value>>& range_results,
+		QueryAggregate aggregate)
+	{
+		// Ranges without any matching document return no value
+		vector<value> merged;
+		for (auto range = range_results.cbegin(); range != range_results.cend(); ++range)
+		{
+			for (auto result = range->cbegin(); result != range->cend(); ++result)
+			{
+				if (merged.empty())
+				{
+					merged.push_back(*result);
+					continue;
+				}
+
+				value& total = merged.front();
+				switch (aggregate)
+				{
+				case AGGREGATE_COUNT:
+				case AGGREGATE_SUM:
+					if (total.is_integer() && result->is_integer())
+					{
+						total = value::number(total.as_number().to_int64() + result->as_number().to_int64());
+					}
+					else
+					{
+						total = value::number(total.as_double() + result->as_double());
+					}
+					break;
+				case AGGREGATE_MIN:
+					if (CompareProperties(&*result, &total) < 0)
+					{
+						total = *result;
+					}
+					break;
+				case AGGREGATE_MAX:
+					if (CompareProperties(&*result, &total) > 0)
+					{
+						total = *result;
+					}
+					break;
+				default:
+					break;
+				}
+			}
+		}
+		return merged;
+	}
+}
+
+ParallelQuery::ParallelQuery(
+	const shared_ptr<const Collection>& collection,
+	const SqlQuerySpec& query,
+	const ParallelQueryOptions& options,
+	const vector<PartitionKeyRange>& ranges)
+	: collection_(collection)
+	, query_(query)
+	, options_(options)
+	, ranges_(ranges)
+	, next_range_(0)
+	, failed_(false)
+	, range_results_(ranges.size())
+{
+	// The ranges would each return their own average, without the count needed
+	// to combine them
+	if (CallsAverage(query.query()))
+	{
+		throw DocumentDBRuntimeException(_XPLATSTR("AVG is not supported by parallel queries, query SUM and COUNT instead"));
+	}
+}
+
+ParallelQuery::~ParallelQuery()
+{}
+
+pplx::task<vector<value>> ParallelQuery::RunAsync()
+{
+	size_t workers = options_.max_degree_of_parallelism();
+	if (workers == 0 || workers > ranges_.size())
+	{
+		workers = ranges_.size();
+	}
+
+	vector<pplx::task<void>> running;
+	for (size_t i = 0; i < workers; i++)
+	{
+		running.push_back(RunWorkerAsync());
+	}
+
+	shared_ptr<ParallelQuery> self = shared_from_this();
+	return pplx::when_all(running.begin(), running.end()).then([self]()
+	{
+		return Merge(move(self->range_results_), self->options_);
+	});
+}
+
+pplx::task<void> ParallelQuery::RunWorkerAsync()
+{
+	size_t range;
+	{
+		lock_guard<mutex> lock(mutex_);
+		if (failed_ || next_range_ == ranges_.size())
+		{
+			return pplx::task_from_result();
+		}
+		range = next_range_++;
+	}
+
+	shared_ptr<ParallelQuery> self = shared_from_this();
+	return QueryRangeAsync(range, string_t()).then([self](pplx::task<void> queried)
+	{
+		try
+		{
+			queried.get();
+		}
+		catch (...)
+		{
+			self->failed_ = true;
+			throw;
+		}
+		return self->RunWorkerAsync();
+	});
+}
+
+pplx::task<void> ParallelQuery::QueryRangeAsync(
+	size_t range,
+	const string_t& continuation)
+{
+	shared_ptr<ParallelQuery> self = shared_from_this();
+	shared_ptr<const Collection> collection = collection_;
+	const string_t request_uri = collection->self() + collection->docs();
+
+	return ExecuteRequestAsync(*collection->document_db_configuration(), [=]()
+	{
+		http_request request = CreateQueryRequest(
+			self->query_,
+			self->options_.page_size(),
+			RESOURCE_PATH_DOCS,
+			collection->resource_id(),
+			collection->document_db_configuration()->request_signer(),
+			continuation,
+			false,
+			true);
+		request.headers().add(HEADER_MS_DOCUMENTDB_PARTITIONKEYRANGEID, self->ranges_[range].id());
+		request.set_request_uri(request_uri);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
+	{
+		const value& json_response = response.json();
+		if (response.status_code() != status_codes::OK)
+		{
+			ThrowExceptionFromResponse(response.status_code(), json_response);
+		}
+
+		vector<value>& results = self->range_results_[range];
+		const web::json::array& items = json_response.at(RESPONSE_QUERY_DOCUMENTS).as_array();
+		results.insert(results.end(), items.begin(), items.end());
+
+		// No range contributes more than top results to the merge
+		string_t next = response.header(HEADER_MS_CONTINUATION);
+		size_t top = self->options_.top();
+		if (next.empty()
+			|| self->failed_
+			|| (top != 0 && self->options_.aggregate() == AGGREGATE_NONE && results.size() >= top))
+		{
+			return pplx::task_from_result();
+		}
+
+		return self->QueryRangeAsync(range, next);
+	});
+}
+
+vector<value> ParallelQuery::Merge(
+	vector<vector<value>>&& range_results,
+	const ParallelQueryOptions& options)
+{
+	if (options.aggregate() != AGGREGATE_NONE)
+	{
+		return MergeAggregate(range_results, options.aggregate());
+	}
+
+	size_t top = options.top() != 0 ? options.top() : (size_t)-1;
+	vector<value> merged;
+
+	if (options.order_by().empty())
+	{
+		for (auto range = range_results.begin(); range != range_results.end() && merged.size() < top; ++range)
+		{
+			for (auto result = range->begin(); result != range->end() && merged.size() < top; ++result)
+			{
+				merged.push_back(move(*result));
+			}
+		}
+		return merged;
+	}
+
+	// k-way merge of the sorted ranges, heads compared on the ORDER BY property.
+	// Ties go to the earlier range so that the merge is deterministic.
+	vector<string_t> segments = SplitPath(options.order_by());
+	bool descending = options.descending();
+	vector<size_t> positions(range_results.size(), 0);
+	auto after = [&](size_t left, size_t right)
+	{
+		int order = CompareProperties(
+			FindProperty(range_results[left][positions[left]], segments),
+			FindProperty(range_results[right][positions[right]], segments));
+		if (descending)
+		{
+			order = -order;
+		}
+		return order != 0 ? order > 0 : left > right;
+	};
+
+	priority_queue<size_t, vector<size_t>, decltype(after)> heads(after);
+	for (size_t range = 0; range < range_results.size(); range++)
+	{
+		if (!range_results[range].empty())
+		{
+			heads.push(range);
+		}
+	}
+
+	while (!heads.empty() && merged.size() < top)
+	{
+		size_t range = heads.top();
+		heads.pop();
+		merged.push_back(move(range_results[range][positions[range]]));
+		if (++positions[range] < range_results[range].size())
+		{
+			heads.push(range);
+		}
+	}
+	return merged;
+}
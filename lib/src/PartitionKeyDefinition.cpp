@@ -0,0 +1,146 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#include "PartitionKeyDefinition.h"
+
+#include "DocumentDBConstants.h"
+#include "exceptions.h"
+
+using namespace documentdb;
+using namespace std;
+using namespace utility;
+using namespace web::json;
+
+namespace
+{
+	// "/address/city" and "/\"first name\"" into their property names.
+	vector<string_t> SplitPath(
+		const string_t& path)
+	{
+		vector<string_t> segments;
+		size_t position = 0;
+		while (position < path.size())
+		{
+			if (path[position] != _XPLATSTR('/'))
+			{
+				throw DocumentDBRuntimeException(_XPLATSTR("Invalid partition key path: ") + path);
+			}
+			position++;
+
+			size_t end;
+			if (position < path.size() && path[position] == _XPLATSTR('"'))
+			{
+				end = path.find(_XPLATSTR('"'), position + 1);
+				if (end == string_t::npos)
+				{
+					throw DocumentDBRuntimeException(_XPLATSTR("Invalid partition key path: ") + path);
+				}
+				segments.push_back(path.substr(position + 1, end - position - 1));
+				end++;
+			}
+			else
+			{
+				end = min(path.find(_XPLATSTR('/'), position), path.size());
+				segments.push_back(path.substr(position, end - position));
+			}
+
+			if (segments.back().empty())
+			{
+				throw DocumentDBRuntimeException(_XPLATSTR("Invalid partition key path: ") + path);
+			}
+			position = end;
+		}
+		return segments;
+	}
+}
+
+PartitionKeyDefinition::PartitionKeyDefinition()
+{
+}
+
+PartitionKeyDefinition::PartitionKeyDefinition(
+	const string_t& path)
+	: path_(path)
+	, kind_(PARTITION_KEY_KIND_HASH)
+	, segments_(SplitPath(path))
+{
+	if (segments_.empty())
+	{
+		throw DocumentDBRuntimeException(_XPLATSTR("Invalid partition key path: ") + path);
+	}
+}
+
+PartitionKeyDefinition::~PartitionKeyDefinition()
+{}
+
+PartitionKeyDefinition PartitionKeyDefinition::FromJson(
+	const value& json_payload)
+{
+	const web::json::array& paths = json_payload.at(RESPONSE_PARTITION_KEY_PATHS).as_array();
+	if (paths.size() != 1)
+	{
+		throw DocumentDBRuntimeException(_XPLATSTR("Unsupported partition key: ") + json_payload.serialize());
+	}
+
+	PartitionKeyDefinition definition(paths.at(0).as_string());
+	if (json_payload.has_field(RESPONSE_PARTITION_KEY_KIND))
+	{
+		definition.kind_ = json_payload.at(RESPONSE_PARTITION_KEY_KIND).as_string();
+	}
+	return definition;
+}
+
+value PartitionKeyDefinition::ToJson() const
+{
+	value json_payload;
+	json_payload[RESPONSE_PARTITION_KEY_PATHS] = value::array(1);
+	json_payload[RESPONSE_PARTITION_KEY_PATHS][0] = value::string(path_);
+	json_payload[RESPONSE_PARTITION_KEY_KIND] = value::string(kind_);
+	return json_payload;
+}
+
+PartitionKey PartitionKeyDefinition::Extract(
+	const value& document) const
+{
+	if (segments_.empty())
+	{
+		return PartitionKey();
+	}
+
+	const value* property = &document;
+	for (auto iter = segments_.cbegin(); iter != segments_.cend(); ++iter)
+	{
+		if (!property->is_object() || !property->has_field(*iter))
+		{
+			return PartitionKey::Undefined();
+		}
+		property = &property->at(*iter);
+	}
+
+	if (property->is_object() || property->is_array())
+	{
+		return PartitionKey::Undefined();
+	}
+	return PartitionKey(*property);
+}
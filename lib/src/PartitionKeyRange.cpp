@@ -0,0 +1,54 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#include "PartitionKeyRange.h"
+
+#include "DocumentDBConstants.h"
+
+using namespace documentdb;
+using namespace std;
+using namespace utility;
+using namespace web::json;
+
+PartitionKeyRange::PartitionKeyRange(
+	const string_t& id,
+	const string_t& min_inclusive,
+	const string_t& max_exclusive)
+	: id_(id)
+	, min_inclusive_(min_inclusive)
+	, max_exclusive_(max_exclusive)
+{
+}
+
+PartitionKeyRange::~PartitionKeyRange()
+{}
+
+PartitionKeyRange PartitionKeyRange::FromJson(
+	const value& json_payload)
+{
+	return PartitionKeyRange(
+		json_payload.at(DOCUMENT_ID).as_string(),
+		json_payload.at(RESPONSE_PARTITION_KEY_RANGE_MIN).as_string(),
+		json_payload.at(RESPONSE_PARTITION_KEY_RANGE_MAX).as_string());
+}
@@ -0,0 +1,107 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#include "PreparedQuery.h"
+
+#include "DocumentDBConstants.h"
+#include "exceptions.h"
+
+using namespace documentdb;
+using namespace std;
+using namespace utility;
+using namespace web::json;
+
+namespace
+{
+	string_t Quote(
+		const string_t& text)
+	{
+		return value::string(text).serialize();
+	}
+
+	string_t ParameterPrefix(
+		const string_t& name)
+	{
+		return _XPLATSTR("{") + Quote(QUERY_SPEC_NAME) + _XPLATSTR(":") + Quote(name)
+			+ _XPLATSTR(",") + Quote(QUERY_SPEC_VALUE) + _XPLATSTR(":");
+	}
+}
+
+PreparedQuery::PreparedQuery(
+	const string_t& query,
+	const vector<string_t>& parameter_names)
+	: query_(query)
+	, parameter_names_(parameter_names)
+{
+	// {"query":"...","parameters":[{"name":"@a","value":<a>},{"name":"@b","value":<b>}]}
+	string_t segment = _XPLATSTR("{") + Quote(QUERY_SPEC_QUERY) + _XPLATSTR(":") + Quote(query)
+		+ _XPLATSTR(",") + Quote(QUERY_SPEC_PARAMETERS) + _XPLATSTR(":[");
+	for (size_t i = 0; i < parameter_names.size(); i++)
+	{
+		if (i > 0)
+		{
+			segment += _XPLATSTR("},");
+		}
+		segment += ParameterPrefix(parameter_names[i]);
+		segments_.push_back(segment);
+		segment.clear();
+	}
+	segment += parameter_names.empty() ? _XPLATSTR("]}") : _XPLATSTR("}]}");
+	segments_.push_back(segment);
+}
+
+PreparedQuery::~PreparedQuery()
+{}
+
+SqlQuerySpec PreparedQuery::Bind(
+	const vector<value>& values) const
+{
+	if (values.size() != parameter_names_.size())
+	{
+		throw DocumentDBRuntimeException(_XPLATSTR("Expected a value for every parameter of the prepared query"));
+	}
+
+	vector<string_t> encoded;
+	encoded.reserve(values.size());
+	size_t size = segments_.back().size();
+	for (size_t i = 0; i < values.size(); i++)
+	{
+		encoded.push_back(values[i].serialize());
+		size += segments_[i].size() + encoded.back().size();
+	}
+
+	string_t body;
+	body.reserve(size);
+	vector<SqlParameter> parameters;
+	parameters.reserve(values.size());
+	for (size_t i = 0; i < values.size(); i++)
+	{
+		body += segments_[i];
+		body += encoded[i];
+		parameters.push_back(SqlParameter(parameter_names_[i], values[i]));
+	}
+	body += segments_.back();
+
+	return SqlQuerySpec(query_, parameters, move(body));
+}
@@ -0,0 +1,186 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#include "QueryPager.h"
+
+#include "ConnectionHelper.h"
+#include "DocumentDBConstants.h"
+#include "exceptions.h"
+
+using namespace documentdb;
+using namespace std;
+using namespace utility;
+using namespace web::http;
+using namespace web::json;
+
+QueryPager::QueryPager(
+	const PageFetcher& fetch_page,
+	const string_t& items_field,
+	const string_t& continuation,
+	size_t prefetch_pages,
+	size_t prefetch_max_bytes)
+	: fetch_page_(fetch_page)
+	, items_field_(items_field)
+	, continuation_(continuation)
+	, prefetch_pages_(prefetch_pages)
+	, prefetch_max_bytes_(prefetch_max_bytes)
+	, fetching_(false)
+	, done_(continuation.empty())
+	, buffered_bytes_(0)
+{
+}
+
+QueryPager::~QueryPager()
+{
+}
+
+void QueryPager::Prefetch()
+{
+	lock_guard<mutex> lock(mutex_);
+	FetchIfRoom();
+}
+
+pplx::task<QueryPager::Page> QueryPager::NextPageAsync()
+{
+	lock_guard<mutex> lock(mutex_);
+	if (!pages_.empty())
+	{
+		Page page = pages_.front();
+		pages_.pop_front();
+		buffered_bytes_ -= (size_t)page.diagnostics.response_size();
+		FetchIfRoom();
+		return pplx::task_from_result(page);
+	}
+
+	if (error_)
+	{
+		exception_ptr error = error_;
+		error_ = nullptr;
+		return pplx::task_from_exception<Page>(error);
+	}
+
+	if (done_ && !fetching_)
+	{
+		return pplx::task_from_result(Page());
+	}
+
+	waiter_ = make_shared<pplx::task_completion_event<Page>>();
+	pplx::task<Page> page_task(*waiter_);
+	FetchIfRoom();
+	return page_task;
+}
+
+void QueryPager::FetchIfRoom()
+{
+	if (fetching_ || done_ || error_)
+	{
+		return;
+	}
+
+	// A waiting consumer always gets its page, prefetching stops at the limits
+	if (!waiter_
+		&& (pages_.size() >= prefetch_pages_ || buffered_bytes_ >= prefetch_max_bytes_))
+	{
+		return;
+	}
+
+	fetching_ = true;
+	shared_ptr<QueryPager> self = shared_from_this();
+	pplx::task<DocumentDBResponse> response_task;
+	try
+	{
+		response_task = fetch_page_(continuation_);
+	}
+	catch (...)
+	{
+		response_task = pplx::task_from_exception<DocumentDBResponse>(current_exception());
+	}
+
+	response_task.then([self](pplx::task<DocumentDBResponse> completed_task)
+	{
+		self->OnFetched(completed_task);
+	});
+}
+
+void QueryPager::OnFetched(
+	const pplx::task<DocumentDBResponse>& response_task)
+{
+	Page page;
+	exception_ptr error;
+	string_t continuation;
+	try
+	{
+		DocumentDBResponse response = response_task.get();
+		if (response.status_code() != status_codes::OK)
+		{
+			ThrowExceptionFromResponse(response.status_code(), response.json());
+		}
+
+		page.json = response.shared_json();
+		page.items = &page.json->at(items_field_).as_array();
+		page.diagnostics = response.diagnostics();
+		continuation = response.header(HEADER_MS_CONTINUATION);
+	}
+	catch (...)
+	{
+		error = current_exception();
+	}
+
+	shared_ptr<pplx::task_completion_event<Page>> waiter;
+	{
+		lock_guard<mutex> lock(mutex_);
+		fetching_ = false;
+		waiter.swap(waiter_);
+
+		if (error)
+		{
+			// Reported to the consumer, which may ask again to retry the same page
+			if (!waiter)
+			{
+				error_ = error;
+			}
+		}
+		else
+		{
+			continuation_ = continuation;
+			done_ = continuation.empty();
+			if (!waiter)
+			{
+				pages_.push_back(page);
+				buffered_bytes_ += (size_t)page.diagnostics.response_size();
+			}
+		}
+
+		FetchIfRoom();
+	}
+
+	if (waiter && error)
+	{
+		waiter->set_exception(error);
+	}
+	else if (waiter)
+	{
+		waiter->set(page);
+	}
+}
@@ -0,0 +1,84 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#include "RequestLimiter.h"
+
+using namespace documentdb;
+using namespace std;
+
+RequestLimiter::RequestLimiter(
+	size_t limit)
+	: limit_(limit)
+	, in_flight_(0)
+{
+}
+
+RequestLimiter::~RequestLimiter()
+{
+}
+
+pplx::task<void> RequestLimiter::AcquireAsync()
+{
+	if (limit_ == 0)
+	{
+		return pplx::task_from_result();
+	}
+
+	pplx::task_completion_event<void> waiter;
+	{
+		lock_guard<mutex> lock(mutex_);
+		if (in_flight_ < limit_)
+		{
+			++in_flight_;
+			return pplx::task_from_result();
+		}
+		waiters_.push_back(waiter);
+	}
+
+	return pplx::task<void>(waiter);
+}
+
+void RequestLimiter::Release()
+{
+	if (limit_ == 0)
+	{
+		return;
+	}
+
+	pplx::task_completion_event<void> waiter;
+	{
+		lock_guard<mutex> lock(mutex_);
+		if (waiters_.empty())
+		{
+			--in_flight_;
+			return;
+		}
+
+		// Slot is handed over to the next waiter, in_flight_ stays the same
+		waiter = waiters_.front();
+		waiters_.pop_front();
+	}
+
+	waiter.set();
+}
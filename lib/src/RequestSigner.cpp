@@ -0,0 +1,255 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#include "RequestSigner.h"
+
+#include "hmac_bcrypt.h"
+#include "SignatureCache.h"
+
+using namespace documentdb;
+using namespace std;
+using namespace utility;
+
+namespace
+{
+	const char BASE64_ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+	// "type=master&ver=1.0&sig=", url encoded the same way uri::encode_data_string does
+	const char_t AUTHORIZATION_PREFIX[] = _XPLATSTR("type%3Dmaster%26ver%3D1.0%26sig%3D");
+
+	// Feeds lower cased, UTF-8 encoded text into the hash through a small stack buffer,
+	// so the string to sign never exists as a whole. Text written with lower_case
+	// false keeps its case.
+	class LowerCaseWriter
+	{
+	public:
+		explicit LowerCaseWriter(
+			HmacSha256::Context& context)
+			: context_(context)
+			, size_(0)
+		{
+		}
+
+		void Write(
+			const string_t& text,
+			bool lower_case = true)
+		{
+#ifdef _UTF16_STRINGS
+			for (size_t i = 0; i < text.size(); ++i)
+			{
+				unsigned long code_point = text[i];
+				if (code_point >= 0xD800 && code_point <= 0xDBFF && i + 1 < text.size())
+				{
+					code_point = 0x10000 + ((code_point - 0xD800) << 10) + (text[++i] - 0xDC00);
+				}
+				Put(code_point, lower_case);
+			}
+#else
+			for (string_t::const_iterator iter = text.cbegin(); iter != text.cend(); ++iter)
+			{
+				char c = *iter;
+				Byte(static_cast<unsigned char>(lower_case && c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c));
+			}
+#endif
+		}
+
+		void Write(
+			const char* text)
+		{
+			while (*text)
+			{
+				Byte(static_cast<unsigned char>(*text++));
+			}
+		}
+
+		void Flush()
+		{
+			context_.Update(buffer_, size_);
+			size_ = 0;
+		}
+
+	private:
+#ifdef _UTF16_STRINGS
+		void Put(
+			unsigned long code_point,
+			bool lower_case)
+		{
+			if (code_point < 0x80)
+			{
+				Byte(static_cast<unsigned char>(lower_case && code_point >= 'A' && code_point <= 'Z' ? code_point - 'A' + 'a' : code_point));
+			}
+			else if (code_point < 0x800)
+			{
+				Byte(static_cast<unsigned char>(0xC0 | (code_point >> 6)));
+				Byte(static_cast<unsigned char>(0x80 | (code_point & 0x3F)));
+			}
+			else if (code_point < 0x10000)
+			{
+				Byte(static_cast<unsigned char>(0xE0 | (code_point >> 12)));
+				Byte(static_cast<unsigned char>(0x80 | ((code_point >> 6) & 0x3F)));
+				Byte(static_cast<unsigned char>(0x80 | (code_point & 0x3F)));
+			}
+			else
+			{
+				Byte(static_cast<unsigned char>(0xF0 | (code_point >> 18)));
+				Byte(static_cast<unsigned char>(0x80 | ((code_point >> 12) & 0x3F)));
+				Byte(static_cast<unsigned char>(0x80 | ((code_point >> 6) & 0x3F)));
+				Byte(static_cast<unsigned char>(0x80 | (code_point & 0x3F)));
+			}
+		}
+#endif
+
+		void Byte(
+			unsigned char b)
+		{
+			if (size_ == sizeof(buffer_))
+			{
+				Flush();
+			}
+			buffer_[size_++] = b;
+		}
+
+		HmacSha256::Context& context_;
+		unsigned char buffer_[128];
+		size_t size_;
+	};
+
+	void ToBase64(
+		const unsigned char* data,
+		size_t size,
+		char_t* output)
+	{
+		size_t i = 0;
+		for (; i + 2 < size; i += 3)
+		{
+			*output++ = BASE64_ALPHABET[data[i] >> 2];
+			*output++ = BASE64_ALPHABET[((data[i] & 0x03) << 4) | (data[i + 1] >> 4)];
+			*output++ = BASE64_ALPHABET[((data[i + 1] & 0x0F) << 2) | (data[i + 2] >> 6)];
+			*output++ = BASE64_ALPHABET[data[i + 2] & 0x3F];
+		}
+
+		if (i + 1 == size)
+		{
+			*output++ = BASE64_ALPHABET[data[i] >> 2];
+			*output++ = BASE64_ALPHABET[(data[i] & 0x03) << 4];
+			*output++ = _XPLATSTR('=');
+			*output++ = _XPLATSTR('=');
+		}
+		else if (i + 2 == size)
+		{
+			*output++ = BASE64_ALPHABET[data[i] >> 2];
+			*output++ = BASE64_ALPHABET[((data[i] & 0x03) << 4) | (data[i + 1] >> 4)];
+			*output++ = BASE64_ALPHABET[(data[i + 1] & 0x0F) << 2];
+			*output++ = _XPLATSTR('=');
+		}
+	}
+}
+
+RequestSigner::RequestSigner(
+	const vector<unsigned char>& master_key)
+	: hmac_(new HmacSha256(master_key.empty() ? nullptr : &master_key[0], master_key.size()))
+	, signature_cache_(new SignatureCache())
+{
+}
+
+RequestSigner::~RequestSigner()
+{
+}
+
+void RequestSigner::Sign(
+	const string_t& verb,
+	const string_t& resource_type,
+	const string_t& resource_link,
+	const string_t& date,
+	char_t* signature,
+	bool name_based_link) const
+{
+	HmacSha256::Context context(*hmac_);
+	LowerCaseWriter writer(context);
+
+	writer.Write(verb);
+	writer.Write("\n");
+	writer.Write(resource_type);
+	writer.Write("\n");
+	writer.Write(resource_link, !name_based_link);
+	writer.Write("\n");
+	writer.Write(date);
+	writer.Write("\n\n");
+	writer.Flush();
+
+	unsigned char digest[HmacSha256::DIGEST_LENGTH];
+	context.Final(digest);
+
+	ToBase64(digest, sizeof(digest), signature);
+}
+
+string_t RequestSigner::Authorization(
+	const string_t& verb,
+	const string_t& resource_type,
+	const string_t& resource_link,
+	const string_t& date,
+	bool name_based_link) const
+{
+	SignatureCache::Key key = SignatureCache::MakeKey(verb, resource_type, resource_link, date, name_based_link);
+
+	string_t authorization;
+	if (signature_cache_->TryGet(key, authorization))
+	{
+		return authorization;
+	}
+
+	char_t signature[SIGNATURE_LENGTH];
+	Sign(verb, resource_type, resource_link, date, signature, name_based_link);
+
+	authorization.reserve(sizeof(AUTHORIZATION_PREFIX) / sizeof(char_t) + 3 * SIGNATURE_LENGTH);
+	authorization.append(AUTHORIZATION_PREFIX);
+	for (size_t i = 0; i < SIGNATURE_LENGTH; ++i)
+	{
+		char_t c = signature[i];
+		if (c == _XPLATSTR('+') || c == _XPLATSTR('/') || c == _XPLATSTR('='))
+		{
+			authorization.push_back(_XPLATSTR('%'));
+			authorization.push_back(static_cast<char_t>(HEX_DIGITS[(c >> 4) & 0xF]));
+			authorization.push_back(static_cast<char_t>(HEX_DIGITS[c & 0xF]));
+		}
+		else
+		{
+			authorization.push_back(c);
+		}
+	}
+
+	signature_cache_->Put(key, authorization);
+	return authorization;
+}
+
+void RequestSigner::Sign(
+	const unsigned char* message,
+	size_t message_size,
+	unsigned char* digest) const
+{
+	HmacSha256::Context context(*hmac_);
+	context.Update(message, message_size);
+	context.Final(digest);
+}
@@ -0,0 +1,75 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#include "RetryBudget.h"
+
+using namespace documentdb;
+using namespace std;
+
+RetryBudget::RetryBudget(
+	double max_tokens,
+	double refill_ratio)
+	: max_tokens_(max_tokens)
+	, refill_ratio_(refill_ratio)
+	, tokens_(max_tokens)
+{
+}
+
+RetryBudget::~RetryBudget()
+{
+}
+
+bool RetryBudget::TryAcquire()
+{
+	if (max_tokens_ <= 0)
+	{
+		return true;
+	}
+
+	lock_guard<mutex> lock(mutex_);
+	if (tokens_ - 1 < max_tokens_ / 2)
+	{
+		return false;
+	}
+
+	tokens_ -= 1;
+	return true;
+}
+
+void RetryBudget::OnSuccess()
+{
+	if (max_tokens_ <= 0)
+	{
+		return;
+	}
+
+	lock_guard<mutex> lock(mutex_);
+	tokens_ = tokens_ + refill_ratio_ < max_tokens_ ? tokens_ + refill_ratio_ : max_tokens_;
+}
+
+double RetryBudget::tokens() const
+{
+	lock_guard<mutex> lock(mutex_);
+	return tokens_;
+}
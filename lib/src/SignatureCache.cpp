@@ -0,0 +1,176 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#include "SignatureCache.h"
+
+using namespace documentdb;
+using namespace std;
+using namespace utility;
+
+namespace
+{
+	// FNV-1a and a multiplicative hash with a different seed and mixing step, so
+	// that a collision in one is independent of a collision in the other.
+	void HashPart(
+		const string_t& part,
+		uint64_t& primary,
+		uint64_t& secondary)
+	{
+		for (string_t::const_iterator iter = part.cbegin(); iter != part.cend(); ++iter)
+		{
+			uint64_t c = static_cast<uint64_t>(*iter);
+			primary = (primary ^ c) * 0x100000001B3ULL;
+			secondary = (secondary + c + 1) * 0x9E3779B97F4A7C15ULL;
+			secondary ^= secondary >> 29;
+		}
+
+		// Part separator, so that ("ab", "c") and ("a", "bc") differ
+		primary = (primary ^ 0xFF) * 0x100000001B3ULL;
+		secondary = (secondary + 0x100) * 0x9E3779B97F4A7C15ULL;
+		secondary ^= secondary >> 29;
+	}
+}
+
+SignatureCache::SignatureCache()
+{
+	for (size_t i = 0; i < SLOT_COUNT; ++i)
+	{
+		slots_[i].sequence.store(0, memory_order_relaxed);
+		slots_[i].primary.store(0, memory_order_relaxed);
+		slots_[i].secondary.store(0, memory_order_relaxed);
+		slots_[i].length.store(0, memory_order_relaxed);
+	}
+}
+
+SignatureCache::~SignatureCache()
+{
+}
+
+SignatureCache::Key SignatureCache::MakeKey(
+	const string_t& verb,
+	const string_t& resource_type,
+	const string_t& resource_link,
+	const string_t& date,
+	bool name_based_link)
+{
+	Key key;
+	key.primary = 0xCBF29CE484222325ULL;
+	key.secondary = 0x2545F4914F6CDD1DULL;
+
+	HashPart(verb, key.primary, key.secondary);
+	HashPart(resource_type, key.primary, key.secondary);
+	HashPart(resource_link, key.primary, key.secondary);
+	HashPart(date, key.primary, key.secondary);
+
+	// The same link signs differently when its case is kept
+	if (name_based_link)
+	{
+		HashPart(string_t(), key.primary, key.secondary);
+	}
+
+	return key;
+}
+
+bool SignatureCache::TryGet(
+	const Key& key,
+	string_t& value) const
+{
+	const Slot& slot = slots_[key.primary % SLOT_COUNT];
+
+	uint32_t sequence = slot.sequence.load(memory_order_acquire);
+	if (sequence & 1)
+	{
+		// Being written right now
+		return false;
+	}
+
+	if (slot.primary.load(memory_order_relaxed) != key.primary ||
+		slot.secondary.load(memory_order_relaxed) != key.secondary)
+	{
+		return false;
+	}
+
+	uint32_t length = slot.length.load(memory_order_relaxed);
+	if (length > MAX_VALUE_LENGTH)
+	{
+		return false;
+	}
+
+	char buffer[MAX_VALUE_LENGTH];
+	for (size_t word = 0; word * sizeof(uint64_t) < length; ++word)
+	{
+		uint64_t bits = slot.value[word].load(memory_order_relaxed);
+		for (size_t i = 0; i < sizeof(uint64_t); ++i)
+		{
+			buffer[word * sizeof(uint64_t) + i] = static_cast<char>((bits >> (8 * i)) & 0xFF);
+		}
+	}
+
+	atomic_thread_fence(memory_order_acquire);
+	if (slot.sequence.load(memory_order_relaxed) != sequence)
+	{
+		// Overwritten while we were reading it
+		return false;
+	}
+
+	value.assign(buffer, buffer + length);
+	return true;
+}
+
+void SignatureCache::Put(
+	const Key& key,
+	const string_t& value)
+{
+	if (value.size() > MAX_VALUE_LENGTH)
+	{
+		return;
+	}
+
+	Slot& slot = slots_[key.primary % SLOT_COUNT];
+
+	uint32_t sequence = slot.sequence.load(memory_order_relaxed);
+	if ((sequence & 1) || !slot.sequence.compare_exchange_strong(sequence, sequence + 1, memory_order_acquire))
+	{
+		// Somebody else is writing this slot, let them have it
+		return;
+	}
+	atomic_thread_fence(memory_order_release);
+
+	slot.primary.store(key.primary, memory_order_relaxed);
+	slot.secondary.store(key.secondary, memory_order_relaxed);
+	slot.length.store(static_cast<uint32_t>(value.size()), memory_order_relaxed);
+
+	for (size_t word = 0; word * sizeof(uint64_t) < value.size(); ++word)
+	{
+		uint64_t bits = 0;
+		for (size_t i = 0; i < sizeof(uint64_t) && word * sizeof(uint64_t) + i < value.size(); ++i)
+		{
+			// Authorization header values are url encoded, hence ASCII
+			bits |= static_cast<uint64_t>(static_cast<unsigned char>(value[word * sizeof(uint64_t) + i])) << (8 * i);
+		}
+		slot.value[word].store(bits, memory_order_relaxed);
+	}
+
+	slot.sequence.store(sequence + 2, memory_order_release);
+}
@@ -0,0 +1,97 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#include "SqlQuerySpec.h"
+
+#include "DocumentDBConstants.h"
+
+using namespace documentdb;
+using namespace std;
+using namespace utility;
+using namespace web::json;
+
+namespace
+{
+	const string_t mime_type_application_sql = MIME_TYPE_APPLICATION_SQL;
+	const string_t mime_type_application_query_json = MIME_TYPE_APPLICATION_QUERY_JSON;
+}
+
+SqlQuerySpec::SqlQuerySpec(
+	const string_t& query)
+	: query_(query)
+	, body_(query)
+	, is_json_(false)
+{
+}
+
+SqlQuerySpec::SqlQuerySpec(
+	const char_t* query)
+	: query_(query)
+	, body_(query)
+	, is_json_(false)
+{
+}
+
+SqlQuerySpec::SqlQuerySpec(
+	const string_t& query,
+	const vector<SqlParameter>& parameters)
+	: query_(query)
+	, parameters_(parameters)
+	, body_(query)
+	, is_json_(!parameters.empty())
+{
+	if (is_json_)
+	{
+		value json_parameters = value::array(parameters.size());
+		for (size_t i = 0; i < parameters.size(); i++)
+		{
+			json_parameters[i][QUERY_SPEC_NAME] = value::string(parameters[i].first);
+			json_parameters[i][QUERY_SPEC_VALUE] = parameters[i].second;
+		}
+
+		value json_body;
+		json_body[QUERY_SPEC_QUERY] = value::string(query);
+		json_body[QUERY_SPEC_PARAMETERS] = json_parameters;
+		body_ = json_body.serialize();
+	}
+}
+
+SqlQuerySpec::SqlQuerySpec(
+	const string_t& query,
+	const vector<SqlParameter>& parameters,
+	string_t&& body)
+	: query_(query)
+	, parameters_(parameters)
+	, body_(move(body))
+	, is_json_(true)
+{
+}
+
+SqlQuerySpec::~SqlQuerySpec()
+{}
+
+const string_t& SqlQuerySpec::content_type() const
+{
+	return is_json_ ? mime_type_application_query_json : mime_type_application_sql;
+}
@@ -49,7 +49,7 @@ User::User(
 	const string_t& etag,
 	const string_t& permissions)
 	: DocumentDBEntity(document_db_configuration, id, resource_id, ts, self, etag)
-	, permissions_(permissions)
+	, permissions_(ShareLink(permissions))
 {
 	//TODO : deal with permissions...
 }
@@ -58,6 +58,19 @@ User::~User()
 {
 }
 
+shared_ptr<User> User::WithDiagnosticsHandler(
+	const function<void(const ResponseDiagnostics&)>& diagnostics_handler) const
+{
+	return make_shared<User>(
+		document_db_configuration()->WithDiagnosticsHandler(diagnostics_handler),
+		id(),
+		resource_id(),
+		ts(),
+		self(),
+		etag(),
+		*permissions_);
+}
+
 shared_ptr<Permission> User::PermissionFromJson(
 	const value* json_permission) const
 {
@@ -94,22 +107,24 @@ pplx::task<shared_ptr<Permission>> User::CreatePermissionAsync(
 	const string_t& permissionMode,
 	const string_t& resource) const
 {
-	http_request request = CreateRequest(
-		methods::POST,
-		RESOURCE_PATH_PERMISSIONS,
-		this->resource_id(),
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + permissions_);
-
-	value body;
-	body[DOCUMENT_ID] = value::string(id);
-	body[PERMISSION_MODE] = value::string(permissionMode);
-	body[RESOURCE] = value::string(resource);
-	request.set_body(body);
-
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::POST,
+			RESOURCE_PATH_PERMISSIONS,
+			this->resource_id(),
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *permissions_);
+
+		value body;
+		body[DOCUMENT_ID] = value::string(id);
+		body[PERMISSION_MODE] = value::string(permissionMode);
+		body[RESOURCE] = value::string(resource);
+		request.set_body(body);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
 	{
-		value json_response = response.extract_json().get();
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::Created)
 		{
@@ -131,21 +146,23 @@ shared_ptr<Permission> User::CreatePermission(
 pplx::task<void> User::DeletePermissionAsync(
 	const string_t& resource_id) const
 {
-	http_request request = CreateRequest(
-		methods::DEL,
-		RESOURCE_PATH_PERMISSIONS,
-		resource_id,
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + permissions_ + resource_id);
-
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::DEL,
+			RESOURCE_PATH_PERMISSIONS,
+			resource_id,
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *permissions_ + resource_id);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
 	{
 		if (response.status_code() == status_codes::NoContent)
 		{
 			return;
 		}
 
-		value json_response = response.extract_json().get();
+		const value& json_response = response.json();
 		ThrowExceptionFromResponse(response.status_code(), json_response);
 	});
 }
@@ -171,16 +188,18 @@ void User::DeletePermission(
 pplx::task<shared_ptr<Permission>> User::GetPermissionAsync(
 	const string_t& resource_id) const
 {
-	http_request request = CreateRequest(
-		methods::GET,
-		RESOURCE_PATH_PERMISSIONS,
-		resource_id,
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + permissions_ + resource_id);
-
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::GET,
+			RESOURCE_PATH_PERMISSIONS,
+			resource_id,
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *permissions_ + resource_id);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
 	{
-		value json_response = response.extract_json().get();
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::OK)
 		{
@@ -199,15 +218,18 @@ shared_ptr<Permission> User::GetPermission(
 
 pplx::task<vector<shared_ptr<Permission>>> User::ListPermissionsAsync() const
 {
-	http_request request = CreateRequest(
-		methods::GET,
-		RESOURCE_PATH_PERMISSIONS,
-		this->resource_id(),
-		this->document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + permissions_);
-	return this->document_db_configuration()->http_client().request(request).then([=](http_response response)
+	return ExecuteRequestAsync(*this->document_db_configuration(), [=]()
 	{
-		value json_response = response.extract_json().get();
+		http_request request = CreateRequest(
+			methods::GET,
+			RESOURCE_PATH_PERMISSIONS,
+			this->resource_id(),
+			this->document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *permissions_);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
+	{
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::OK)
 		{
@@ -239,22 +261,24 @@ pplx::task<shared_ptr<Permission>> User::ReplacePermissionAsync(
 	const string_t& new_permissionMode,
 	const string_t& new_resource) const
 {
-	http_request request = CreateRequest(
-		methods::PUT,
-		RESOURCE_PATH_PERMISSIONS,
-		resource_id,
-		document_db_configuration()->master_key());
-	request.set_request_uri(this->self() + permissions_ + resource_id);
-
-	value body;
-	body[DOCUMENT_ID] = value::string(new_id);
-	body[PERMISSION_MODE] = value::string(new_permissionMode);
-	body[RESOURCE] = value::string(new_resource);
-	request.set_body(body);
-
-	return document_db_configuration()->http_client().request(request).then([=](http_response response)
+	return ExecuteRequestAsync(*document_db_configuration(), [=]()
+	{
+		http_request request = CreateRequest(
+			methods::PUT,
+			RESOURCE_PATH_PERMISSIONS,
+			resource_id,
+			document_db_configuration()->request_signer());
+		request.set_request_uri(this->self() + *permissions_ + resource_id);
+
+		value body;
+		body[DOCUMENT_ID] = value::string(new_id);
+		body[PERMISSION_MODE] = value::string(new_permissionMode);
+		body[RESOURCE] = value::string(new_resource);
+		request.set_body(body);
+		return request;
+	}).then([=](const DocumentDBResponse& response)
 	{
-		value json_response = response.extract_json().get();
+		const value& json_response = response.json();
 
 		if (response.status_code() == status_codes::OK)
 		{
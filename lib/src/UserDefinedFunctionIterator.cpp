@@ -40,70 +40,81 @@ using namespace web::http::client;
 
 UserDefinedFunctionIterator::UserDefinedFunctionIterator(
 	const shared_ptr<const Collection>& collection,
-	const string_t& original_query,
+	const SqlQuerySpec& original_query,
 	const int page_size,
 	const string_t& original_request_uri,
 	const string_t& continuation_id,
-	const value& buffer)
+	const shared_ptr<const value>& response_json,
+	const ResponseDiagnostics& diagnostics)
 	: collection_(collection)
-	, original_query_(original_query)
-	, page_size_(page_size)
-	, original_request_uri_(original_request_uri)
-	, continuation_id_(continuation_id)
-	, buffer_(buffer)
+	, page_(response_json)
+	, items_(&page_->at(RESPONSE_QUERY_UDFS).as_array())
 	, current_(0)
-{}
+	, diagnostics_(diagnostics)
+{
+	const ConnectionPolicy& connection_policy = collection->document_db_configuration()->connection_policy();
+	shared_ptr<const Collection> owner = collection;
+	pager_ = make_shared<QueryPager>(
+		[owner, original_query, page_size, original_request_uri](const string_t& continuation)
+		{
+			return ExecuteRequestAsync(*owner->document_db_configuration(), [=]()
+			{
+				http_request request = CreateQueryRequest(
+					original_query,
+					page_size,
+					RESOURCE_PATH_UDFS,
+					owner->resource_id(),
+					owner->document_db_configuration()->request_signer(),
+					continuation);
+				request.set_request_uri(original_request_uri);
+				return request;
+			});
+		},
+		RESPONSE_QUERY_UDFS,
+		continuation_id,
+		connection_policy.query_prefetch_pages(),
+		connection_policy.query_prefetch_max_bytes());
+	pager_->Prefetch();
+}
 
 UserDefinedFunctionIterator::~UserDefinedFunctionIterator()
 {}
 
-bool UserDefinedFunctionIterator::HasMore()
+pplx::task<bool> UserDefinedFunctionIterator::HasMoreAsync()
 {
-	if (current_ < buffer_.as_array().size())
+	if (current_ < items_->size())
 	{
-		return true;
+		return pplx::task_from_result(true);
 	}
 
-
-	if (continuation_id_.empty())
-	{
-		return false;
-	}
-
-	// Case where we have continuation, but we are not really sure do we have anything more, need to fetch it.
+	// Pages may come back empty while the continuation says there is more
 	//
-	http_request request = CreateQueryRequest(
-		original_query_,
-		page_size_,
-		RESOURCE_PATH_UDFS,
-		collection_->resource_id(),
-		collection_->document_db_configuration()->master_key(),
-		continuation_id_);
-	request.set_request_uri(original_request_uri_);
-
-	http_response response = collection_->document_db_configuration()->http_client().request(request).get();
-	value json_response = response.extract_json().get();
-
-	if (response.status_code() == status_codes::OK)
+	shared_ptr<UserDefinedFunctionIterator> self = shared_from_this();
+	return pager_->NextPageAsync().then([self](const QueryPager::Page& page)
 	{
-		string_t new_continuation_id = response.headers()[HEADER_MS_CONTINUATION];
-		int count = stoi(response.headers()[HEADER_MS_MAX_ITEM_COUNT]);
+		if (page.items == nullptr)
+		{
+			return pplx::task_from_result(false);
+		}
 
-		buffer_ = json_response.at(RESPONSE_QUERY_UDFS);
-		continuation_id_ = new_continuation_id;
-		current_ = 0;
-		return count > 0;
-	}
+		self->page_ = page.json;
+		self->items_ = page.items;
+		self->current_ = 0;
+		self->diagnostics_ = page.diagnostics;
+		return self->HasMoreAsync();
+	});
+}
 
-	ThrowExceptionFromResponse(response.status_code(), json_response);
+bool UserDefinedFunctionIterator::HasMore()
+{
+	return HasMoreAsync().get();
 }
 
 shared_ptr<UserDefinedFunction> UserDefinedFunctionIterator::Next()
 {
-	if (current_ < buffer_.as_array().size())
+	if (current_ < items_->size())
 	{
-		value udf_json = buffer_.as_array().at(current_++);
-		return collection_->UserDefinedFunctionFromJson(&udf_json);
+		return collection_->UserDefinedFunctionFromJson(&items_->at(current_++));
 	}
 
 	// Did you called hasMore()?
@@ -111,3 +122,36 @@ shared_ptr<UserDefinedFunction> UserDefinedFunctionIterator::Next()
 	assert(false);
 	throw DocumentDBRuntimeException(_XPLATSTR("Calling Next without checking HasMore before that."));
 }
+
+pplx::task<shared_ptr<UserDefinedFunction>> UserDefinedFunctionIterator::NextAsync()
+{
+	shared_ptr<UserDefinedFunctionIterator> self = shared_from_this();
+	return HasMoreAsync().then([self](bool has_more)
+	{
+		return has_more ? self->Next() : shared_ptr<UserDefinedFunction>();
+	});
+}
+
+pplx::task<vector<shared_ptr<UserDefinedFunction>>> UserDefinedFunctionIterator::NextPageAsync()
+{
+	shared_ptr<UserDefinedFunctionIterator> self = shared_from_this();
+	return HasMoreAsync().then([self](bool has_more)
+	{
+		vector<shared_ptr<UserDefinedFunction>> results;
+		if (has_more)
+		{
+			results.reserve(self->items_->size() - self->current_);
+			while (self->current_ < self->items_->size())
+			{
+				results.push_back(self->Next());
+			}
+		}
+
+		return results;
+	});
+}
+
+vector<shared_ptr<UserDefinedFunction>> UserDefinedFunctionIterator::NextPage()
+{
+	return NextPageAsync().get();
+}
@@ -0,0 +1,146 @@
+/***
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 DocumentDBCpp
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+***/
+
+#include <assert.h>
+#include <cpprest/http_client.h>
+
+#include "ValueIterator.h"
+#include "Collection.h"
+#include "ConnectionHelper.h"
+#include "DocumentDBConstants.h"
+#include "exceptions.h"
+
+using namespace documentdb;
+using namespace std;
+using namespace utility;
+using namespace web::http;
+using namespace web::json;
+using namespace web::http::client;
+
+ValueIterator::ValueIterator(
+		const shared_ptr<const Collection>& collection,
+		const SqlQuerySpec& original_query,
+		const int page_size,
+		const string_t& original_request_uri,
+		const string_t& continuation_id,
+		const shared_ptr<const value>& response_json,
+		const ResponseDiagnostics& diagnostics)
+	: page_(response_json)
+	, items_(&page_->at(RESPONSE_QUERY_DOCUMENTS).as_array())
+	, current_(0)
+	, diagnostics_(diagnostics)
+{
+	const ConnectionPolicy& connection_policy = collection->document_db_configuration()->connection_policy();
+	shared_ptr<const Collection> owner = collection;
+	pager_ = make_shared<QueryPager>(
+		[owner, original_query, page_size, original_request_uri](const string_t& continuation)
+		{
+			return ExecuteRequestAsync(*owner->document_db_configuration(), [=]()
+			{
+				http_request request = CreateQueryRequest(
+					original_query,
+					page_size,
+					RESOURCE_PATH_DOCS,
+					owner->resource_id(),
+					owner->document_db_configuration()->request_signer(),
+					continuation,
+					false,
+					!owner->partition_key().empty());
+				request.set_request_uri(original_request_uri);
+				return request;
+			});
+		},
+		RESPONSE_QUERY_DOCUMENTS,
+		continuation_id,
+		connection_policy.query_prefetch_pages(),
+		connection_policy.query_prefetch_max_bytes());
+	pager_->Prefetch();
+}
+
+ValueIterator::~ValueIterator()
+{}
+
+pplx::task<bool> ValueIterator::HasMoreAsync()
+{
+	if (current_ < items_->size())
+	{
+		return pplx::task_from_result(true);
+	}
+
+	// Pages may come back empty while the continuation says there is more
+	//
+	shared_ptr<ValueIterator> self = shared_from_this();
+	return pager_->NextPageAsync().then([self](const QueryPager::Page& page)
+	{
+		if (page.items == nullptr)
+		{
+			return pplx::task_from_result(false);
+		}
+
+		self->page_ = page.json;
+		self->items_ = page.items;
+		self->current_ = 0;
+		self->diagnostics_ = page.diagnostics;
+		return self->HasMoreAsync();
+	});
+}
+
+bool ValueIterator::HasMore()
+{
+	return HasMoreAsync().get();
+}
+
+value ValueIterator::Next()
+{
+	if (current_ < items_->size())
+	{
+		return items_->at(current_++);
+	}
+
+	// Did you called hasMore()?
+	//
+	assert(false);
+	throw DocumentDBRuntimeException(_XPLATSTR("Calling Next without checking HasMore before that."));
+}
+
+pplx::task<vector<value>> ValueIterator::NextPageAsync()
+{
+	shared_ptr<ValueIterator> self = shared_from_this();
+	return HasMoreAsync().then([self](bool has_more)
+	{
+		vector<value> results;
+		if (has_more)
+		{
+			results.assign(self->items_->begin() + self->current_, self->items_->end());
+			self->current_ = (unsigned int)self->items_->size();
+		}
+
+		return results;
+	});
+}
+
+vector<value> ValueIterator::NextPage()
+{
+	return NextPageAsync().get();
+}
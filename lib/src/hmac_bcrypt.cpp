@@ -38,19 +38,23 @@
 
 #define STATUS_UNSUCCESSFUL         ((NTSTATUS)0xC0000001L)
 
-unsigned char* hmac(const unsigned char* key, int keySize, const unsigned char* message, int messageSize, int* cbHash)
+using namespace documentdb;
+
+HmacSha256::HmacSha256(
+	const unsigned char* key,
+	size_t key_size)
+	: algorithm_(NULL)
+	, keyed_hash_(NULL)
+	, keyed_object_(NULL)
+	, object_length_(0)
 {
-	BCRYPT_ALG_HANDLE       hAlg = NULL;
-	BCRYPT_HASH_HANDLE      hHash = NULL;
 	NTSTATUS                status = STATUS_UNSUCCESSFUL;
-	DWORD                   cbData = 0, cbHashObject = 0;
-	PBYTE                   pbHashObject = NULL;
-	unsigned char*          pbHash = NULL;
+	DWORD                   cbData = 0;
 	bool                    error = false;
 
 	//open an algorithm handle
 	if (!NT_SUCCESS(status = BCryptOpenAlgorithmProvider(
-		&hAlg,
+		&algorithm_,
 		BCRYPT_SHA256_ALGORITHM,
 		NULL,
 		BCRYPT_ALG_HANDLE_HMAC_FLAG)))
@@ -61,9 +65,9 @@ unsigned char* hmac(const unsigned char* key, int keySize, const unsigned char*
 
 	//calculate the size of the buffer to hold the hash object
 	if (!NT_SUCCESS(status = BCryptGetProperty(
-		hAlg,
+		algorithm_,
 		BCRYPT_OBJECT_LENGTH,
-		(PBYTE)&cbHashObject,
+		(PBYTE)&object_length_,
 		sizeof(DWORD),
 		&cbData,
 		0)))
@@ -72,97 +76,121 @@ unsigned char* hmac(const unsigned char* key, int keySize, const unsigned char*
 		goto Cleanup;
 	}
 
-	//allocate the hash object on the heap
-	pbHashObject = (PBYTE)HeapAlloc(GetProcessHeap(), 0, cbHashObject);
-	if (NULL == pbHashObject)
+	//every message duplicates the keyed hash into a buffer on the caller's stack
+	if (object_length_ > Context::OBJECT_LENGTH)
 	{
 		error = true;
 		goto Cleanup;
 	}
 
-	//calculate the length of the hash
-	if (!NT_SUCCESS(status = BCryptGetProperty(
-		hAlg,
-		BCRYPT_HASH_LENGTH,
-		(PBYTE)cbHash,
-		sizeof(DWORD),
-		&cbData,
-		0)))
-	{
-		error = true;
-		goto Cleanup;
-	}
-
-	//allocate the hash buffer on the heap
-	pbHash = (unsigned char*)HeapAlloc(GetProcessHeap(), 0, *cbHash);
-	if (NULL == pbHash)
+	//allocate the keyed hash object on the heap, once
+	keyed_object_ = (PUCHAR)HeapAlloc(GetProcessHeap(), 0, object_length_);
+	if (NULL == keyed_object_)
 	{
 		error = true;
 		goto Cleanup;
 	}
 
-	//create a hash
+	//create a hash, this is where the key is processed
 	if (!NT_SUCCESS(status = BCryptCreateHash(
-		hAlg,
-		&hHash,
-		pbHashObject,
-		cbHashObject,
-		(PBYTE)key,
-		keySize,
+		algorithm_,
+		&keyed_hash_,
+		keyed_object_,
+		object_length_,
+		(PUCHAR)key,
+		(ULONG)key_size,
 		0)))
 	{
 		error = true;
 		goto Cleanup;
 	}
 
-	//hash some data
-	if (!NT_SUCCESS(status = BCryptHashData(
-		hHash,
-		(PBYTE)message,
-		messageSize,
-		0)))
+Cleanup:
+
+	if (error)
 	{
-		error = true;
-		goto Cleanup;
+		Release();
+
+		throw DocumentDBRuntimeException(_XPLATSTR("Error during hmac key setup"));
 	}
+}
 
-	//close the hash
-	if (!NT_SUCCESS(status = BCryptFinishHash(
-		hHash,
-		pbHash,
-		*cbHash,
-		0)))
+HmacSha256::~HmacSha256()
+{
+	Release();
+}
+
+void HmacSha256::Release()
+{
+	if (keyed_hash_)
 	{
-		error = true;
-		goto Cleanup;
+		BCryptDestroyHash(keyed_hash_);
+		keyed_hash_ = NULL;
 	}
 
-Cleanup:
-
-	if (hAlg)
+	if (keyed_object_)
 	{
-		BCryptCloseAlgorithmProvider(hAlg, 0);
+		HeapFree(GetProcessHeap(), 0, keyed_object_);
+		keyed_object_ = NULL;
 	}
 
-	if (hHash)
+	if (algorithm_)
 	{
-		BCryptDestroyHash(hHash);
+		BCryptCloseAlgorithmProvider(algorithm_, 0);
+		algorithm_ = NULL;
 	}
+}
 
-	if (pbHashObject)
+HmacSha256::Context::Context(
+	const HmacSha256& hmac)
+	: hmac_(hmac)
+	, hash_(NULL)
+{
+	//copy the keyed state, no key processing or allocation happens here
+	if (!NT_SUCCESS(BCryptDuplicateHash(
+		hmac_.keyed_hash_,
+		&hash_,
+		object_,
+		hmac_.object_length_,
+		0)))
 	{
-		HeapFree(GetProcessHeap(), 0, pbHashObject);
+		throw DocumentDBRuntimeException(_XPLATSTR("Error during hmac hashing"));
 	}
+}
 
-	if (error)
+HmacSha256::Context::~Context()
+{
+	if (hash_)
 	{
-		if (pbHash != nullptr)
-		{
-			HeapFree(GetProcessHeap(), 0, pbHash);
-		}
+		BCryptDestroyHash(hash_);
+	}
+}
 
-		throw documentdb::DocumentDBRuntimeException(_XPLATSTR("Error during hmac hashing"));
+void HmacSha256::Context::Update(
+	const unsigned char* data,
+	size_t size)
+{
+	//hash some data
+	if (!NT_SUCCESS(BCryptHashData(
+		hash_,
+		(PUCHAR)data,
+		(ULONG)size,
+		0)))
+	{
+		throw DocumentDBRuntimeException(_XPLATSTR("Error during hmac hashing"));
 	}
+}
 
-	return pbHash;
+void HmacSha256::Context::Final(
+	unsigned char* digest)
+{
+	//close the hash
+	if (!NT_SUCCESS(BCryptFinishHash(
+		hash_,
+		digest,
+		(ULONG)DIGEST_LENGTH,
+		0)))
+	{
+		throw DocumentDBRuntimeException(_XPLATSTR("Error during hmac hashing"));
+	}
 }
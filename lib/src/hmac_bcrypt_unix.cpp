@@ -25,79 +25,226 @@
 #include "hmac_bcrypt.h"
 
 #include <cstring>
-#include <openssl/x509.h>
-#include <openssl/hmac.h>
+#include <openssl/sha.h>
 
+#include "exceptions.h"
 
-unsigned char* hmac(
-    const unsigned char* key,       /* pointer to authentication key */
-    int                  keySize,    /* length of authentication key  */
-    const unsigned char* message,      /* pointer to data stream        */
-    int                  messageSize,   /* length of data stream         */
-    int*                 cbHash)    /* caller digest to be filled in */
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+#define EVP_MD_CTX_new EVP_MD_CTX_create
+#define EVP_MD_CTX_free EVP_MD_CTX_destroy
+#endif
+
+using namespace documentdb;
+
+namespace
 {
-	unsigned char* digest = new unsigned char[SHA256_DIGEST_LENGTH];
-
-    unsigned char k_ipad[65];   /* inner padding -
-                                 * key XORd with ipad
-                                 */
-    unsigned char k_opad[65];   /* outer padding -
-                                 * key XORd with opad
-                                 */
-    unsigned char tk[SHA256_DIGEST_LENGTH];
-    unsigned char tk2[SHA256_DIGEST_LENGTH];
-    unsigned char bufferIn[1024];
-    unsigned char bufferOut[1024];
-    int           i;
+    void Check(
+        int result)
+    {
+        if ( result != 1 ) {
+            throw DocumentDBRuntimeException( _XPLATSTR("Failed to compute HMAC-SHA256") );
+        }
+    }
 
-    /* if key is longer than 64 bytes reset it to key=sha256(key) */
-    if ( keySize > 64 ) {
-        SHA256( key, keySize, tk );
-        key     = tk;
-        keySize = SHA256_DIGEST_LENGTH;
+    EVP_MD_CTX* NewDigest()
+    {
+        EVP_MD_CTX* context = EVP_MD_CTX_new();
+        if ( context == nullptr ) {
+            throw DocumentDBRuntimeException( _XPLATSTR("Failed to allocate SHA256 context") );
+        }
+        return context;
     }
 
     /*
-     * the HMAC_SHA256 transform looks like:
-     *
-     * SHA256(K XOR opad, SHA256(K XOR ipad, text))
-     *
-     * where K is an n byte key
-     * ipad is the byte 0x36 repeated 64 times
-     * opad is the byte 0x5c repeated 64 times
-     * and text is the data being protected
+     * copies a pre-keyed state over target so that the original can be reused;
+     * a target that already holds a SHA256 state keeps its buffers
      */
+    void CopyDigest(
+        EVP_MD_CTX*       target,
+        const EVP_MD_CTX* source)
+    {
+        if ( EVP_MD_CTX_copy_ex( target, source ) != 1 ) {
+            throw DocumentDBRuntimeException( _XPLATSTR("Failed to copy SHA256 context") );
+        }
+    }
+
+    /*
+     * digest states allocated once per thread and reset from the pre-keyed
+     * ones for every message, so signing does not allocate
+     */
+    struct ThreadDigests
+    {
+        ThreadDigests()
+            : inner(nullptr)
+            , outer(nullptr)
+            , inner_in_use(false)
+        {
+        }
+
+        ~ThreadDigests()
+        {
+            EVP_MD_CTX_free( inner );
+            EVP_MD_CTX_free( outer );
+        }
+
+        EVP_MD_CTX* inner;
+        EVP_MD_CTX* outer;
+        /* set while a Context hashes into inner */
+        bool        inner_in_use;
+    };
+
+    ThreadDigests& CurrentThreadDigests()
+    {
+        static thread_local ThreadDigests digests;
+        return digests;
+    }
+}
+
+/*
+ * the HMAC_SHA256 transform looks like:
+ *
+ * SHA256(K XOR opad, SHA256(K XOR ipad, text))
+ *
+ * where K is an n byte key
+ * ipad is the byte 0x36 repeated 64 times
+ * opad is the byte 0x5c repeated 64 times
+ * and text is the data being protected
+ *
+ * Both (K XOR ipad) and (K XOR opad) are exactly one SHA256 block, so they are
+ * hashed once here and the resulting states are copied for every message.
+ */
+HmacSha256::HmacSha256(
+    const unsigned char* key,       /* pointer to authentication key */
+    size_t               key_size)  /* length of authentication key  */
+    : inner_(nullptr)
+    , outer_(nullptr)
+{
+    unsigned char k_ipad[SHA256_CBLOCK];   /* inner padding -
+                                            * key XORd with ipad
+                                            */
+    unsigned char k_opad[SHA256_CBLOCK];   /* outer padding -
+                                            * key XORd with opad
+                                            */
+    unsigned char tk[SHA256_DIGEST_LENGTH];
+
+    /* if key is longer than 64 bytes reset it to key=sha256(key) */
+    if ( key_size > SHA256_CBLOCK ) {
+        SHA256( key, key_size, tk );
+        key      = tk;
+        key_size = SHA256_DIGEST_LENGTH;
+    }
 
     /* start out by storing key in pads */
     std::memset( k_ipad, 0, sizeof k_ipad );
     std::memset( k_opad, 0, sizeof k_opad );
-    std::memcpy( k_ipad, key, keySize );
-    std::memcpy( k_opad, key, keySize );
+    std::memcpy( k_ipad, key, key_size );
+    std::memcpy( k_opad, key, key_size );
 
     /* XOR key with ipad and opad values */
-    for ( i = 0; i < 64; i++ ) {
+    for ( size_t i = 0; i < SHA256_CBLOCK; i++ ) {
         k_ipad[i] ^= 0x36;
         k_opad[i] ^= 0x5c;
     }
 
+    try {
+        inner_ = NewDigest();
+        Check( EVP_DigestInit_ex( inner_, EVP_sha256(), nullptr ) );
+        Check( EVP_DigestUpdate( inner_, k_ipad, SHA256_CBLOCK ) );
+
+        outer_ = NewDigest();
+        Check( EVP_DigestInit_ex( outer_, EVP_sha256(), nullptr ) );
+        Check( EVP_DigestUpdate( outer_, k_opad, SHA256_CBLOCK ) );
+    }
+    catch ( ... ) {
+        std::memset( k_ipad, 0, sizeof k_ipad );
+        std::memset( k_opad, 0, sizeof k_opad );
+        EVP_MD_CTX_free( inner_ );
+        EVP_MD_CTX_free( outer_ );
+        throw;
+    }
+
+    std::memset( k_ipad, 0, sizeof k_ipad );
+    std::memset( k_opad, 0, sizeof k_opad );
+}
+
+HmacSha256::~HmacSha256()
+{
+    /* freeing clears the hash states */
+    EVP_MD_CTX_free( inner_ );
+    EVP_MD_CTX_free( outer_ );
+}
+
+HmacSha256::Context::Context(
+    const HmacSha256& hmac)
+    : hmac_(hmac)
+    , inner_(nullptr)
+    , owns_inner_(false)
+{
+    /*
+     * a second Context alive on the same thread gets a state of its own
+     */
+    ThreadDigests& digests = CurrentThreadDigests();
+    if ( digests.inner_in_use ) {
+        inner_      = NewDigest();
+        owns_inner_ = true;
+    }
+    else {
+        if ( digests.inner == nullptr ) {
+            digests.inner = NewDigest();
+        }
+        inner_               = digests.inner;
+        digests.inner_in_use = true;
+    }
+
+    try {
+        CopyDigest( inner_, hmac.inner_ );
+    }
+    catch ( ... ) {
+        Release();
+        throw;
+    }
+}
+
+HmacSha256::Context::~Context()
+{
+    Release();
+}
+
+void HmacSha256::Context::Release()
+{
+    if ( owns_inner_ ) {
+        EVP_MD_CTX_free( inner_ );
+    }
+    else {
+        CurrentThreadDigests().inner_in_use = false;
+    }
+}
+
+void HmacSha256::Context::Update(
+    const unsigned char* data,
+    size_t               size)
+{
+    Check( EVP_DigestUpdate( inner_, data, size ) );
+}
+
+void HmacSha256::Context::Final(
+    unsigned char* digest)          /* caller digest to be filled in */
+{
+    unsigned char inner_digest[SHA256_DIGEST_LENGTH];
+
     /*
      * perform inner SHA256
      */
-    std::memset( bufferIn, 0x00, 1024 );
-    std::memcpy( bufferIn, k_ipad, 64 );
-    std::memcpy( bufferIn + 64, message, messageSize );
-
-    SHA256( bufferIn, 64 + messageSize, tk2 );
+    Check( EVP_DigestFinal_ex( inner_, inner_digest, nullptr ) );
 
     /*
      * perform outer SHA256
      */
-    std::memset( bufferOut, 0x00, 1024 );
-    std::memcpy( bufferOut, k_opad, 64 );
-    std::memcpy( bufferOut + 64, tk2, SHA256_DIGEST_LENGTH );
-
-    SHA256( bufferOut, 64 + SHA256_DIGEST_LENGTH, digest );
-
-    *cbHash = SHA256_DIGEST_LENGTH;
-    return digest;
+    ThreadDigests& digests = CurrentThreadDigests();
+    if ( digests.outer == nullptr ) {
+        digests.outer = NewDigest();
+    }
+    CopyDigest( digests.outer, hmac_.outer_ );
+    Check( EVP_DigestUpdate( digests.outer, inner_digest, SHA256_DIGEST_LENGTH ) );
+    Check( EVP_DigestFinal_ex( digests.outer, digest, nullptr ) );
 }
@@ -22,21 +22,38 @@
 * SOFTWARE.
 ***/
 
+#include <atomic>
 #include <cstdlib>
 #include <ctime>
 #include <fstream>
+#include <thread>
 #include <assert.h>
 
 #include <cpprest/json.h>
+#ifndef _WIN32
+#include <openssl/crypto.h>
+#endif
 
+#include "BulkPipeline.h"
+#include "ConnectionHelper.h"
+#include "ConnectionPolicy.h"
+#include "DocumentCache.h"
 #include "DocumentClient.h"
 #include "exceptions.h"
+#include "JsonArrayReader.h"
+#include "MetadataCache.h"
+#include "ParallelQuery.h"
+#include "PreparedQuery.h"
+#include "RequestLimiter.h"
+#include "RequestSigner.h"
+#include "RetryBudget.h"
 #include "TriggerOperation.h"
 #include "TriggerType.h"
 
 using namespace std;
 using namespace utility;
 using namespace documentdb;
+using namespace web::http;
 using namespace web::json;
 
 #ifndef U
@@ -45,6 +62,88 @@ using namespace web::json;
 
 const string_t js_function = U("function() {var x = 10; return 1; }");
 
+struct OrderLine
+{
+	string_t sku;
+	int quantity;
+};
+
+struct Order
+{
+	string_t id;
+	string_t resource_id;
+	long long total;
+	double price;
+	bool shipped;
+	vector<OrderLine> lines;
+};
+
+struct TenantItem
+{
+	string_t tenant;
+	string_t resource_id;
+	int n;
+};
+
+namespace documentdb
+{
+	template<>
+	struct DocumentMapping<OrderLine>
+	{
+		static void Describe(DocumentFields<OrderLine>& fields)
+		{
+			fields.Add(U("sku"), &OrderLine::sku);
+			fields.Add(U("quantity"), &OrderLine::quantity);
+		}
+	};
+
+	template<>
+	struct DocumentMapping<Order>
+	{
+		static void Describe(DocumentFields<Order>& fields)
+		{
+			fields.Add(U("id"), &Order::id);
+			fields.Add(U("_rid"), &Order::resource_id);
+			fields.Add(U("total"), &Order::total);
+			fields.Add(U("price"), &Order::price);
+			fields.Add(U("shipped"), &Order::shipped);
+			fields.Add(U("lines"), &Order::lines);
+		}
+	};
+
+	template<>
+	struct DocumentMapping<TenantItem>
+	{
+		static void Describe(DocumentFields<TenantItem>& fields)
+		{
+			fields.Add(U("tenant"), &TenantItem::tenant);
+			fields.Add(U("_rid"), &TenantItem::resource_id);
+			fields.Add(U("n"), &TenantItem::n);
+		}
+	};
+}
+
+#if !defined(_WIN32) && OPENSSL_VERSION_NUMBER >= 0x10100000L
+atomic<int> openssl_allocations(0);
+
+void* count_openssl_malloc(size_t size, const char*, int)
+{
+	openssl_allocations++;
+	return malloc(size);
+}
+
+void* count_openssl_realloc(void* memory, size_t size, const char*, int)
+{
+	openssl_allocations++;
+	return realloc(memory, size);
+}
+
+void count_openssl_free(void* memory, const char*, int)
+{
+	free(memory);
+}
+#endif
+
 string_t generate_random_string(
 	size_t length)
 {
@@ -130,6 +229,768 @@ void compare_attachments(const shared_ptr<Attachment>& attachment1,
 	assert(attachment1->self() == attachment2->self());
 }
 
+void test_request_signer()
+{
+#if !defined(_WIN32) && OPENSSL_VERSION_NUMBER >= 0x10100000L
+	// Counting only works if OpenSSL has not allocated anything yet
+	bool count_allocations = CRYPTO_set_mem_functions(count_openssl_malloc, count_openssl_realloc, count_openssl_free) == 1;
+#endif
+
+	// RFC 4231, test case 2
+	string key_text = "Jefe";
+	string message = "what do ya want for nothing?";
+	RequestSigner signer(vector<unsigned char>(key_text.begin(), key_text.end()));
+	unsigned char digest[32];
+	signer.Sign(reinterpret_cast<const unsigned char*>(message.data()), message.size(), digest);
+	assert(utility::conversions::to_base64(vector<unsigned char>(digest, digest + 32)) == U("W9zBRr9gdU5qBCQmCJV1x1oAPwidJzmDnexYuWTsOEM="));
+
+#if !defined(_WIN32) && OPENSSL_VERSION_NUMBER >= 0x10100000L
+	// Hash contexts are allocated once per thread. OpenSSL 3 providers still
+	// duplicate the inner and outer hash state on every copy.
+	if (count_allocations)
+	{
+		int before = openssl_allocations;
+		for (int i = 0; i < 100; i++)
+		{
+			signer.Sign(reinterpret_cast<const unsigned char*>(message.data()), message.size(), digest);
+		}
+		assert(openssl_allocations - before <= (OPENSSL_VERSION_NUMBER >= 0x30000000L ? 2 : 0) * 100);
+	}
+#endif
+
+	// RFC 4231, test case 6 (key longer than a block)
+	message = "Test Using Larger Than Block-Size Key - Hash Key First";
+	RequestSigner long_key_signer(vector<unsigned char>(131, 0xaa));
+	long_key_signer.Sign(reinterpret_cast<const unsigned char*>(message.data()), message.size(), digest);
+	assert(utility::conversions::to_base64(vector<unsigned char>(digest, digest + 32)) == U("YOQxWR7gtn8Niiaqy/W3f44LxiE3KMUUBUYEDw7jf1Q="));
+
+	// String to sign is lower cased and may be of any length
+	utility::char_t signature[RequestSigner::SIGNATURE_LENGTH];
+	signer.Sign(U("GET"), U("docs"), string_t(3000, U('X')), U("Tue, 01 Nov 1994 08:12:31 GMT"), signature);
+	assert(string_t(signature, RequestSigner::SIGNATURE_LENGTH) == U("f3yCoxaIJ+TuInrQipGHb0dFzw8cmluTIAYDjNUrvYQ="));
+
+	// Authorization header is url encoded and the same when served from the cache
+	string_t authorization = signer.Authorization(U("GET"), U("docs"), string_t(3000, U('X')), U("Tue, 01 Nov 1994 08:12:31 GMT"));
+	assert(authorization == web::uri::encode_data_string(U("type=master&ver=1.0&sig=f3yCoxaIJ+TuInrQipGHb0dFzw8cmluTIAYDjNUrvYQ=")));
+	assert(authorization == signer.Authorization(U("GET"), U("docs"), string_t(3000, U('X')), U("Tue, 01 Nov 1994 08:12:31 GMT")));
+	assert(authorization != signer.Authorization(U("GET"), U("docs"), string_t(3000, U('X')), U("Tue, 01 Nov 1994 08:12:32 GMT")));
+
+	// Name based links keep their case
+	utility::char_t name_based[RequestSigner::SIGNATURE_LENGTH];
+	signer.Sign(U("GET"), U("docs"), U("dbs/db/colls/coll"), U("Tue, 01 Nov 1994 08:12:31 GMT"), signature);
+	signer.Sign(U("GET"), U("docs"), U("dbs/db/colls/coll"), U("Tue, 01 Nov 1994 08:12:31 GMT"), name_based, true);
+	assert(string_t(signature, RequestSigner::SIGNATURE_LENGTH) == string_t(name_based, RequestSigner::SIGNATURE_LENGTH));
+	signer.Sign(U("GET"), U("docs"), U("dbs/Db/colls/Coll"), U("Tue, 01 Nov 1994 08:12:31 GMT"), name_based, true);
+	assert(string_t(signature, RequestSigner::SIGNATURE_LENGTH) != string_t(name_based, RequestSigner::SIGNATURE_LENGTH));
+	assert(signer.Authorization(U("GET"), U("docs"), U("dbs/Db"), U("Tue, 01 Nov 1994 08:12:31 GMT"))
+		!= signer.Authorization(U("GET"), U("docs"), U("dbs/Db"), U("Tue, 01 Nov 1994 08:12:31 GMT"), true));
+}
+
+void test_request_limiter()
+{
+	RequestLimiter limiter(2);
+	pplx::task<void> first = limiter.AcquireAsync();
+	pplx::task<void> second = limiter.AcquireAsync();
+	assert(first.is_done() && second.is_done());
+
+	// Over the limit requests wait for a slot, in order
+	pplx::task<void> third = limiter.AcquireAsync();
+	pplx::task<void> fourth = limiter.AcquireAsync();
+	assert(!third.is_done() && !fourth.is_done());
+
+	limiter.Release();
+	third.wait();
+	assert(!fourth.is_done());
+
+	limiter.Release();
+	fourth.wait();
+	limiter.Release();
+	limiter.Release();
+
+	// Released slots are reusable
+	assert(limiter.AcquireAsync().is_done());
+	limiter.Release();
+
+	// No limit by default
+	ConnectionPolicy policy;
+	assert(policy.max_connections() == 0);
+	RequestLimiter unlimited(policy.max_connections());
+	for (int i = 0; i < 100; i++)
+	{
+		assert(unlimited.AcquireAsync().is_done());
+	}
+}
+
+void test_socket_options()
+{
+#ifndef _WIN32
+	boost::asio::io_service service;
+	boost::asio::ip::tcp::acceptor acceptor(service, boost::asio::ip::tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+	boost::asio::ip::tcp::socket socket(service);
+
+	// Sockets of new connections are opened so that the options are set before
+	// they are connected
+	vector<boost::system::error_code> errors;
+	ConnectionPolicy policy;
+	policy.set_socket_error_handler([&errors](const boost::system::error_code& error)
+	{
+		errors.push_back(error);
+	});
+	web::http::client::http_client_config config = policy.ToHttpClientConfig(
+		U("http://127.0.0.1:") + utility::conversions::print_string(acceptor.local_endpoint().port()));
+	config.invoke_nativehandle_options(&socket);
+	assert(errors.empty() && socket.is_open());
+	boost::asio::ip::tcp::no_delay no_delay;
+	boost::asio::socket_base::keep_alive keep_alive;
+	socket.get_option(no_delay);
+	socket.get_option(keep_alive);
+	assert(no_delay.value() && keep_alive.value());
+
+	// and keep them once connected and reused
+	socket.connect(acceptor.local_endpoint());
+	config.invoke_nativehandle_options(&socket);
+	assert(errors.empty());
+	socket.get_option(no_delay);
+	socket.get_option(keep_alive);
+	assert(no_delay.value() && keep_alive.value());
+
+	// The first request on a fresh cpprest connection already runs with them
+	boost::asio::ip::tcp::acceptor server(service, boost::asio::ip::tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+	string_t server_url = U("http://127.0.0.1:") + utility::conversions::print_string(server.local_endpoint().port());
+	web::http::client::http_client_config fresh_config = policy.ToHttpClientConfig(server_url);
+	web::http::client::http_client_config checked_config = fresh_config;
+	atomic<boost::asio::ip::tcp::socket*> client_socket(nullptr);
+	checked_config.set_nativehandle_options([&fresh_config, &client_socket](web::http::client::native_handle handle)
+	{
+		fresh_config.invoke_nativehandle_options(handle);
+		client_socket = static_cast<boost::asio::ip::tcp::socket*>(handle);
+	});
+	bool connected_with_options = false;
+	thread responder([&service, &server, &client_socket, &connected_with_options]()
+	{
+		boost::asio::ip::tcp::socket server_socket(service);
+		server.accept(server_socket);
+		boost::asio::streambuf request;
+		boost::asio::read_until(server_socket, request, "\r\n\r\n");
+
+		// The client connection is waiting for the response
+		boost::asio::ip::tcp::no_delay client_no_delay;
+		boost::asio::socket_base::keep_alive client_keep_alive;
+		client_socket.load()->get_option(client_no_delay);
+		client_socket.load()->get_option(client_keep_alive);
+		connected_with_options = client_no_delay.value() && client_keep_alive.value();
+
+		boost::asio::write(server_socket, boost::asio::buffer(string("HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n")));
+	});
+	web::http::client::http_client fresh_client(server_url, checked_config);
+	assert(fresh_client.request(web::http::methods::GET).get().status_code() == web::http::status_codes::OK);
+	responder.join();
+	assert(connected_with_options && errors.empty());
+
+	policy.set_tcp_no_delay(false);
+	policy.set_keep_alive(false);
+	assert(!policy.ApplySocketOptions(socket));
+	socket.get_option(no_delay);
+	socket.get_option(keep_alive);
+	assert(!no_delay.value() && !keep_alive.value());
+#endif
+}
+
+void test_retry_budget()
+{
+	RetryOptions options;
+	RetryBudget budget(options.retry_budget_tokens(), options.retry_budget_refill_ratio());
+
+	// Retries are allowed down to half of the budget
+	int retries = 0;
+	while (budget.TryAcquire())
+	{
+		retries++;
+	}
+	assert(retries == 50);
+
+	// Every successful request refills a tenth of a retry
+	for (int i = 0; i < 15; i++)
+	{
+		budget.OnSuccess();
+	}
+	assert(budget.TryAcquire());
+	assert(!budget.TryAcquire());
+
+	// Budget never grows past its capacity
+	for (int i = 0; i < 10000; i++)
+	{
+		budget.OnSuccess();
+	}
+	assert(budget.tokens() == options.retry_budget_tokens());
+
+	// A budget of 0 never throttles retries
+	RetryBudget disabled(0, 0);
+	for (int i = 0; i < 1000; i++)
+	{
+		assert(disabled.TryAcquire());
+	}
+
+	// Only requests that are safe to repeat are resent after a transport error
+	string key_text = "key";
+	RequestSigner signer(vector<unsigned char>(key_text.begin(), key_text.end()));
+	assert(IsSafeToResend(CreateRequest(methods::GET, U("docs"), U("dbs/db/colls/coll/docs/doc"), signer)));
+	assert(IsSafeToResend(CreateRequest(methods::PUT, U("docs"), U("dbs/db/colls/coll/docs/doc"), signer)));
+	assert(IsSafeToResend(CreateRequest(methods::DEL, U("docs"), U("dbs/db/colls/coll/docs/doc"), signer)));
+	assert(IsSafeToResend(CreateQueryRequest(SqlQuerySpec(U("SELECT * FROM c")), 10, U("docs"), U("dbs/db/colls/coll"), signer)));
+
+	http_request create = CreateRequest(methods::POST, U("docs"), U("dbs/db/colls/coll"), signer);
+	assert(!IsSafeToResend(create));
+	create.headers().add(U("x-ms-documentdb-is-upsert"), U("true"));
+	assert(IsSafeToResend(create));
+	assert(!IsSafeToResend(CreateRequest(methods::POST, U("sprocs"), U("dbs/db/colls/coll/sprocs/sproc"), signer)));
+}
+
+void test_bulk_pipeline()
+{
+	const int item_count = 200;
+	BulkOptions options;
+	options.set_max_concurrency(8);
+	options.set_ordered(true);
+
+	int produced = 0;
+	atomic<int> in_flight(0);
+	atomic<int> max_in_flight(0);
+	vector<size_t> reported;
+	shared_ptr<BulkPipeline> pipeline = make_shared<BulkPipeline>(
+		options,
+		[&produced](value& item)
+		{
+			if (produced == item_count)
+			{
+				return false;
+			}
+			item = value::number(produced++);
+			return true;
+		},
+		[&in_flight, &max_in_flight](const value& item)
+		{
+			int current = ++in_flight;
+			int seen = max_in_flight;
+			while (current > seen && !max_in_flight.compare_exchange_weak(seen, current))
+			{
+			}
+
+			// Items complete out of order, some of them after being throttled
+			return pplx::create_task([&in_flight, item]()
+			{
+				this_thread::sleep_for(chrono::milliseconds(item.as_integer() % 3));
+				in_flight--;
+
+				ResponseDiagnostics diagnostics;
+				diagnostics.set_throttled_retry_count(item.as_integer() % 50 == 0 ? 1 : 0);
+				return DocumentDBResponse(
+					web::http::http_response(web::http::status_codes::Created),
+					make_shared<value>(item),
+					diagnostics);
+			});
+		},
+		[](const DocumentDBResponse& response)
+		{
+			if (response.json().as_integer() % 7 == 0)
+			{
+				throw DocumentDBRuntimeException(U("failed"));
+			}
+			return shared_ptr<Document>();
+		},
+		[&reported](const BulkItemResult& result)
+		{
+			assert(result.succeeded() == (result.index() % 7 != 0));
+			reported.push_back(result.index());
+		});
+	pipeline->RunAsync().wait();
+
+	// Every item is reported once, in order, and never more than the maximum are in flight
+	assert(reported.size() == item_count);
+	for (size_t i = 0; i < reported.size(); i++)
+	{
+		assert(reported[i] == i);
+	}
+	assert(max_in_flight <= 8);
+
+	// The producer and the result handler run one at a time, without the
+	// pipeline locked, so they may call back into it
+	produced = 0;
+	atomic<bool> in_callback(false);
+	size_t unordered_reported = 0;
+	shared_ptr<BulkPipeline> reentrant;
+	options.set_ordered(false);
+	reentrant = make_shared<BulkPipeline>(
+		options,
+		[&produced, &in_callback](value& item)
+		{
+			assert(!in_callback.exchange(true));
+			bool more = produced < item_count;
+			if (more)
+			{
+				item = value::number(produced++);
+			}
+			in_callback = false;
+			return more;
+		},
+		[](const value& item)
+		{
+			return pplx::create_task([item]()
+			{
+				return DocumentDBResponse(
+					web::http::http_response(web::http::status_codes::Created),
+					make_shared<value>(item),
+					ResponseDiagnostics());
+			});
+		},
+		[](const DocumentDBResponse&)
+		{
+			return shared_ptr<Document>();
+		},
+		[&reentrant, &unordered_reported, &in_callback](const BulkItemResult&)
+		{
+			assert(!in_callback.exchange(true));
+			assert(!reentrant->RunAsync().is_done());
+			this_thread::sleep_for(chrono::microseconds(100));
+			unordered_reported++;
+			in_callback = false;
+		});
+	reentrant->RunAsync().wait();
+	assert(unordered_reported == item_count);
+}
+
+void test_json_array_reader()
+{
+	const std::string body =
+		"{\"_rid\":\"abc==\",\"Other\":[1,{\"Documents\":[]}],\"Documents\":"
+		"[ {\"id\":\"a\",\"n\":[1,2],\"s\":\"]},\\\"\"}, 42 ,\"x\",[true,null] ],\"_count\":4}";
+
+	// Split at every position, elements must not depend on chunk boundaries
+	for (size_t split = 0; split <= body.size(); split++)
+	{
+		vector<value> items;
+		JsonArrayReader reader(U("Documents"), [&items](value&& item)
+		{
+			items.push_back(move(item));
+		});
+		reader.Read(body.data(), split);
+		reader.Read(body.data() + split, body.size() - split);
+		value envelope = reader.Finish();
+
+		assert(items.size() == 4);
+		assert(items[0].at(U("s")).as_string() == U("]},\""));
+		assert(items[0].at(U("n")).as_array().size() == 2);
+		assert(items[1].as_integer() == 42);
+		assert(items[2].as_string() == U("x"));
+		assert(items[3].as_array().size() == 2);
+		assert(envelope.at(U("Documents")).as_array().size() == 0);
+		assert(envelope.at(U("Other")).as_array().size() == 2);
+		assert(envelope.at(U("_count")).as_integer() == 4);
+	}
+}
+
+void test_document_mapping()
+{
+	Order order;
+	order.id = U("order \"1\"\n");
+	order.total = -9007199254740993LL;
+	order.price = 0.1;
+	order.shipped = true;
+	OrderLine line = { U("sku1"), 3 };
+	order.lines.push_back(line);
+
+	Order decoded = DecodeDocument<Order>(EncodeDocument(order));
+	assert(decoded.id == order.id);
+	assert(decoded.total == order.total);
+	assert(decoded.price == order.price);
+	assert(decoded.shipped);
+	assert(decoded.lines.size() == 1 && decoded.lines[0].quantity == 3);
+
+	// Unknown fields are skipped, null fields keep their value
+	decoded = DecodeDocument<Order>(
+		" {\"other\": {\"a\": [1, {\"b\": \"}\\\"\"}]}, \"id\": \"\\u00e9\", \"lines\": null, \"price\": 1e2 } ");
+	assert(decoded.id == utility::conversions::to_string_t(std::string("\xC3\xA9")));
+	assert(decoded.price == 100);
+	assert(decoded.lines.empty());
+
+	assert(DocumentFields<Order>::Instance().Has(U("id")));
+	assert(!DocumentFields<OrderLine>::Instance().Has(U("id")));
+
+	try
+	{
+		DecodeDocument<Order>("{\"id\": 1}");
+		assert(false);
+	}
+	catch (const DocumentDBRuntimeException&)
+	{
+		// Pass
+	}
+}
+
+void test_partition_key()
+{
+	PartitionKeyDefinition definition(U("/address/\"zip code\""));
+	PartitionKeyDefinition parsed = PartitionKeyDefinition::FromJson(definition.ToJson());
+	assert(parsed.path() == definition.path());
+	assert(parsed.kind() == U("Hash"));
+
+	value document = value::parse(U("{\"address\":{\"zip code\":\"98052\"}}"));
+	assert(parsed.Extract(document).header() == U("[\"98052\"]"));
+	assert(parsed.Extract(value::parse(U("{\"address\":{}}"))).header() == U("[{}]"));
+	assert(PartitionKeyDefinition(U("/n")).Extract(value::parse(U("{\"n\":7}"))).header() == U("[7]"));
+
+	// Documents of collections that are not partitioned have no partition key
+	assert(PartitionKeyDefinition().Extract(document).empty());
+	assert(PartitionKey().empty());
+
+	try
+	{
+		PartitionKeyDefinition(U("address"));
+		assert(false);
+	}
+	catch (const DocumentDBRuntimeException&)
+	{
+		// Pass
+	}
+}
+
+vector<value> parse_values(
+	const utility::string_t& json)
+{
+	value parsed = value::parse(json);
+	return vector<value>(parsed.as_array().begin(), parsed.as_array().end());
+}
+
+void test_parallel_query_merge()
+{
+	vector<vector<value>> ranges;
+	ranges.push_back(parse_values(U("[{\"n\":1},{\"n\":4},{\"n\":\"a\"}]")));
+	ranges.push_back(vector<value>());
+	ranges.push_back(parse_values(U("[{},{\"n\":null},{\"n\":2},{\"n\":4}]")));
+
+	// Plain results are concatenated in range order
+	ParallelQueryOptions options;
+	vector<value> merged = ParallelQuery::Merge(vector<vector<value>>(ranges), options);
+	assert(merged.size() == 7);
+	assert(merged[3] == value::object());
+
+	// Sorted ranges are merged, undefined and null first, ties to the earlier range
+	options.set_order_by(U("/n"));
+	merged = ParallelQuery::Merge(vector<vector<value>>(ranges), options);
+	assert(merged.size() == 7);
+	assert(!merged[0].has_field(U("n")));
+	assert(merged[1].at(U("n")).is_null());
+	assert(merged[2].at(U("n")).as_integer() == 1);
+	assert(merged[3].at(U("n")).as_integer() == 2);
+	assert(merged[6].at(U("n")).as_string() == U("a"));
+
+	options.set_top(2);
+	merged = ParallelQuery::Merge(vector<vector<value>>(ranges), options);
+	assert(merged.size() == 2);
+
+	ranges.clear();
+	ranges.push_back(parse_values(U("[{\"n\":\"a\"},{\"n\":3}]")));
+	ranges.push_back(parse_values(U("[{\"n\":5},{\"n\":1}]")));
+	options.set_order_by(U("/n"), true);
+	options.set_top(0);
+	merged = ParallelQuery::Merge(vector<vector<value>>(ranges), options);
+	assert(merged[0].at(U("n")).as_string() == U("a"));
+	assert(merged[1].at(U("n")).as_integer() == 5);
+	assert(merged[3].at(U("n")).as_integer() == 1);
+
+	// Aggregates of the ranges are combined into one value
+	ranges.clear();
+	ranges.push_back(parse_values(U("[3]")));
+	ranges.push_back(vector<value>());
+	ranges.push_back(parse_values(U("[4]")));
+	ParallelQueryOptions count;
+	count.set_aggregate(AGGREGATE_COUNT);
+	merged = ParallelQuery::Merge(vector<vector<value>>(ranges), count);
+	assert(merged.size() == 1 && merged[0].as_integer() == 7);
+	ParallelQueryOptions max;
+	max.set_aggregate(AGGREGATE_MAX);
+	merged = ParallelQuery::Merge(vector<vector<value>>(ranges), max);
+	assert(merged.size() == 1 && merged[0].as_integer() == 4);
+
+	// Averages of the ranges cannot be combined
+	const char_t* averages[] = {
+		U("SELECT VALUE AVG(c.n) FROM c"),
+		U("SELECT VALUE avg (c.n) FROM c WHERE c.s = 'x'"),
+	};
+	for (size_t i = 0; i < sizeof(averages) / sizeof(averages[0]); i++)
+	{
+		try
+		{
+			make_shared<ParallelQuery>(nullptr, SqlQuerySpec(averages[i]), count, vector<PartitionKeyRange>());
+			assert(false);
+		}
+		catch (const DocumentDBRuntimeException&)
+		{
+		}
+	}
+	make_shared<ParallelQuery>(nullptr, SqlQuerySpec(U("SELECT c.avg FROM c WHERE c.s = 'AVG(1)'")), ParallelQueryOptions(), vector<PartitionKeyRange>());
+}
+
+void test_sql_query_spec()
+{
+	// Queries without parameters are sent as they are
+	SqlQuerySpec text(U("SELECT * FROM c"));
+	assert(text.body() == U("SELECT * FROM c"));
+	assert(text.content_type() == U("application/sql"));
+
+	vector<SqlParameter> parameters;
+	parameters.push_back(SqlParameter(U("@id"), value::string(U("a\"b"))));
+	parameters.push_back(SqlParameter(U("@n"), value::number(7)));
+	SqlQuerySpec spec(U("SELECT * FROM c WHERE c.id = @id AND c.n > @n"), parameters);
+	assert(spec.content_type() == U("application/query+json"));
+	value body = value::parse(spec.body());
+	assert(body.at(U("query")).as_string() == spec.query());
+	assert(body.at(U("parameters")).size() == 2);
+	assert(body.at(U("parameters")).at(0).at(U("name")).as_string() == U("@id"));
+	assert(body.at(U("parameters")).at(0).at(U("value")).as_string() == U("a\"b"));
+	assert(body.at(U("parameters")).at(1).at(U("value")).as_integer() == 7);
+
+	// Prepared queries produce the same body
+	vector<utility::string_t> names;
+	names.push_back(U("@id"));
+	names.push_back(U("@n"));
+	PreparedQuery prepared(spec.query(), names);
+	vector<value> values;
+	values.push_back(value::string(U("a\"b")));
+	values.push_back(value::number(7));
+	SqlQuerySpec bound = prepared.Bind(values);
+	assert(bound.content_type() == U("application/query+json"));
+	assert(value::parse(bound.body()) == body);
+	assert(bound.parameters().size() == 2);
+
+	assert(value::parse(PreparedQuery(U("SELECT * FROM c"), vector<utility::string_t>()).Bind(vector<value>()).body()).at(U("parameters")).size() == 0);
+
+	try
+	{
+		prepared.Bind(vector<value>(1, value::number(7)));
+		assert(false);
+	}
+	catch (const DocumentDBRuntimeException&)
+	{
+		// Pass
+	}
+}
+
+shared_ptr<Document> cached_document(
+	const utility::string_t& resource_id)
+{
+	return make_shared<Document>(
+		shared_ptr<const DocumentDBConfiguration>(),
+		resource_id,
+		resource_id,
+		0,
+		resource_id,
+		U("\"etag\""),
+		U("attachments/"),
+		value::object());
+}
+
+void test_document_detach()
+{
+	shared_ptr<const value> page = make_shared<const value>(value::parse(
+		U("[{\"id\":\"a\",\"_rid\":\"rid\",\"_ts\":1,\"_self\":\"self\",\"_etag\":\"etag\",\"_attachments\":\"attachments/\",\"n\":1}]")));
+	shared_ptr<Document> document = make_shared<Document>(
+		shared_ptr<const DocumentDBConfiguration>(),
+		shared_ptr<const value>(page, &page->at(0)));
+	assert(page.use_count() == 2);
+
+	// The detached copy does not keep the page alive
+	shared_ptr<Document> detached = document->Detach();
+	document.reset();
+	assert(page.use_count() == 1);
+	assert(detached->id() == U("a"));
+	assert(detached->resource_id() == U("rid"));
+	assert(detached->attachments() == U("attachments/"));
+	assert(detached->payload() == page->at(0));
+}
+
+void test_document_cache()
+{
+	// Room for four documents of 1000 bytes
+	DocumentCache cache(4800);
+	shared_ptr<Document> document;
+	exception_ptr not_found;
+	for (int i = 1; i <= 4; i++)
+	{
+		utility::string_t resource_id = U("hot") + utility::conversions::to_string_t(std::to_string(i));
+		cache.Put(resource_id, cached_document(resource_id), 1000);
+		for (int j = 0; j < 3; j++)
+		{
+			assert(cache.TryGet(resource_id, document, not_found));
+			assert(document->resource_id() == resource_id && !not_found);
+		}
+	}
+	assert(cache.count() == 4 && cache.bytes() <= cache.max_bytes());
+
+	// A document read once does not push out the hot ones
+	assert(!cache.TryGet(U("cold"), document, not_found));
+	cache.Put(U("cold"), cached_document(U("cold")), 1000);
+	assert(!cache.TryGet(U("cold"), document, not_found));
+	assert(cache.count() == 4);
+
+	// Once it is asked for more often it does, in place of the least recently used
+	for (int i = 0; i < 10; i++)
+	{
+		cache.TryGet(U("cold"), document, not_found);
+	}
+	cache.Put(U("cold"), cached_document(U("cold")), 1000);
+	assert(cache.TryGet(U("cold"), document, not_found));
+	assert(!cache.TryGet(U("hot1"), document, not_found));
+	assert(cache.count() == 4 && cache.bytes() <= cache.max_bytes());
+
+	cache.Remove(U("cold"));
+	assert(!cache.TryGet(U("cold"), document, not_found));
+	assert(cache.count() == 3);
+
+	// Misses are remembered for a while
+	DocumentCache misses(4800);
+	misses.PutNotFound(U("gone"), make_exception_ptr(ResourceNotFoundException(web::http::status_codes::NotFound, U("NotFound"), U("gone"))));
+	document = nullptr;
+	assert(misses.TryGet(U("gone"), document, not_found));
+	assert(!document && not_found);
+	try
+	{
+		rethrow_exception(not_found);
+	}
+	catch (const ResourceNotFoundException&)
+	{
+		// Pass
+	}
+
+	DocumentCache expired(4800, chrono::milliseconds(0));
+	expired.PutNotFound(U("gone"), not_found);
+	assert(!expired.TryGet(U("gone"), document, not_found));
+}
+
+void test_metadata_cache()
+{
+	shared_ptr<MetadataCache> cache = make_shared<MetadataCache>(chrono::hours(1));
+	atomic<int> loads(0);
+	function<pplx::task<shared_ptr<int>>()> load = [&loads]()
+	{
+		return pplx::task_from_result(make_shared<int>(++loads));
+	};
+	function<string_t(const int&)> self_link_of = [](const int&)
+	{
+		return string_t(U("dbs/rid/colls/rid/"));
+	};
+
+	// Loaded once, then served from the cache
+	assert(*cache->GetAsync<int>(U("dbs/db/colls/coll"), load, self_link_of).get() == 1);
+	assert(*cache->GetAsync<int>(U("/dbs/db/colls/coll/"), load, self_link_of).get() == 1);
+	assert(cache->count() == 1);
+
+	// Requests on what a resource contains leave it cached, unless its owner is gone
+	cache->Invalidate(U("dbs/rid/colls/rid/docs/doc"));
+	assert(cache->count() == 1);
+	cache->Invalidate(U("dbs/rid/colls/rid/docs/doc"), true);
+	assert(cache->count() == 0);
+	assert(*cache->GetAsync<int>(U("dbs/db/colls/coll"), load, self_link_of).get() == 2);
+
+	// Requests on its database drop it, whatever link it was read from
+	cache->Invalidate(U("dbs/rid"));
+	assert(cache->count() == 0);
+	cache->Invalidate(U("dbs/ri"));
+
+	// Only resource types are told apart from ids, a database may be named docs
+	assert(*cache->GetAsync<int>(U("dbs/docs/colls/attachments"), load).get() == 3);
+	cache->Invalidate(U("dbs/docs/colls/attachments/docs/doc/attachments/"));
+	assert(cache->count() == 1);
+	cache->Invalidate(U("/dbs/docs/"));
+	assert(cache->count() == 0);
+
+	// A resource read before its database was invalidated is returned, but not
+	// cached, and later lookups do not wait for it
+	pplx::task_completion_event<shared_ptr<int>> first_read;
+	function<pplx::task<shared_ptr<int>>()> pending_load = [first_read]()
+	{
+		return pplx::create_task(first_read);
+	};
+	function<pplx::task<shared_ptr<int>>()> fresh_load = []()
+	{
+		return pplx::task_from_result(make_shared<int>(0));
+	};
+	pplx::task<shared_ptr<int>> pending = cache->GetAsync<int>(U("dbs/db/colls/pending"), pending_load);
+	cache->Invalidate(U("dbs/db"));
+	assert(*cache->GetAsync<int>(U("dbs/db/colls/pending"), fresh_load).get() == 0);
+	first_read.set(make_shared<int>(-1));
+	assert(*pending.get() == -1);
+	assert(*cache->GetAsync<int>(U("dbs/db/colls/pending"), pending_load).get() == 0);
+	assert(cache->count() == 1);
+	cache->Invalidate(U("dbs/db"));
+	pending = cache->GetAsync<int>(U("dbs/db/colls/pending"), pending_load);
+	cache->Clear();
+	assert(*pending.get() == -1);
+	assert(cache->count() == 0);
+
+	// Stale resources are served while read again in the background
+	shared_ptr<MetadataCache> expiring = make_shared<MetadataCache>(chrono::milliseconds(1));
+	assert(*expiring->GetAsync<int>(U("dbs/db"), load).get() == 4);
+	this_thread::sleep_for(chrono::milliseconds(10));
+	assert(*expiring->GetAsync<int>(U("dbs/db"), load).get() == 4);
+	while (loads < 5)
+	{
+		this_thread::yield();
+	}
+
+	// A ttl of 0 loads every time
+	shared_ptr<MetadataCache> disabled = make_shared<MetadataCache>(chrono::milliseconds(0));
+	assert(*disabled->GetAsync<int>(U("dbs/db"), load).get() == 6);
+	assert(*disabled->GetAsync<int>(U("dbs/db"), load).get() == 7);
+	assert(disabled->count() == 0);
+}
+
+void test_cached_metadata(
+	const DocumentClient& client)
+{
+	string_t db_name = generate_random_string(8);
+	shared_ptr<Database> db = client.CreateDatabase(db_name);
+
+	// Lookups by id and by resource id are served from the cache
+	shared_ptr<Database> cached_db = client.GetDatabaseById(db_name);
+	assert(cached_db->resource_id() == db->resource_id());
+	assert(client.GetDatabaseByIdAsync(db_name).get() == cached_db);
+	assert(client.GetDatabase(db->resource_id()) == client.GetDatabaseAsync(db->resource_id()).get());
+
+	shared_ptr<Collection> coll = db->CreateCollection(generate_random_string(8));
+	shared_ptr<Collection> cached_coll = db->GetCollectionById(coll->id());
+	assert(cached_coll->resource_id() == coll->resource_id());
+	assert(db->GetCollectionById(coll->id()) == cached_coll);
+
+	// Lists are read again once something is created in them
+	assert(coll->ListStoredProcedures().empty());
+	coll->CreateStoredProcedure(U("sproc"), U("function () { getContext().getResponse().setBody(1); }"));
+	assert(coll->ListStoredProcedures().size() == 1);
+
+	// Deleted resources are no longer served
+	db->DeleteCollection(coll);
+	try
+	{
+		db->GetCollectionById(coll->id());
+		assert(false);
+	}
+	catch (const ResourceNotFoundException&)
+	{
+		// Pass
+	}
+
+	client.DeleteDatabase(db->resource_id());
+	try
+	{
+		client.GetDatabaseById(db_name);
+		assert(false);
+	}
+	catch (const ResourceNotFoundException&)
+	{
+		// Pass
+	}
+}
+
 void test_databases(
 	const DocumentClient& client)
 {
@@ -364,6 +1225,8 @@ void test_documents(
 
 	shared_ptr<DocumentIterator> iter = coll->QueryDocumentsAsync(U("SELECT * FROM ") + coll_name).get();
 	assert(!iter->HasMore());
+	assert(iter->diagnostics().status_code() == web::http::status_codes::OK);
+	assert(iter->diagnostics().request_charge() > 0);
 
 	// Try inserting one document with ID set
 	value document1;
@@ -416,6 +1279,26 @@ void test_documents(
 		// Pass
 	}
 
+	// Concurrent operations report to the handler of the view they were sent through
+	vector<ResponseDiagnostics> first_diagnostics;
+	vector<ResponseDiagnostics> second_diagnostics;
+	shared_ptr<Collection> first_view = coll->WithDiagnosticsHandler([&first_diagnostics](const ResponseDiagnostics& diagnostics)
+	{
+		first_diagnostics.push_back(diagnostics);
+	});
+	shared_ptr<Collection> second_view = coll->WithDiagnosticsHandler([&second_diagnostics](const ResponseDiagnostics& diagnostics)
+	{
+		second_diagnostics.push_back(diagnostics);
+	});
+	pplx::task<void> first = first_view->GetDocumentAsync(doc->resource_id()).then([](shared_ptr<Document>) {});
+	pplx::task<void> second = second_view->QueryDocumentsAsync(U("SELECT * FROM ") + coll_name).then([](shared_ptr<DocumentIterator>) {});
+	first.wait();
+	second.wait();
+	assert(first_diagnostics.size() == 1 && second_diagnostics.size() == 1);
+	assert(first_diagnostics[0].method() == web::http::methods::GET);
+	assert(second_diagnostics[0].method() == web::http::methods::POST);
+	assert(first_diagnostics[0].request_charge() > 0);
+
 	// Get document
 	shared_ptr<Document> doc_get = coll->GetDocumentAsync(doc->resource_id()).get();
 	assert(doc_get->payload().at(U("foo")).as_string() == U("bar"));
@@ -503,6 +1386,14 @@ void test_documents(
 
 	coll->DeleteDocument(doc->resource_id());
 
+	// Rvalue documents get their id added in place
+	value document3;
+	document3[U("foo")] = value::string(U("moved"));
+	doc = coll->CreateDocumentAsync(move(document3)).get();
+	assert(doc->payload().at(U("foo")).as_string() == U("moved"));
+	assert(doc->payload().at(U("id")).as_string() == doc->id());
+	coll->DeleteDocument(doc->resource_id());
+
 	// Try inserting document as JSON
 	string_t id = generate_random_string(32);
 	string_t json_object = U("{\"id\": \"") + id + U("\", \"foo3\": \"bar3\" }");
@@ -532,6 +1423,263 @@ void test_documents(
 	iter = coll->QueryDocuments(U("SELECT * FROM ") + coll_name);
 	assert(!iter->HasMore());
 
+	// Bulk insert, the duplicate fails on its own without failing the others
+	vector<value> documents;
+	for (int i = 0; i < 100; i++)
+	{
+		value document;
+		document[U("id")] = value::string(U("bulk") + utility::conversions::print_string(i));
+		documents.push_back(document);
+	}
+	documents.push_back(documents[0]);
+
+	BulkOptions bulk_options;
+	bulk_options.set_max_concurrency(16);
+	vector<BulkItemResult> results = coll->CreateDocumentsAsync(documents, bulk_options).get();
+	assert(results.size() == documents.size());
+	int failed = 0;
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		assert(results[i].index() == i);
+		if (!results[i].succeeded())
+		{
+			failed++;
+			continue;
+		}
+		assert(results[i].document()->id() == documents[i].at(U("id")).as_string());
+	}
+	assert(failed == 1);
+	// Link suffixes are shared between entities, which stay copy-assignable
+	assert(&results[1].document()->attachments() == &results[2].document()->attachments());
+	Document copied_document = *results[1].document();
+	copied_document = *results[2].document();
+	assert(copied_document.id() == results[2].document()->id());
+	Collection copied_collection = *coll;
+	copied_collection = *coll;
+	assert(copied_collection.docs() == coll->docs());
+	assert(coll->ListDocuments().size() == 100);
+
+	// Parameter values are sent apart from the query text
+	vector<SqlParameter> parameters;
+	parameters.push_back(SqlParameter(U("@id"), value::string(U("bulk42"))));
+	iter = coll->QueryDocuments(SqlQuerySpec(U("SELECT * FROM c WHERE c.id = @id"), parameters));
+	assert(iter->HasMore());
+	assert(iter->Next()->id() == U("bulk42"));
+	assert(!iter->HasMore());
+
+	vector<utility::string_t> names(1, U("@id"));
+	PreparedQuery by_id(U("SELECT * FROM c WHERE c.id = @id"), names);
+	for (int i = 0; i < 3; i++)
+	{
+		utility::string_t id = U("bulk") + utility::conversions::print_string(i);
+		iter = coll->QueryDocuments(by_id.Bind(vector<value>(1, value::string(id))));
+		assert(iter->Next()->id() == id);
+	}
+
+	// Server side import in several batches, the second import reuses the stored procedure
+	documents.clear();
+	for (int i = 0; i < 300; i++)
+	{
+		value document;
+		document[U("id")] = value::string(U("import") + utility::conversions::print_string(i));
+		document[U("payload")] = value::string(generate_random_string(64));
+		documents.push_back(document);
+	}
+
+	BulkImportOptions import_options;
+	import_options.set_max_batch_size_bytes(4096);
+	assert(coll->ImportDocumentsAsync(vector<value>(documents.begin(), documents.begin() + 250), import_options).get() == 250);
+	assert(coll->ImportDocuments(vector<value>(documents.begin() + 250, documents.end()), import_options) == 50);
+	assert(coll->ImportDocuments(vector<value>()) == 0);
+	assert(coll->ListDocuments().size() == 400);
+
+	// Small pages are read ahead while the current one is consumed
+	iter = coll->QueryDocuments(U("SELECT * FROM ") + coll_name, 7);
+	count = 0;
+	while (iter->HasMore())
+	{
+		iter->Next();
+		count++;
+	}
+	assert(count == 400);
+
+	iter = coll->QueryDocumentsAsync(U("SELECT * FROM ") + coll_name, 7).get();
+	count = 0;
+	for (vector<shared_ptr<Document>> page = iter->NextPageAsync().get(); !page.empty(); page = iter->NextPage())
+	{
+		assert(page.size() <= 7);
+		count += (int)page.size();
+	}
+	assert(count == 400);
+	assert(iter->NextAsync().get() == nullptr);
+	assert(!iter->HasMoreAsync().get());
+
+	// Streamed results are handed out one by one as they are read
+	count = 0;
+	coll->ListDocuments([&count](const shared_ptr<Document>&)
+	{
+		count++;
+	});
+	assert(count == 400);
+
+	count = 0;
+	coll->QueryDocumentsAsync(U("SELECT * FROM ") + coll_name, [&count](const shared_ptr<Document>& document)
+	{
+		assert(!document->resource_id().empty());
+		count++;
+	}, 7).get();
+	assert(count == 400);
+
+	// Typed documents are encoded and decoded without a DOM
+	Order order = Order();
+	order.id = U("typed1");
+	order.total = 42;
+	order.price = 9.5;
+	OrderLine line = { U("sku1"), 2 };
+	order.lines.push_back(line);
+	Order created = coll->CreateDocumentAsAsync(order).get();
+	assert(created.id == order.id);
+	assert(!created.resource_id.empty());
+	Order read = coll->GetDocumentAs<Order>(created.resource_id);
+	assert(read.total == 42 && read.price == 9.5 && read.lines.size() == 1);
+	vector<Order> orders = coll->QueryDocumentsAs<Order>(U("SELECT * FROM c WHERE c.id = 'typed1'"));
+	assert(orders.size() == 1 && orders[0].lines[0].sku == U("sku1"));
+	count = 0;
+	coll->QueryDocumentsAsAsync<Order>(U("SELECT * FROM ") + coll_name, [&count](Order&&)
+	{
+		count++;
+	}, 7).get();
+	assert(count == 401);
+	coll->DeleteDocument(created.resource_id);
+
+	// Projections come back as values
+	shared_ptr<ValueIterator> values = coll->QueryValuesAsync(U("SELECT c.id FROM ") + coll_name + U(" c"), 7).get();
+	count = 0;
+	while (values->HasMore())
+	{
+		assert(values->Next().has_field(U("id")));
+		count++;
+	}
+	assert(count == 400);
+	vector<value> counts = coll->QueryValues(U("SELECT VALUE COUNT(1) FROM ") + coll_name)->NextPage();
+	assert(counts.size() == 1 && counts[0].as_integer() == 400);
+
+	// Raw documents pass through as bytes
+	const string raw_text = "{\"id\":\"raw1\",\"name\":\"caf\xc3\xa9\"}";
+	shared_ptr<const vector<unsigned char>> raw_document = make_shared<const vector<unsigned char>>(raw_text.begin(), raw_text.end());
+	RawResponse raw = coll->CreateDocumentRawAsync(raw_document).get();
+	assert(raw.status_code() == web::http::status_codes::Created);
+	value raw_json = value::parse(utility::conversions::to_string_t(string(raw.body().begin(), raw.body().end())));
+	const utility::string_t raw_rid = raw_json.at(U("_rid")).as_string();
+	raw = coll->GetDocumentRaw(raw_rid);
+	assert(string(raw.body().begin(), raw.body().end()).find("caf\xc3\xa9") != string::npos);
+	raw = coll->ReplaceDocumentRaw(raw_rid, raw_document);
+	assert(raw.status_code() == web::http::status_codes::OK);
+	raw = coll->QueryDocumentsRaw(U("SELECT * FROM ") + coll_name, utility::string_t(), 7);
+	assert(!raw.body().empty() && !raw.continuation().empty());
+	raw = coll->QueryDocumentsRaw(U("SELECT * FROM ") + coll_name, raw.continuation(), 7);
+	assert(raw.status_code() == web::http::status_codes::OK);
+	coll->DeleteDocument(raw_rid);
+
+	// Documents are addressed by name in one request
+	NamedCollection named = client.CollectionByName(db_name, coll_name);
+	shared_ptr<Document> named_document = named.CreateDocument(value::parse(U("{\"id\":\"Named 1\"}")));
+	assert(named.GetDocumentAsync(U("Named 1")).get()->resource_id() == named_document->resource_id());
+	named.ReplaceDocument(U("Named 1"), value::parse(U("{\"id\":\"Named 1\",\"n\":1}")));
+	assert(named.GetDocument(U("Named 1"))->payload().at(U("n")).as_integer() == 1);
+	named.DeleteDocument(U("Named 1"));
+	try
+	{
+		named.GetDocument(U("Named 1"));
+		assert(false);
+	}
+	catch (const ResourceNotFoundException&)
+	{
+		// Pass
+	}
+
+	// Cached documents are revalidated, written through and invalidated
+	coll->set_document_cache(make_shared<DocumentCache>(1 << 20));
+	shared_ptr<Document> hot = coll->CreateDocument(value::parse(U("{\"id\":\"hot\"}")));
+	assert(coll->GetDocument(hot->resource_id()) == hot);
+	assert(coll->GetDocumentAsync(hot->resource_id()).get() == hot);
+	shared_ptr<Document> replaced = coll->ReplaceDocument(hot->resource_id(), value::parse(U("{\"id\":\"hot\",\"n\":1}")));
+	assert(coll->GetDocument(hot->resource_id()) == replaced);
+	coll->DeleteDocument(hot->resource_id());
+	for (int i = 0; i < 2; i++)
+	{
+		try
+		{
+			coll->GetDocument(hot->resource_id());
+			assert(false);
+		}
+		catch (const ResourceNotFoundException&)
+		{
+			// Pass
+		}
+	}
+	coll->set_document_cache(nullptr);
+
+	// Upsert creates the document first, then replaces it in place
+	shared_ptr<Document> upserted = coll->UpsertDocument(value::parse(U("{\"id\":\"upserted\",\"n\":1}")));
+	shared_ptr<Document> reupserted = coll->UpsertDocumentAsync(value::parse(U("{\"id\":\"upserted\",\"n\":2}"))).get();
+	assert(reupserted->resource_id() == upserted->resource_id());
+	assert(coll->GetDocument(upserted->resource_id())->payload().at(U("n")).as_integer() == 2);
+	coll->DeleteDocument(upserted->resource_id());
+
+	// Concurrent updates of one document retry on conflicts and lose no increment
+	shared_ptr<Document> counter = coll->CreateDocument(value::parse(U("{\"id\":\"counter\",\"n\":0}")));
+	vector<pplx::task<shared_ptr<Document>>> updates;
+	for (int i = 0; i < 8; i++)
+	{
+		updates.push_back(coll->UpdateDocumentAsync(counter->resource_id(), [](value& document)
+		{
+			document[U("n")] = value::number(document.at(U("n")).as_integer() + 1);
+			return true;
+		}, 100));
+	}
+	pplx::when_all(updates.begin(), updates.end()).wait();
+	assert(coll->GetDocument(counter->resource_id())->payload().at(U("n")).as_integer() == 8);
+	shared_ptr<Document> unchanged = coll->UpdateDocument(counter->resource_id(), [](value&)
+	{
+		return false;
+	});
+	assert(unchanged->etag() == coll->GetDocument(counter->resource_id())->etag());
+	coll->DeleteDocument(counter->resource_id());
+
+	// Bulk upsert of documents that already exist replaces every one of them
+	documents.clear();
+	for (int i = 0; i < 10; i++)
+	{
+		value document;
+		document[U("id")] = value::string(U("bulk") + utility::conversions::print_string(i));
+		document[U("upserted")] = value::boolean(true);
+		documents.push_back(document);
+	}
+	// Moved in, the documents are not copied before being sent
+	results = coll->UpsertDocuments(move(documents), bulk_options);
+	assert(results.size() == 10);
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		assert(results[i].succeeded());
+		assert(results[i].document()->payload().at(U("upserted")).as_bool());
+	}
+
+	// Page views read fields in place and build documents only on demand
+	iter = coll->QueryDocuments(U("SELECT * FROM ") + coll_name, 7);
+	count = 0;
+	for (DocumentPage page = iter->NextPageViewAsync().get(); !page.empty(); page = iter->NextPageView())
+	{
+		for (size_t i = 0; i < page.size(); i++)
+		{
+			assert(page[i].at(U("id")).as_string() == page.id(i));
+			assert(!page.resource_id(i).empty());
+		}
+		assert(page.document(0)->resource_id() == page.resource_id(0));
+		count += (int)page.size();
+	}
+	assert(count == 400);
+
 	// Delete collection now that we are done testing
 	db->DeleteCollection(coll);
 
@@ -539,6 +1687,110 @@ void test_documents(
 	client.DeleteDatabase(db->resource_id());
 }
 
+void test_partitioned_collection(
+	const DocumentClient& client)
+{
+	shared_ptr<Database> db = client.CreateDatabase(generate_random_string(8));
+	shared_ptr<Collection> coll = db->CreateCollection(
+		generate_random_string(8),
+		PartitionKeyDefinition(U("/tenant")),
+		10100);
+	assert(coll->partition_key().path() == U("/tenant"));
+	assert(db->GetCollection(coll->resource_id())->partition_key().path() == U("/tenant"));
+
+	// Documents are routed by the partition key found in them
+	for (int i = 0; i < 20; i++)
+	{
+		value document;
+		document[U("id")] = value::string(U("doc") + utility::conversions::print_string(i));
+		document[U("tenant")] = value::string(U("tenant") + utility::conversions::print_string(i % 4));
+		coll->CreateDocument(document);
+	}
+	shared_ptr<Document> upserted = coll->UpsertDocument(value::parse(U("{\"id\":\"doc0\",\"tenant\":\"tenant0\",\"n\":1}")));
+
+	// Point operations by resource id take the partition key
+	PartitionKey tenant0(value::string(U("tenant0")));
+	assert(coll->GetDocument(upserted->resource_id(), tenant0)->payload().at(U("n")).as_integer() == 1);
+	coll->UpdateDocument(upserted->resource_id(), [](value& document)
+	{
+		document[U("n")] = value::number(2);
+		return true;
+	}, 10, tenant0);
+	coll->ReplaceDocument(upserted->resource_id(), value::parse(U("{\"id\":\"doc0\",\"tenant\":\"tenant0\",\"n\":3}")));
+	assert(coll->GetDocument(upserted->resource_id(), tenant0)->payload().at(U("n")).as_integer() == 3);
+
+	// Typed documents without an id get a generated one, and are routed by the
+	// partition key found in them
+	TenantItem item = { U("tenant1"), string_t(), 5 };
+	TenantItem created = coll->CreateDocumentAs(item);
+	assert(!created.resource_id.empty());
+	PartitionKey tenant1(value::string(U("tenant1")));
+	assert(coll->GetDocumentAs<TenantItem>(created.resource_id, tenant1).n == 5);
+	coll->DeleteDocument(created.resource_id, tenant1);
+
+	// Queries run across partitions
+	shared_ptr<DocumentIterator> iter = coll->QueryDocuments(U("SELECT * FROM c"), 7);
+	int count = 0;
+	while (iter->HasMore())
+	{
+		iter->Next();
+		count++;
+	}
+	assert(count == 20);
+
+	// Every partition key range is queried at once and the results merged
+	assert(!coll->GetPartitionKeyRanges().empty());
+	assert(coll->QueryDocumentsParallel(U("SELECT * FROM c")).size() == 20);
+	ParallelQueryOptions ordered;
+	ordered.set_max_degree_of_parallelism(2);
+	ordered.set_order_by(U("/id"), true);
+	ordered.set_top(5);
+	vector<shared_ptr<Document>> top = coll->QueryDocumentsParallel(U("SELECT TOP 5 * FROM c ORDER BY c.id DESC"), ordered);
+	assert(top.size() == 5);
+	assert(top[0]->id() == U("doc9"));
+	assert(top[4]->id() == U("doc5"));
+	ParallelQueryOptions count_options;
+	count_options.set_aggregate(AGGREGATE_COUNT);
+	vector<value> total = coll->QueryValuesParallel(U("SELECT VALUE COUNT(1) FROM c"), count_options);
+	assert(total.size() == 1 && total[0].as_integer() == 20);
+
+	coll->DeleteDocument(upserted);
+	try
+	{
+		coll->GetDocument(upserted->resource_id(), tenant0);
+		assert(false);
+	}
+	catch (const ResourceNotFoundException&)
+	{
+		// Pass
+	}
+
+	// Stored procedures run in the partition of the key they are given
+	shared_ptr<StoredProcedure> sproc = coll->CreateStoredProcedure(
+		U("count"),
+		U("function () { getContext().getCollection().queryDocuments(getContext().getCollection().getSelfLink(), 'SELECT * FROM c', function (err, docs) { getContext().getResponse().setBody(docs.length); }); }"));
+	assert(coll->ExecuteStoredProcedure(sproc->resource_id(), value::array(), tenant1).body().as_integer() == 5);
+
+	// Imports are batched per partition, small batches split a partition
+	vector<value> documents;
+	for (int i = 0; i < 60; i++)
+	{
+		value document;
+		document[U("id")] = value::string(U("import") + utility::conversions::print_string(i));
+		document[U("tenant")] = value::string(U("tenant") + utility::conversions::print_string(i % 3));
+		document[U("payload")] = value::string(generate_random_string(64));
+		documents.push_back(document);
+	}
+	BulkImportOptions import_options;
+	import_options.set_max_batch_size_bytes(1024);
+	assert(coll->ImportDocuments(documents, import_options) == 60);
+	assert(coll->QueryDocumentsParallel(U("SELECT * FROM c")).size() == 79);
+	assert(coll->ExecuteStoredProcedure(sproc->resource_id(), value::array(), tenant1).body().as_integer() == 25);
+
+	db->DeleteCollection(coll);
+	client.DeleteDatabase(db->resource_id());
+}
+
 void test_users(
 	const DocumentClient& client)
 {
@@ -828,6 +2080,15 @@ void test_triggers(
 	assert(trigger_list.size() == 1);
 	compare_triggers(trigger_list[0], trigger);
 
+	// Streamed listing
+	trigger_list.clear();
+	coll->ListTriggers([&trigger_list](const shared_ptr<Trigger>& item)
+	{
+		trigger_list.push_back(item);
+	});
+	assert(trigger_list.size() == 1);
+	compare_triggers(trigger_list[0], trigger);
+
 	iter = coll->QueryTriggersAsync(U("SELECT * FROM ") + coll_name).get();
 	int count = 0;
 	while (iter->HasMore())
@@ -955,6 +2216,15 @@ void test_stored_procedures(
 	assert(sproc_list.size() == 1);
 	compare_sprocs(sproc_list[0], sproc);
 
+	// Streamed listing
+	sproc_list.clear();
+	coll->ListStoredProcedures([&sproc_list](const shared_ptr<StoredProcedure>& item)
+	{
+		sproc_list.push_back(item);
+	});
+	assert(sproc_list.size() == 1);
+	compare_sprocs(sproc_list[0], sproc);
+
 	iter = coll->QueryStoredProceduresAsync(string_t(U("SELECT * FROM ") + coll_name)).get();
 	int count = 0;
 	while (iter->HasMore())
@@ -971,6 +2241,37 @@ void test_stored_procedures(
 	coll->ExecuteStoredProcedure(sproc->resource_id(), input);
 	coll->ExecuteStoredProcedureAsync(sproc->resource_id(), input).get();
 
+	// Procedure returning its progress is called again until it reports it is done
+	shared_ptr<StoredProcedure> step_sproc = coll->CreateStoredProcedure(
+		generate_random_string(8),
+		U("function step(from, to) { getContext().getResponse().setBody({ reached: from + 1, done: from + 1 >= to }); }"));
+	value step_input = value::array();
+	step_input[0] = value::number(0);
+	step_input[1] = value::number(5);
+	StoredProcedureResponse step_response = coll->ExecuteStoredProcedure(step_sproc->resource_id(), step_input);
+	assert(step_response.body().at(U("reached")).as_integer() == 1);
+	assert(step_response.diagnostics().request_charge() > 0);
+
+	int calls = 0;
+	step_response = coll->ExecuteStoredProcedureUntilDoneAsync(
+		step_sproc->resource_id(),
+		step_input,
+		[&calls](const StoredProcedureResponse& response, value& next_input)
+		{
+			calls++;
+			if (response.body().at(U("done")).as_bool())
+			{
+				return false;
+			}
+			next_input = value::array();
+			next_input[0] = response.body().at(U("reached"));
+			next_input[1] = value::number(5);
+			return true;
+		}).get();
+	assert(calls == 5);
+	assert(step_response.body().at(U("reached")).as_integer() == 5);
+	coll->DeleteStoredProcedure(step_sproc->resource_id());
+
 
 	// Replace sproc
 	string_t new_sproc_name = generate_random_string(8);
@@ -1088,6 +2389,15 @@ void test_user_defined_functions(
 	assert(udf_list.size() == 1);
 	compare_udfs(udf_list[0], udf);
 
+	// Streamed listing
+	udf_list.clear();
+	coll->ListUserDefinedFunctions([&udf_list](const shared_ptr<UserDefinedFunction>& item)
+	{
+		udf_list.push_back(item);
+	});
+	assert(udf_list.size() == 1);
+	compare_udfs(udf_list[0], udf);
+
 	iter = coll->QueryUserDefinedFunctionsAsync(U("SELECT * FROM ") + coll_name).get();
 	int count = 0;
 	while (iter->HasMore())
@@ -1244,6 +2554,15 @@ void test_attachments(
 	assert(attachment_list.size() == 1);
 	compare_attachments(attachment_list[0], attachment1);
 
+	// Streamed listing
+	attachment_list.clear();
+	doc->ListAttachments([&attachment_list](const shared_ptr<Attachment>& item)
+	{
+		attachment_list.push_back(item);
+	});
+	assert(attachment_list.size() == 1);
+	compare_attachments(attachment_list[0], attachment1);
+
 	iter = doc->QueryAttachmentsAsync(string_t(U("SELECT * FROM ") + doc_name)).get();
 	int count = 0;
 	while (iter->HasMore())
@@ -1327,19 +2646,48 @@ void test_attachments(
 int main()
 {
 	srand((unsigned int)time(nullptr));
+
+	test_request_signer();
+	test_request_limiter();
+	test_socket_options();
+	test_retry_budget();
+	test_bulk_pipeline();
+	test_json_array_reader();
+	test_document_mapping();
+	test_partition_key();
+	test_parallel_query_merge();
+	test_sql_query_spec();
+	test_document_detach();
+	test_document_cache();
+	test_metadata_cache();
+
 	ifstream_t confFile("account_configuration.txt");
 	string_t account, primaryKey;
 	confFile >> account;
 	confFile >> primaryKey;
 
+	ConnectionPolicy connection_policy;
+	connection_policy.set_max_connections(16);
+	connection_policy.set_query_prefetch_pages(2);
+
 	DocumentDBConfiguration conf(
 		account,
-		primaryKey);
+		primaryKey,
+		connection_policy);
+
+	atomic<int> operation_count(0);
+	conf.set_diagnostics_handler([&operation_count](const ResponseDiagnostics& diagnostics)
+	{
+		assert(!diagnostics.activity_id().empty());
+		assert(diagnostics.total_time() >= diagnostics.time_to_first_byte() + diagnostics.parse_time());
+		operation_count++;
+	});
 	DocumentClient client(conf);
 
 	test_databases(client);
 	test_collections(client);
 	test_documents(client);
+	test_partitioned_collection(client);
 	test_users(client);
 	test_permissions(client);
 	test_triggers(client);
@@ -1347,5 +2695,13 @@ int main()
 	test_user_defined_functions(client);
 	test_attachments(client);
 
+	// Same account, with the metadata cached
+	ConnectionPolicy cached_policy = connection_policy;
+	cached_policy.set_metadata_cache_ttl(chrono::minutes(1));
+	DocumentClient cached_client(DocumentDBConfiguration(account, primaryKey, cached_policy));
+	test_cached_metadata(cached_client);
+
+	assert(operation_count > 0);
+
 	return 0;
 }